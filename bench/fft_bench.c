@@ -0,0 +1,305 @@
+/*
+  Copyright 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/* FFT micro-benchmark: times the forward and backward transforms of each
+ * aubio FFT backend and prints the results as JSON on stdout.
+ *
+ *   fft_bench [-n size,size,...] [-b backend,backend,...] [-t seconds]
+ *             [-H hop]
+ *
+ * Sizes default to the ones the plugin uses (512, 2048 and 4096), backends
+ * to all of those compiled in; backends that were not compiled in, or do not
+ * support a size, are reported as unavailable.  Each figure is the best of 5 runs of
+ * about `seconds` / 5 each.  The error is the largest difference between
+ * the input and its round trip through the forward and backward transforms.
+ * A wrong forward transform paired with its own inverse would still round
+ * trip: dft_error compares the forward transform to a direct DFT computed in
+ * double precision, relative to the largest bin of the latter.  Odd and
+ * prime sizes, say -n 1001,1009, check the mixed radix backend.
+ *
+ * The phase vocoder section times one aubio_pvoc_do call per hop of `hop`
+ * samples (256 by default) at each size, framing and windowing included and
+ * the norm only, in ns and, on x86, in TSC cycles.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "types.h"
+#include "fvec.h"
+#include "cvec.h"
+#include "spectral/fft.h"
+#include "spectral/phasevoc.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#endif
+
+#define MAX_ITEMS 16
+#define N_RUNS 5
+
+static double
+now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* best time of one transform, in ns, over N_RUNS runs of about `seconds` */
+static double
+time_transform (aubio_fft_t *fft, fvec_t *in, fvec_t *compspec, int backward,
+    double seconds)
+{
+  double best = 0.;
+  unsigned long batch = 16;
+  int run;
+  for (run = 0; run < N_RUNS; run++) {
+    unsigned long i, n = 0;
+    double t0 = now_ns (), dt;
+    do {
+      for (i = 0; i < batch; i++) {
+        if (backward) aubio_fft_rdo_complex (fft, compspec, in);
+        else aubio_fft_do_complex (fft, in, compspec);
+      }
+      n += batch;
+      dt = now_ns () - t0;
+    } while (dt < seconds * 1e9 / N_RUNS);
+    if (run == 0 || dt / n < best) best = dt / n;
+  }
+  return best;
+}
+
+/* largest difference between the packed spectrum of `in` and its direct
+ * DFT, relative to the largest bin of the DFT */
+static double
+dft_error (const fvec_t *in, const fvec_t *compspec)
+{
+  uint_t n = in->length, k, i;
+  double *c = (double *)malloc (n * sizeof (double));
+  double *s = (double *)malloc (n * sizeof (double));
+  double err = 0., peak = 0.;
+  if (!c || !s) {
+    free (c);
+    free (s);
+    return -1.;
+  }
+  for (i = 0; i < n; i++) {
+    c[i] = cos (2. * M_PI * i / n);
+    s[i] = sin (2. * M_PI * i / n);
+  }
+  for (k = 0; k <= n / 2; k++) {
+    double re = 0., im = 0., re_fft, im_fft;
+    uint_t phase = 0;
+    for (i = 0; i < n; i++) {
+      re += in->data[i] * c[phase];
+      im -= in->data[i] * s[phase];
+      phase += k;
+      if (phase >= n) phase -= n;
+    }
+    /* real parts first, then the imaginary parts backwards */
+    re_fft = compspec->data[k];
+    im_fft = (k > 0 && k < (n + 1) / 2) ? compspec->data[n - k] : 0.;
+    err = fmax (err, hypot (re - re_fft, im - im_fft));
+    peak = fmax (peak, hypot (re, im));
+  }
+  free (c);
+  free (s);
+  return peak > 0. ? err / peak : err;
+}
+
+static int
+bench_one (const char *backend, uint_t size, double seconds, int first)
+{
+  double t0 = now_ns ();
+  aubio_fft_t *fft = new_aubio_fft_with_backend (size, backend);
+  double plan_ns = now_ns () - t0;
+  fvec_t *in, *compspec, *out;
+  double fwd, bwd, err = 0., dft_err;
+  uint_t i;
+  if (!fft) {
+    printf ("%s    {\"backend\": \"%s\", \"size\": %u, \"available\": false}",
+        first ? "" : ",\n", backend, size);
+    return 0;
+  }
+  in = new_fvec (size);
+  compspec = new_fvec (size);
+  out = new_fvec (size);
+  srand (size);
+  for (i = 0; i < size; i++) {
+    in->data[i] = rand () / (smpl_t)RAND_MAX - .5;
+  }
+  aubio_fft_do_complex (fft, in, compspec);
+  dft_err = dft_error (in, compspec);
+  aubio_fft_rdo_complex (fft, compspec, out);
+  for (i = 0; i < size; i++) {
+    err = fmax (err, fabs (out->data[i] - in->data[i]));
+  }
+  fwd = time_transform (fft, in, compspec, 0, seconds / 2);
+  bwd = time_transform (fft, out, compspec, 1, seconds / 2);
+  printf ("%s    {\"backend\": \"%s\", \"size\": %u, \"available\": true, "
+      "\"plan_us\": %.1f, \"forward_ns\": %.1f, \"backward_ns\": %.1f, "
+      "\"error\": %.3g, \"dft_error\": %.3g}",
+      first ? "" : ",\n", aubio_fft_get_backend (fft), size,
+      plan_ns / 1e3, fwd, bwd, err, dft_err);
+  del_fvec (out);
+  del_fvec (compspec);
+  del_fvec (in);
+  del_aubio_fft (fft);
+  return 0;
+}
+
+/* best time and cycle count of one aubio_pvoc_do call, over N_RUNS runs */
+static void
+time_pvoc (aubio_pvoc_t *pv, fvec_t *hop, cvec_t *grain, double seconds,
+    double *ns, double *cycles)
+{
+  unsigned long batch = 16;
+  int run;
+  for (run = 0; run < N_RUNS; run++) {
+    unsigned long i, n = 0;
+    double t0 = now_ns (), dt;
+#ifdef HAVE_RDTSC
+    unsigned long long c0 = __rdtsc ();
+#endif
+    double dc = 0.;
+    do {
+      for (i = 0; i < batch; i++) {
+        aubio_pvoc_do (pv, hop, grain);
+      }
+      n += batch;
+      dt = now_ns () - t0;
+    } while (dt < seconds * 1e9 / N_RUNS);
+#ifdef HAVE_RDTSC
+    dc = (double)(__rdtsc () - c0);
+#endif
+    if (run == 0 || dt / n < *ns) {
+      *ns = dt / n;
+      *cycles = dc / n;
+    }
+  }
+}
+
+static void
+bench_pvoc (uint_t size, uint_t hop_s, double seconds, int first)
+{
+  aubio_pvoc_t *pv = new_aubio_pvoc (size, hop_s);
+  fvec_t *hop;
+  cvec_t *grain;
+  double ns = 0., cycles = 0.;
+  uint_t i;
+  if (!pv) {
+    printf ("%s    {\"size\": %u, \"hop\": %u, \"available\": false}",
+        first ? "" : ",\n", size, hop_s);
+    return;
+  }
+  hop = new_fvec (hop_s);
+  grain = new_cvec (size);
+  srand (size);
+  for (i = 0; i < hop_s; i++) {
+    hop->data[i] = rand () / (smpl_t)RAND_MAX - .5;
+  }
+  /* norm only, as the onset functions use it */
+  aubio_pvoc_set_phase (pv, 0);
+  time_pvoc (pv, hop, grain, seconds, &ns, &cycles);
+  printf ("%s    {\"size\": %u, \"hop\": %u, \"available\": true, "
+      "\"ns_per_hop\": %.1f, \"cycles_per_hop\": %.0f}",
+      first ? "" : ",\n", size, hop_s, ns, cycles);
+  del_cvec (grain);
+  del_fvec (hop);
+  del_aubio_pvoc (pv);
+}
+
+static int
+split_list (char *arg, char **items)
+{
+  int n = 0;
+  char *tok = strtok (arg, ",");
+  while (tok && n < MAX_ITEMS) {
+    items[n++] = tok;
+    tok = strtok (NULL, ",");
+  }
+  return n;
+}
+
+static void
+usage (void)
+{
+  fprintf (stderr, "usage: fft_bench [-n size,size,...] "
+      "[-b backend,backend,...] [-t seconds] [-H hop]\n");
+}
+
+int
+main (int argc, char **argv)
+{
+  char *size_items[MAX_ITEMS], *backend_items[MAX_ITEMS];
+  char default_sizes[] = "512,2048,4096";
+  int n_sizes = 0, n_backends = 0, i, j, c, first = 1;
+  double seconds = 1.;
+  int hop_s = 256;
+
+  while ((c = getopt (argc, argv, "n:b:t:H:h")) != -1) {
+    switch (c) {
+      case 'n':
+        n_sizes = split_list (optarg, size_items);
+        break;
+      case 'b':
+        n_backends = split_list (optarg, backend_items);
+        break;
+      case 't':
+        seconds = atof (optarg);
+        break;
+      case 'H':
+        hop_s = atoi (optarg);
+        break;
+      default:
+        usage ();
+        return 1;
+    }
+  }
+  if (!n_sizes) n_sizes = split_list (default_sizes, size_items);
+  if (!n_backends) {
+    const char_t *name;
+    while (n_backends < MAX_ITEMS
+        && (name = aubio_fft_get_backend_name (n_backends)) != NULL) {
+      backend_items[n_backends++] = (char *)name;
+    }
+  }
+
+  printf ("{\n  \"results\": [\n");
+  for (i = 0; i < n_sizes; i++) {
+    int size = atoi (size_items[i]);
+    if (size < 2) {
+      fprintf (stderr, "fft_bench: invalid size %s\n", size_items[i]);
+      return 1;
+    }
+    for (j = 0; j < n_backends; j++) {
+      bench_one (backend_items[j], (uint_t)size, seconds, first);
+      first = 0;
+    }
+  }
+  printf ("\n  ],\n  \"pvoc\": [\n");
+  for (i = 0; i < n_sizes; i++) {
+    bench_pvoc ((uint_t)atoi (size_items[i]), (uint_t)hop_s, seconds, i == 0);
+  }
+  printf ("\n  ]\n}\n");
+  return 0;
+}
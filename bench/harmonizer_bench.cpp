@@ -0,0 +1,1407 @@
+/*
+  Copyright 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+/* Offline benchmark: drives the plugin through lv2_descriptor() the way a
+ * host would, without a host, and prints the results as JSON on stdout.
+ *
+ *   harmonizer_bench [-d seconds] [-r rate] [-q fraction] [-w file.wav] [-n]
+ *                    [-o onset_method] [-p pitch_method] [-b block,block,...]
+ *                    [-W window,window,...] [-s kernels] [-e] [-D]
+ *                    [-l tier,tier,...] [-I count,count,...] [-M low,high]
+ *                    [-Y] [-F] [-T] [-P voices,voices,...]
+ *
+ * -n runs without the work:schedule feature, as on a host without worker
+ * support.  -W skips the plugin and times the pitch detectors alone, fed
+ * one hop at a time, at each of the given window sizes.  The first hop of
+ * a new detector is also timed against the one after it, on the same start
+ * of the input, so that the cost of a frame that depends on the signal
+ * does not count; it fails when the first is more than 1.5 times slower,
+ * since all setup should be done when the detector is created.  -s forces the
+ * vector kernels (scalar, sse2, avx2, neon) instead of the best available.
+ * With the synthetic input, the time of the first note on in each note is also
+ * compared to the start of that note: the mean, standard deviation and spread
+ * of that latency are reported, and further note ons within a note are
+ * counted as retriggers.
+ * -q leaves that fraction of the synthetic notes out, for channels that are
+ * silent most of the time.
+ * -l runs each of the given latency tiers (0 to 3, 2 by default) and reports
+ * the latency the plugin declares for it, to weigh it against the CPU cost.
+ * run_page_faults counts the page faults taken inside run() itself.
+ * -e turns on the onset descriptor outputs.  -D skips the plugin and times
+ * the fused onset descriptor pass against the eight descriptors run one
+ * after the other on the same spectra, and reports how far apart they are.
+ * -I instantiates each of the given numbers of plugins side by side, say
+ * 1,4,16,64,256, and reports the time and heap each one took, and the number
+ * of tables they share.
+ * -M skips the plugin and feeds the pitch detectors a steady harmonic tone
+ * at each MIDI note from low to high, with the window of -W (2048 without),
+ * and reports how far off their pitch is, in cents, and at which notes they
+ * are right, along with their cost.
+ * -Y skips the plugin and runs YIN hop by hop twice on the same frames, with
+ * the difference function computed incrementally and whole, leaving a hop
+ * out now and then, and reports how far apart their periods are; it fails
+ * when they are further apart than rounding errors would make them.
+ * -F skips the plugin and runs yin and yinfast on the same frames, at each
+ * window of -W (2048 without), and reports how far apart their pitches are,
+ * in semitones, and the hops where only one of them found one; it fails
+ * when any hop differs by more than 0.02 semitones, or has a pitch from one
+ * method only.
+ * -T turns the drum trigger on: the notes then come from the sliding DFT
+ * onsets, found as the samples come in, and their latency can be weighed
+ * against the one of the hop by hop onsets.
+ * -P skips the plugin and feeds mcomb a run of steady chords of one to four
+ * notes, looking for at most each of the given numbers of notes per hop, as
+ * the plugin does with its polyphony port, and reports the cost of a hop
+ * against that limit, along with the share of the chord notes found and the
+ * notes found that were not played.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "harmonizer.h"
+#include "types.h"
+#include "fvec.h"
+#include "cvec.h"
+#include "musicutils.h"
+#include "spectral/frontend.h"
+#include "spectral/specdesc.h"
+#include "pitch/pitch.h"
+#include "pitch/pitchyin.h"
+#include "pitch/pitchyinfast.h"
+#include "simd.h"
+#include "utils/tables.h"
+#include "utils/arena.h"
+
+#include "lv2/lv2plug.in/ns/ext/atom/atom.h"
+#include "lv2/lv2plug.in/ns/ext/atom/util.h"
+#include "lv2/lv2plug.in/ns/ext/urid/urid.h"
+#include "lv2/lv2plug.in/ns/ext/midi/midi.h"
+#include "lv2/lv2plug.in/ns/ext/log/log.h"
+#include "lv2/lv2plug.in/ns/ext/worker/worker.h"
+#include "lv2/lv2plug.in/ns/lv2core/lv2.h"
+
+#define MAX_URIDS 64
+#define MAX_BLOCK_SIZES 16
+#define MAX_WINDOW_SIZES 16
+#define MAX_INSTANCE_COUNTS 16
+#define DETECTOR_HOP_SIZE 256
+#define DESCRIPTOR_WIN_SIZE 512
+#define MIDI_OUT_CAPACITY 65536
+#define MAX_WORK_ITEMS 32
+#define MAX_WORK_SIZE 64
+#define SYNTH_NOTE_S 0.25
+#define SYNTH_GAP_S 0.05
+#define SWEEP_NOTE_S 0.4
+#define SWEEP_WIN_SIZE 2048
+/* further than this from the note, a pitch is counted as wrong */
+#define SWEEP_GROSS_CENTS 50.
+#define YIN_WIN_SIZE 2048
+/* a hop left out every so many, so that the incremental YIN starts over */
+#define YIN_SKIP_PERIOD 97
+/* the two differ by rounding only, further than this is a bug */
+#define YIN_MAX_PERIOD_ERROR 0.1
+/* yinfast takes the cross term from an FFT: further apart than this, in
+ * semitones, the two methods disagree */
+#define YINFAST_MAX_SEMITONES 0.02
+/* fresh detectors timed on their first two hops, the fastest of each kept */
+#define FIRST_HOP_RUNS 5
+/* a first hop slower than the next by more than this sets something up */
+#define FIRST_HOP_MAX_RATIO 1.5
+#define CHORD_S 0.4
+#define MAX_CHORD_NOTES 4
+#define MAX_POLYPHONY_LIMITS 8
+
+static const char *onset_names[NUM_ONSET_METHODS] = {
+  "default", "energy", "hfc", "complex", "phase", "specdiff", "kl", "mkl",
+  "specflux", "tdhfc"
+};
+
+static const char *pitch_names[NUM_PITCH_METHODS] = {
+  "default", "schmitt", "fcomb", "mcomb", "yin", "yinfft", "yinfast", "yindec",
+  "goertzel"
+};
+
+static const char *tier_names[NUM_LATENCY_TIERS] = {
+  "ultralow", "low", "normal", "high"
+};
+
+static const uint32_t default_block_sizes[] = { 1, 32, 64, 256, 1024, 4096 };
+
+/* the chords of -P, as MIDI notes, 0 past the last one */
+static const int chords[][MAX_CHORD_NOTES] = {
+  { 60, 0, 0, 0 },
+  { 48, 64, 0, 0 },
+  { 55, 59, 62, 0 },
+  { 48, 55, 64, 70 },
+  { 57, 60, 64, 0 },
+  { 50, 57, 65, 72 },
+  { 43, 59, 74, 0 },
+  { 52, 59, 67, 71 }
+};
+
+/* stub urid:map, a linear table is plenty for the handful of URIs used */
+typedef struct {
+  char *uris[MAX_URIDS];
+  uint32_t n_uris;
+} bench_urid_table;
+
+static LV2_URID
+bench_map (LV2_URID_Map_Handle handle, const char *uri)
+{
+  bench_urid_table *table = (bench_urid_table *)handle;
+  for (uint32_t i = 0; i < table->n_uris; i++) {
+    if (!strcmp (table->uris[i], uri)) return i + 1;
+  }
+  if (table->n_uris == MAX_URIDS) return 0;
+  table->uris[table->n_uris] = strdup (uri);
+  return ++table->n_uris;
+}
+
+/* stub log:log, only lets errors and warnings through to stderr */
+typedef struct {
+  LV2_URID log_Error;
+  LV2_URID log_Warning;
+} bench_log_state;
+
+static int
+bench_vprintf (LV2_Log_Handle handle, LV2_URID type, const char *fmt,
+    va_list ap)
+{
+  bench_log_state *state = (bench_log_state *)handle;
+  if (type != state->log_Error && type != state->log_Warning) return 0;
+  return vfprintf (stderr, fmt, ap);
+}
+
+static int
+bench_printf (LV2_Log_Handle handle, LV2_URID type, const char *fmt, ...)
+{
+  va_list ap;
+  va_start (ap, fmt);
+  int ret = bench_vprintf (handle, type, fmt, ap);
+  va_end (ap);
+  return ret;
+}
+
+/* stub worker: requests scheduled during run() are executed right after it
+ * returns, and the responses delivered before the next run(), which is the
+ * ordering a host with a worker thread guarantees */
+typedef struct {
+  uint32_t size;
+  uint8_t data[MAX_WORK_SIZE];
+} bench_work_item;
+
+typedef struct {
+  bench_work_item requests[MAX_WORK_ITEMS];
+  uint32_t n_requests;
+  bench_work_item responses[MAX_WORK_ITEMS];
+  uint32_t n_responses;
+  uint32_t n_jobs;
+} bench_worker;
+
+static LV2_Worker_Status
+bench_push (bench_work_item *items, uint32_t *n_items, uint32_t size,
+    const void *data)
+{
+  if (*n_items == MAX_WORK_ITEMS || size > MAX_WORK_SIZE) {
+    return LV2_WORKER_ERR_NO_SPACE;
+  }
+  items[*n_items].size = size;
+  memcpy (items[*n_items].data, data, size);
+  (*n_items)++;
+  return LV2_WORKER_SUCCESS;
+}
+
+static LV2_Worker_Status
+bench_schedule_work (LV2_Worker_Schedule_Handle handle, uint32_t size,
+    const void *data)
+{
+  bench_worker *worker = (bench_worker *)handle;
+  return bench_push (worker->requests, &worker->n_requests, size, data);
+}
+
+static LV2_Worker_Status
+bench_respond (LV2_Worker_Respond_Handle handle, uint32_t size,
+    const void *data)
+{
+  bench_worker *worker = (bench_worker *)handle;
+  return bench_push (worker->responses, &worker->n_responses, size, data);
+}
+
+static void
+bench_worker_flush (bench_worker *worker, const LV2_Worker_Interface *iface,
+    LV2_Handle h)
+{
+  if (!iface) return;
+  for (uint32_t i = 0; i < worker->n_requests; i++) {
+    iface->work (h, bench_respond, worker, worker->requests[i].size,
+        worker->requests[i].data);
+    worker->n_jobs++;
+  }
+  worker->n_requests = 0;
+  for (uint32_t i = 0; i < worker->n_responses; i++) {
+    iface->work_response (h, worker->responses[i].size,
+        worker->responses[i].data);
+  }
+  worker->n_responses = 0;
+  if (iface->end_run) iface->end_run (h);
+}
+
+/* bytes currently allocated on the heap, mmapped blocks included, 0 when
+ * unknown */
+static double
+heap_in_use (void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+  struct mallinfo2 mi = mallinfo2 ();
+  return (double)(mi.uordblks + mi.hblkhd);
+#else
+  return 0.;
+#endif
+}
+
+/* page faults of the process so far */
+static long
+page_faults (void)
+{
+  struct rusage ru;
+  getrusage (RUSAGE_SELF, &ru);
+  return ru.ru_minflt + ru.ru_majflt;
+}
+
+static double
+now_ns (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* synthetic test signal: a run of decaying harmonic notes walking up and
+ * down the range a bass or a voice would cover, separated by short gaps;
+ * a `quiet` fraction of the notes is left out, leaving the noise floor */
+static float *
+make_synthetic (double rate, double seconds, double quiet, uint32_t *n_frames)
+{
+  uint32_t n = (uint32_t)(rate * seconds);
+  float *buf = (float *)calloc (n, sizeof (float));
+  uint32_t note_len = (uint32_t)(SYNTH_NOTE_S * rate);
+  uint32_t gap = (uint32_t)(SYNTH_GAP_S * rate);
+  uint32_t seed = 22222;
+  int note = 40, step = 3;
+  uint32_t k = 0;
+  for (uint32_t start = 0; start < n; start += note_len + gap, k++) {
+    double f0 = 440. * pow (2., (note - 69) / 12.);
+    int muted = floor ((k + 1) * quiet) > floor (k * quiet);
+    for (uint32_t i = 0; i < note_len && start + i < n && !muted; i++) {
+      double t = i / rate, env = exp (-4. * t), s = 0.;
+      for (int h = 1; h <= 4; h++) {
+        if (f0 * h < rate / 2) s += sin (2. * M_PI * f0 * h * t) / h;
+      }
+      buf[start + i] = (float)(0.4 * env * s);
+    }
+    note += step;
+    if (note > 76 || note < 40) step = -step;
+  }
+  for (uint32_t i = 0; i < n; i++) {
+    seed = seed * 1664525u + 1013904223u;
+    buf[i] += 1e-4f * ((seed >> 9) / (float)(1 << 23) - 0.5f);
+  }
+  *n_frames = n;
+  return buf;
+}
+
+static uint32_t
+read_le (const uint8_t *p, int bytes)
+{
+  uint32_t v = 0;
+  for (int i = bytes - 1; i >= 0; i--) v = (v << 8) | p[i];
+  return v;
+}
+
+/* minimal RIFF/WAVE reader: PCM 16/24/32 bit or 32 bit float, channels are
+ * mixed down to mono */
+static float *
+read_wav (const char *path, double *rate, uint32_t *n_frames)
+{
+  FILE *f = fopen (path, "rb");
+  if (!f) {
+    fprintf (stderr, "harmonizer_bench: can not open %s\n", path);
+    return NULL;
+  }
+  fseek (f, 0, SEEK_END);
+  long size = ftell (f);
+  fseek (f, 0, SEEK_SET);
+  uint8_t *raw = (uint8_t *)malloc (size);
+  if (fread (raw, 1, size, f) != (size_t)size || size < 12
+      || memcmp (raw, "RIFF", 4) || memcmp (raw + 8, "WAVE", 4)) {
+    fprintf (stderr, "harmonizer_bench: %s is not a WAVE file\n", path);
+    fclose (f);
+    free (raw);
+    return NULL;
+  }
+  fclose (f);
+  uint32_t format = 0, channels = 0, bits = 0, data_len = 0;
+  const uint8_t *data = NULL;
+  for (long pos = 12; pos + 8 <= size;) {
+    uint32_t len = read_le (raw + pos + 4, 4);
+    if (!memcmp (raw + pos, "fmt ", 4) && len >= 16) {
+      format = read_le (raw + pos + 8, 2);
+      channels = read_le (raw + pos + 10, 2);
+      *rate = read_le (raw + pos + 12, 4);
+      bits = read_le (raw + pos + 22, 2);
+      if (format == 0xFFFE && len >= 26) format = read_le (raw + pos + 32, 2);
+    } else if (!memcmp (raw + pos, "data", 4)) {
+      data = raw + pos + 8;
+      data_len = (uint32_t)((pos + 8 + len <= size) ? len : size - pos - 8);
+    }
+    pos += 8 + len + (len & 1);
+  }
+  if (!data || !channels || !((format == 1 && (bits == 16 || bits == 24
+            || bits == 32)) || (format == 3 && bits == 32))) {
+    fprintf (stderr, "harmonizer_bench: unsupported WAVE format in %s\n",
+        path);
+    free (raw);
+    return NULL;
+  }
+  uint32_t bytes = bits / 8;
+  uint32_t n = data_len / (bytes * channels);
+  float *buf = (float *)calloc (n ? n : 1, sizeof (float));
+  for (uint32_t i = 0; i < n; i++) {
+    float acc = 0.f;
+    for (uint32_t c = 0; c < channels; c++) {
+      const uint8_t *p = data + (i * channels + c) * bytes;
+      uint32_t v = read_le (p, bytes);
+      if (format == 3) {
+        float fv;
+        memcpy (&fv, &v, sizeof (float));
+        acc += fv;
+      } else {
+        int32_t sv = (int32_t)(v << (32 - bits));
+        acc += sv / 2147483648.f;
+      }
+    }
+    buf[i] = acc / channels;
+  }
+  free (raw);
+  *n_frames = n;
+  return buf;
+}
+
+typedef struct {
+  double total_ns;
+  double worst_ns;
+  double first_ns;
+  double instantiate_ns;
+  double instance_bytes;
+  uint32_t n_runs;
+  uint32_t n_jobs;
+  long run_faults;
+  uint32_t note_on;
+  uint32_t note_off;
+  float reported_latency;
+  /* latency of the first note on after the start of each note, in frames;
+   * later ones in the same note are counted as retriggers */
+  uint32_t n_timed;
+  uint32_t n_retriggers;
+  double latency_sum;
+  double latency_sq_sum;
+  double latency_min;
+  double latency_max;
+} bench_result;
+
+static int
+run_one (const LV2_Descriptor *desc, const LV2_Feature *const *features,
+    bench_worker *worker, LV2_URID midi_MidiEvent, double rate, const float *audio,
+    uint32_t n_frames, uint32_t note_period, uint32_t block_size,
+    int onset_method, int pitch_method, int tier, int descriptors,
+    const uint32_t *note_range, int trigger, bench_result *res)
+{
+  float onset_method_port = (float)onset_method;
+  float onset_threshold = 0.3f;
+  float silence_threshold = -90.f;
+  float pitch_method_port = (float)pitch_method;
+  float pitch_threshold = 0.3f;
+  float descriptors_port = (float)descriptors;
+  float descriptor_out[NUM_DESCRIPTORS];
+  float tier_port = (float)tier;
+  float latency_out = 0.f;
+  float min_note_port = (float)note_range[0];
+  float max_note_port = (float)note_range[1];
+  float trigger_port = (float)trigger;
+  float trigger_note_port = 36.f;
+  float polyphony_port = 1.f;
+  float *in = (float *)calloc (block_size, sizeof (float));
+  uint64_t *out_buf = (uint64_t *)calloc (MIDI_OUT_CAPACITY / 8, 8);
+  LV2_Atom_Sequence *midi_out = (LV2_Atom_Sequence *)out_buf;
+
+  memset (res, 0, sizeof (*res));
+  memset (worker, 0, sizeof (*worker));
+  const LV2_Worker_Interface *iface = (const LV2_Worker_Interface *)
+    (desc->extension_data ? desc->extension_data (LV2_WORKER__interface)
+     : NULL);
+  double heap_before = heap_in_use ();
+  double t0 = now_ns ();
+  LV2_Handle h = desc->instantiate (desc, rate, "", features);
+  res->instantiate_ns = now_ns () - t0;
+  if (!h) {
+    free (in);
+    free (out_buf);
+    return -1;
+  }
+  desc->connect_port (h, HARMONIZER_ONSET_METHOD, &onset_method_port);
+  desc->connect_port (h, HARMONIZER_ONSET_THRESHOLD, &onset_threshold);
+  desc->connect_port (h, HARMONIZER_SILENCE_THRESHOLD, &silence_threshold);
+  desc->connect_port (h, HARMONIZER_PITCH_METHOD, &pitch_method_port);
+  desc->connect_port (h, HARMONIZER_PITCH_THRESHOLD, &pitch_threshold);
+  desc->connect_port (h, HARMONIZER_INPUT, in);
+  desc->connect_port (h, HARMONIZER_MIDI_OUT, midi_out);
+  desc->connect_port (h, HARMONIZER_DESCRIPTORS, &descriptors_port);
+  for (int i = 0; i < NUM_DESCRIPTORS; i++) {
+    desc->connect_port (h, HARMONIZER_ENERGY_OUT + i, &descriptor_out[i]);
+  }
+  desc->connect_port (h, HARMONIZER_LATENCY_TIER, &tier_port);
+  desc->connect_port (h, HARMONIZER_LATENCY, &latency_out);
+  desc->connect_port (h, HARMONIZER_MIN_NOTE, &min_note_port);
+  desc->connect_port (h, HARMONIZER_MAX_NOTE, &max_note_port);
+  desc->connect_port (h, HARMONIZER_TRIGGER, &trigger_port);
+  desc->connect_port (h, HARMONIZER_TRIGGER_NOTE, &trigger_note_port);
+  desc->connect_port (h, HARMONIZER_POLYPHONY, &polyphony_port);
+  if (desc->activate) desc->activate (h);
+
+  uint64_t timed_notes = 0;
+  for (uint32_t pos = 0; pos + block_size <= n_frames; pos += block_size) {
+    memcpy (in, audio + pos, block_size * sizeof (float));
+    midi_out->atom.size = MIDI_OUT_CAPACITY - sizeof (LV2_Atom);
+    long faults = page_faults ();
+    t0 = now_ns ();
+    desc->run (h, block_size);
+    double dt = now_ns () - t0;
+    res->run_faults += page_faults () - faults;
+    res->total_ns += dt;
+    if (dt > res->worst_ns) res->worst_ns = dt;
+    if (!res->n_runs) res->first_ns = dt;
+    res->n_runs++;
+    bench_worker_flush (worker, iface, h);
+    LV2_ATOM_SEQUENCE_FOREACH (midi_out, ev) {
+      if (ev->body.type != midi_MidiEvent) continue;
+      const uint8_t *msg = (const uint8_t *)(ev + 1);
+      if ((msg[0] & 0xF0) == 0x90) {
+        res->note_on++;
+        if (note_period) {
+          uint64_t note = (pos + ev->time.frames) / note_period + 1;
+          if (note <= timed_notes) {
+            res->n_retriggers++;
+            continue;
+          }
+          timed_notes = note;
+          double latency = (pos + ev->time.frames) % note_period;
+          if (!res->n_timed || latency < res->latency_min)
+            res->latency_min = latency;
+          if (!res->n_timed || latency > res->latency_max)
+            res->latency_max = latency;
+          res->latency_sum += latency;
+          res->latency_sq_sum += latency * latency;
+          res->n_timed++;
+        }
+      }
+      else if ((msg[0] & 0xF0) == 0x80) res->note_off++;
+    }
+  }
+
+  res->reported_latency = latency_out;
+  res->instance_bytes = heap_in_use () - heap_before;
+  res->n_jobs = worker->n_jobs;
+  if (desc->deactivate) desc->deactivate (h);
+  desc->cleanup (h);
+  free (in);
+  free (out_buf);
+  return 0;
+}
+
+/* instantiate n plugins at once, as a session with many tracks would */
+static int
+run_instances (const LV2_Descriptor *desc,
+    const LV2_Feature *const *features, double rate, uint32_t n,
+    double *ns_per_instance, double *bytes_per_instance, uint32_t *n_tables)
+{
+  LV2_Handle *h = (LV2_Handle *)calloc (n, sizeof (LV2_Handle));
+  uint32_t i;
+  int failed = 0;
+  if (!h) return -1;
+  double heap_before = heap_in_use ();
+  double t0 = now_ns ();
+  for (i = 0; i < n; i++) {
+    h[i] = desc->instantiate (desc, rate, "", features);
+    if (!h[i]) {
+      failed = 1;
+      break;
+    }
+  }
+  *ns_per_instance = (now_ns () - t0) / n;
+  *bytes_per_instance = (heap_in_use () - heap_before) / n;
+  *n_tables = aubio_table_get_count ();
+  while (i--) desc->cleanup (h[i]);
+  free (h);
+  return failed ? -1 : 0;
+}
+
+/* time one pitch detector on its own, the way the plugin builds and feeds
+ * it: in an arena of its own, so that its first hop page faults no more
+ * than the next ones */
+static int
+run_detector (const char *method, uint32_t window, double rate,
+    const float *audio, uint32_t n_frames, double *ns_per_hop,
+    double *first_ns)
+{
+  aubio_arena_t *arena = new_aubio_arena (4 * window * sizeof (smpl_t), 1);
+  if (!arena) return -1;
+  aubio_arena_enter (arena);
+  aubio_pitch_t *pitch = new_aubio_pitch (method, window, DETECTOR_HOP_SIZE,
+      (uint_t)rate);
+  fvec_t *in = new_fvec (DETECTOR_HOP_SIZE);
+  fvec_t *out = new_fvec (1);
+  aubio_arena_leave (arena);
+  if (!pitch) {
+    del_aubio_arena (arena);
+    return -1;
+  }
+  uint32_t n_hops = 0;
+  double total = 0.;
+  for (uint32_t pos = 0; pos + DETECTOR_HOP_SIZE <= n_frames;
+      pos += DETECTOR_HOP_SIZE) {
+    memcpy (in->data, audio + pos, DETECTOR_HOP_SIZE * sizeof (float));
+    double t0 = now_ns ();
+    aubio_pitch_do (pitch, in, out);
+    double dt = now_ns () - t0;
+    if (!n_hops) *first_ns = dt;
+    else total += dt;
+    n_hops++;
+  }
+  *ns_per_hop = n_hops > 1 ? total / (n_hops - 1) : 0.;
+  aubio_arena_enter (arena);
+  del_fvec (out);
+  del_fvec (in);
+  del_aubio_pitch (pitch);
+  aubio_arena_leave (arena);
+  del_aubio_arena (arena);
+  return 0;
+}
+
+/* the fastest first and second hops of a few new detectors, so that a
+ * first hop is not held slow for a preemption */
+static int
+time_first_hops (const char *method, uint32_t window, double rate,
+    const float *audio, double *first_ns, double *next_ns)
+{
+  for (int i = 0; i < FIRST_HOP_RUNS; i++) {
+    double first, next;
+    if (run_detector (method, window, rate, audio, 2 * DETECTOR_HOP_SIZE,
+          &next, &first)) return -1;
+    if (!i || first < *first_ns) *first_ns = first;
+    if (!i || next < *next_ns) *next_ns = next;
+  }
+  return 0;
+}
+
+typedef struct {
+  double ns_per_hop;
+  uint32_t n_hops;
+  uint32_t n_right;
+  double cents_sum;   /* absolute error of the right ones */
+  uint32_t n_octave;  /* hops off by one octave or more */
+  int lowest;         /* lowest and highest notes with 90% of hops right */
+  int highest;
+} sweep_result;
+
+/* feed a pitch detector one steady tone per MIDI note, leaving out the hops
+ * whose window still holds some of the previous note */
+static int
+run_sweep (const char *method, uint32_t window, double rate, int low,
+    int high, const uint32_t *note_range, sweep_result *res)
+{
+  aubio_arena_t *arena = new_aubio_arena (4 * window * sizeof (smpl_t), 1);
+  if (!arena) return -1;
+  aubio_arena_enter (arena);
+  aubio_pitch_t *pitch = new_aubio_pitch (method, window, DETECTOR_HOP_SIZE,
+      (uint_t)rate);
+  fvec_t *in = new_fvec (DETECTOR_HOP_SIZE);
+  fvec_t *out = new_fvec (1);
+  aubio_arena_leave (arena);
+  if (!pitch) {
+    del_aubio_arena (arena);
+    return -1;
+  }
+  /* as the plugin sets it from its note range ports */
+  aubio_pitch_set_range (pitch,
+      note_range[0] > 0 ? aubio_miditofreq (note_range[0] - .5) : 0.,
+      note_range[1] < 127 ? aubio_miditofreq (note_range[1] + .5) : 0.);
+  uint32_t n_note = (uint32_t)(SWEEP_NOTE_S * rate) / DETECTOR_HOP_SIZE;
+  uint32_t skip = (window + DETECTOR_HOP_SIZE - 1) / DETECTOR_HOP_SIZE;
+  double total = 0.;
+  memset (res, 0, sizeof (*res));
+  res->lowest = res->highest = -1;
+  for (int note = low; note <= high; note++) {
+    double f0 = 440. * pow (2., (note - 69) / 12.);
+    uint32_t right = 0, counted = 0;
+    for (uint32_t hop = 0; hop < n_note; hop++) {
+      for (uint32_t i = 0; i < DETECTOR_HOP_SIZE; i++) {
+        double t = (hop * DETECTOR_HOP_SIZE + i) / rate, s = 0.;
+        for (int h = 1; h <= 4; h++) {
+          if (f0 * h < rate / 2) s += sin (2. * M_PI * f0 * h * t) / h;
+        }
+        in->data[i] = (float)(0.4 * s);
+      }
+      double t0 = now_ns ();
+      aubio_pitch_do (pitch, in, out);
+      total += now_ns () - t0;
+      res->n_hops++;
+      if (hop < skip) continue;
+      counted++;
+      if (out->data[0] <= 0.) continue;
+      double error = 1200. * log2 (out->data[0] / f0);
+      double octaves = round (error / 1200.);
+      if (octaves != 0. && fabs (error - 1200. * octaves) <= SWEEP_GROSS_CENTS)
+        res->n_octave++;
+      double cents = fabs (error);
+      if (cents > SWEEP_GROSS_CENTS) continue;
+      res->cents_sum += cents;
+      right++;
+    }
+    res->n_right += right;
+    if (counted && right >= 0.9 * counted) {
+      if (res->lowest < 0) res->lowest = note;
+      res->highest = note;
+    }
+  }
+  res->ns_per_hop = res->n_hops ? total / res->n_hops : 0.;
+  /* only the hops that were counted */
+  res->n_hops = (high - low + 1) * (n_note > skip ? n_note - skip : 0);
+  aubio_arena_enter (arena);
+  del_fvec (out);
+  del_fvec (in);
+  del_aubio_pitch (pitch);
+  aubio_arena_leave (arena);
+  del_aubio_arena (arena);
+  return 0;
+}
+
+typedef struct {
+  double ns_per_hop;
+  double worst_ns;
+  uint32_t n_hops;
+  uint32_t n_notes;   /* chord notes in the hops counted */
+  uint32_t n_found;   /* of which found */
+  uint32_t n_extra;   /* notes found that were not in the chord */
+} chord_result;
+
+/* feed the polyphonic mcomb each chord in turn through a front-end, as the
+ * plugin does, leaving out the hops whose window still holds some of the
+ * previous chord */
+static int
+run_chords (uint32_t window, double rate, uint32_t voices, chord_result *res)
+{
+  aubio_frontend_t *f = new_aubio_frontend (window, DETECTOR_HOP_SIZE);
+  aubio_pitch_t *pitch = new_aubio_pitch ("mcomb", window, DETECTOR_HOP_SIZE,
+      (uint_t)rate);
+  fvec_t *in = new_fvec (DETECTOR_HOP_SIZE);
+  fvec_t *out = new_fvec (voices);
+  if (!f || !pitch) {
+    if (f) del_aubio_frontend (f);
+    if (pitch) del_aubio_pitch (pitch);
+    del_fvec (in);
+    del_fvec (out);
+    return -1;
+  }
+  aubio_frontend_add_spectrum (f, window);
+  uint32_t n_chord = (uint32_t)(CHORD_S * rate) / DETECTOR_HOP_SIZE;
+  uint32_t skip = (window + DETECTOR_HOP_SIZE - 1) / DETECTOR_HOP_SIZE;
+  uint32_t n_chords = sizeof (chords) / sizeof (chords[0]), frame = 0;
+  double total = 0.;
+  memset (res, 0, sizeof (*res));
+  for (uint32_t c = 0; c < n_chords; c++) {
+    for (uint32_t hop = 0; hop < n_chord; hop++) {
+      for (uint32_t i = 0; i < DETECTOR_HOP_SIZE; i++, frame++) {
+        double t = frame / rate, s = 0.;
+        for (int k = 0; k < MAX_CHORD_NOTES && chords[c][k]; k++) {
+          double f0 = 440. * pow (2., (chords[c][k] - 69) / 12.);
+          for (int h = 1; h <= 4; h++) {
+            if (f0 * h < rate / 2) s += sin (2. * M_PI * f0 * h * t) / h;
+          }
+        }
+        in->data[i] = (float)(0.2 * s);
+      }
+      aubio_frontend_do (f, in);
+      /* computed by the front-end once for all the detectors, left out */
+      aubio_frontend_get_spectrum (f, window, 1);
+      double t0 = now_ns ();
+      uint_t n = aubio_pitch_do_multi_frontend (pitch, f, out);
+      double dt = now_ns () - t0;
+      total += dt;
+      if (dt > res->worst_ns) res->worst_ns = dt;
+      res->n_hops++;
+      if (hop < skip) continue;
+      for (int k = 0; k < MAX_CHORD_NOTES && chords[c][k]; k++) {
+        res->n_notes++;
+        for (uint_t v = 0; v < n; v++) {
+          if (floor (0.5 + aubio_freqtomidi (out->data[v])) == chords[c][k]) {
+            res->n_found++;
+            break;
+          }
+        }
+      }
+      for (uint_t v = 0; v < n; v++) {
+        int note = (int)floor (0.5 + aubio_freqtomidi (out->data[v])), k;
+        for (k = 0; k < MAX_CHORD_NOTES && chords[c][k]; k++) {
+          if (chords[c][k] == note) break;
+        }
+        if (k == MAX_CHORD_NOTES || !chords[c][k]) res->n_extra++;
+      }
+    }
+  }
+  res->ns_per_hop = res->n_hops ? total / res->n_hops : 0.;
+  del_fvec (out);
+  del_fvec (in);
+  del_aubio_pitch (pitch);
+  del_aubio_frontend (f);
+  return 0;
+}
+
+/* run the incremental and the whole YIN difference functions on the same
+ * frames, as aubio_pitch_do would slide them */
+static int
+run_yin (const float *audio, uint32_t n_frames, double *incremental_ns,
+    double *whole_ns, double *max_error, uint32_t *n_hops)
+{
+  aubio_pitchyin_t *inc = new_aubio_pitchyin (YIN_WIN_SIZE);
+  aubio_pitchyin_t *whole = new_aubio_pitchyin (YIN_WIN_SIZE);
+  fvec_t *frame = new_fvec (YIN_WIN_SIZE);
+  fvec_t *a = new_fvec (1), *b = new_fvec (1);
+  uint32_t overlap = YIN_WIN_SIZE - DETECTOR_HOP_SIZE;
+  int failed = aubio_pitchyin_set_hopsize (inc, DETECTOR_HOP_SIZE) ? -1 : 0;
+  *incremental_ns = *whole_ns = *max_error = 0.;
+  *n_hops = 0;
+  for (uint32_t pos = 0; !failed && pos + DETECTOR_HOP_SIZE <= n_frames;
+      pos += DETECTOR_HOP_SIZE) {
+    memmove (frame->data, frame->data + DETECTOR_HOP_SIZE,
+        overlap * sizeof (smpl_t));
+    memcpy (frame->data + overlap, audio + pos,
+        DETECTOR_HOP_SIZE * sizeof (smpl_t));
+    if ((pos / DETECTOR_HOP_SIZE) % YIN_SKIP_PERIOD == YIN_SKIP_PERIOD - 1)
+      continue;
+    double t0 = now_ns ();
+    aubio_pitchyin_do (inc, frame, a);
+    double t1 = now_ns ();
+    aubio_pitchyin_do (whole, frame, b);
+    *whole_ns += now_ns () - t1;
+    *incremental_ns += t1 - t0;
+    double err = fabs (a->data[0] - b->data[0]);
+    if (err > *max_error) *max_error = err;
+    (*n_hops)++;
+  }
+  if (*n_hops) {
+    *incremental_ns /= *n_hops;
+    *whole_ns /= *n_hops;
+  }
+  del_fvec (b);
+  del_fvec (a);
+  del_fvec (frame);
+  del_aubio_pitchyin (whole);
+  del_aubio_pitchyin (inc);
+  return failed;
+}
+
+typedef struct {
+  double yin_ns;
+  double yinfast_ns;
+  double max_semitones;   /* largest difference where both found a period */
+  uint32_t n_hops;
+  uint32_t n_mismatch;    /* hops with a period from one method only */
+} yinfast_result;
+
+/* run yin and yinfast on the same frames, slid as aubio_pitch_do would */
+static int
+run_yinfast (uint32_t window, const float *audio, uint32_t n_frames,
+    yinfast_result *res)
+{
+  aubio_pitchyin_t *yin = new_aubio_pitchyin (window);
+  aubio_pitchyinfast_t *fast = new_aubio_pitchyinfast (window);
+  fvec_t *frame = new_fvec (window);
+  fvec_t *a = new_fvec (1), *b = new_fvec (1);
+  uint32_t overlap = window - DETECTOR_HOP_SIZE;
+  memset (res, 0, sizeof (*res));
+  if (!yin || !fast || window <= DETECTOR_HOP_SIZE) {
+    if (yin) del_aubio_pitchyin (yin);
+    if (fast) del_aubio_pitchyinfast (fast);
+    del_fvec (frame);
+    del_fvec (a);
+    del_fvec (b);
+    return -1;
+  }
+  for (uint32_t pos = 0; pos + DETECTOR_HOP_SIZE <= n_frames;
+      pos += DETECTOR_HOP_SIZE) {
+    memmove (frame->data, frame->data + DETECTOR_HOP_SIZE,
+        overlap * sizeof (smpl_t));
+    memcpy (frame->data + overlap, audio + pos,
+        DETECTOR_HOP_SIZE * sizeof (smpl_t));
+    double t0 = now_ns ();
+    aubio_pitchyin_do (yin, frame, a);
+    double t1 = now_ns ();
+    aubio_pitchyinfast_do (fast, frame, b);
+    res->yinfast_ns += now_ns () - t1;
+    res->yin_ns += t1 - t0;
+    res->n_hops++;
+    if ((a->data[0] > 0.) != (b->data[0] > 0.)) {
+      res->n_mismatch++;
+    } else if (a->data[0] > 0.) {
+      double d = fabs (12. * log2 (a->data[0] / b->data[0]));
+      if (d > res->max_semitones) res->max_semitones = d;
+    }
+  }
+  if (res->n_hops) {
+    res->yin_ns /= res->n_hops;
+    res->yinfast_ns /= res->n_hops;
+  }
+  del_fvec (b);
+  del_fvec (a);
+  del_fvec (frame);
+  del_aubio_pitchyinfast (fast);
+  del_aubio_pitchyin (yin);
+  return 0;
+}
+
+/* time the fused onset descriptor pass against the separate descriptors,
+ * on the spectra the plugin computes for its onset detector */
+static int
+run_descriptors (const float *audio, uint32_t n_frames, double *fused_ns,
+    double *separate_ns, double *max_error)
+{
+  aubio_frontend_t *f = new_aubio_frontend (DESCRIPTOR_WIN_SIZE,
+      DETECTOR_HOP_SIZE);
+  aubio_specdesc_t *all = new_aubio_specdesc ("all", DESCRIPTOR_WIN_SIZE);
+  aubio_specdesc_t *one[NUM_DESCRIPTORS];
+  fvec_t *in = new_fvec (DETECTOR_HOP_SIZE);
+  fvec_t *fused = new_fvec (NUM_DESCRIPTORS);
+  fvec_t *separate = new_fvec (1);
+  uint32_t n_hops = 0;
+  *fused_ns = *separate_ns = *max_error = 0.;
+  aubio_frontend_add_spectrum (f, DESCRIPTOR_WIN_SIZE);
+  for (int i = 0; i < NUM_DESCRIPTORS; i++) {
+    /* onset_names[0] is "default", the descriptors follow in order */
+    one[i] = new_aubio_specdesc (onset_names[i + 1], DESCRIPTOR_WIN_SIZE);
+  }
+  for (uint32_t pos = 0; pos + DETECTOR_HOP_SIZE <= n_frames;
+      pos += DETECTOR_HOP_SIZE) {
+    memcpy (in->data, audio + pos, DETECTOR_HOP_SIZE * sizeof (float));
+    aubio_frontend_do (f, in);
+    const cvec_t *spectrum = aubio_frontend_get_spectrum (f,
+        DESCRIPTOR_WIN_SIZE, 1);
+    double t0 = now_ns ();
+    aubio_specdesc_do (all, spectrum, fused);
+    double t1 = now_ns ();
+    *fused_ns += t1 - t0;
+    for (int i = 0; i < NUM_DESCRIPTORS; i++) {
+      t0 = now_ns ();
+      aubio_specdesc_do (one[i], spectrum, separate);
+      *separate_ns += now_ns () - t0;
+      double a = fused->data[i], b = separate->data[0];
+      double err = fabs (a - b) / fmax (fabs (b), 1.);
+      if (err > *max_error) *max_error = err;
+    }
+    n_hops++;
+  }
+  if (n_hops) {
+    *fused_ns /= n_hops;
+    *separate_ns /= n_hops;
+  }
+  for (int i = 0; i < NUM_DESCRIPTORS; i++) del_aubio_specdesc (one[i]);
+  del_aubio_specdesc (all);
+  del_fvec (separate);
+  del_fvec (fused);
+  del_fvec (in);
+  del_aubio_frontend (f);
+  return 0;
+}
+
+static uint32_t
+parse_sizes (char *list, uint32_t *sizes, uint32_t max)
+{
+  uint32_t n = 0;
+  for (char *tok = strtok (list, ","); tok && n < max;
+      tok = strtok (NULL, ",")) {
+    if (atoi (tok) > 0) sizes[n++] = atoi (tok);
+  }
+  return n;
+}
+
+static int
+lookup (const char *name, const char **names, int n)
+{
+  for (int i = 0; i < n; i++) {
+    if (!strcmp (name, names[i])) return i;
+  }
+  char *end;
+  long v = strtol (name, &end, 10);
+  if (*end == '\0' && v >= 0 && v < n) return (int)v;
+  return -1;
+}
+
+static void
+usage (void)
+{
+  fprintf (stderr, "usage: harmonizer_bench [-d seconds] [-r rate] "
+      "[-q fraction] [-w file.wav] [-n] [-o onset_method] [-p pitch_method] "
+      "[-b block,block,...] [-W window,window,...] [-s kernels] [-e] "
+      "[-D] [-l tier,tier,...] [-I count,count,...] [-M low,high] "
+      "[-R low,high] [-Y] [-F] [-T] [-P voices,voices,...]\n");
+}
+
+int
+main (int argc, char **argv)
+{
+  double rate = 44100., seconds = 5., quiet = 0.;
+  const char *wav = NULL;
+  const char *simd = NULL;
+  int use_worker = 1;
+  int descriptors = 0, compare_descriptors = 0, compare_yin = 0;
+  int compare_yinfast = 0;
+  int trigger = 0;
+  int only_onset = -1, only_pitch = -1;
+  uint32_t block_sizes[MAX_BLOCK_SIZES];
+  uint32_t n_block_sizes = sizeof (default_block_sizes)
+    / sizeof (default_block_sizes[0]);
+  memcpy (block_sizes, default_block_sizes, sizeof (default_block_sizes));
+  uint32_t window_sizes[MAX_WINDOW_SIZES];
+  uint32_t n_window_sizes = 0;
+  uint32_t latency_tiers[NUM_LATENCY_TIERS] = { 2 };
+  uint32_t n_latency_tiers = 1;
+  uint32_t instance_counts[MAX_INSTANCE_COUNTS];
+  uint32_t n_instance_counts = 0;
+  uint32_t sweep[2];
+  uint32_t n_sweep = 0;
+  uint32_t note_range[2] = { 0, 127 };
+  uint32_t polyphony[MAX_POLYPHONY_LIMITS];
+  uint32_t n_polyphony = 0;
+
+  int opt;
+  while ((opt = getopt (argc, argv, "d:r:q:w:no:p:b:W:s:eDYFTl:I:M:R:P:h")) != -1) {
+    switch (opt) {
+      case 'd':
+        seconds = atof (optarg);
+        break;
+      case 'r':
+        rate = atof (optarg);
+        break;
+      case 'q':
+        quiet = atof (optarg);
+        if (quiet < 0. || quiet > 1.) {
+          usage ();
+          return 1;
+        }
+        break;
+      case 'w':
+        wav = optarg;
+        break;
+      case 's':
+        simd = optarg;
+        break;
+      case 'n':
+        use_worker = 0;
+        break;
+      case 'e':
+        descriptors = 1;
+        break;
+      case 'D':
+        compare_descriptors = 1;
+        break;
+      case 'Y':
+        compare_yin = 1;
+        break;
+      case 'F':
+        compare_yinfast = 1;
+        break;
+      case 'T':
+        trigger = 1;
+        break;
+      case 'l':
+        n_latency_tiers = 0;
+        for (char *tok = strtok (optarg, ","); tok; tok = strtok (NULL, ",")) {
+          int t = lookup (tok, tier_names, NUM_LATENCY_TIERS);
+          if (t < 0 || n_latency_tiers == NUM_LATENCY_TIERS) {
+            n_latency_tiers = 0;
+            break;
+          }
+          latency_tiers[n_latency_tiers++] = t;
+        }
+        if (!n_latency_tiers) {
+          usage ();
+          return 1;
+        }
+        break;
+      case 'o':
+        only_onset = lookup (optarg, onset_names, NUM_ONSET_METHODS);
+        if (only_onset < 0) {
+          fprintf (stderr, "unknown onset method %s\n", optarg);
+          return 1;
+        }
+        break;
+      case 'p':
+        only_pitch = lookup (optarg, pitch_names, NUM_PITCH_METHODS);
+        if (only_pitch < 0) {
+          fprintf (stderr, "unknown pitch method %s\n", optarg);
+          return 1;
+        }
+        break;
+      case 'b':
+        n_block_sizes = parse_sizes (optarg, block_sizes, MAX_BLOCK_SIZES);
+        if (!n_block_sizes) {
+          usage ();
+          return 1;
+        }
+        break;
+      case 'W':
+        n_window_sizes = parse_sizes (optarg, window_sizes, MAX_WINDOW_SIZES);
+        if (!n_window_sizes) {
+          usage ();
+          return 1;
+        }
+        break;
+      case 'M':
+        n_sweep = parse_sizes (optarg, sweep, 2);
+        if (n_sweep != 2 || sweep[0] > sweep[1] || sweep[1] > 127) {
+          usage ();
+          return 1;
+        }
+        break;
+      case 'R':
+        if (parse_sizes (optarg, note_range, 2) != 2
+            || note_range[0] > note_range[1] || note_range[1] > 127) {
+          usage ();
+          return 1;
+        }
+        break;
+      case 'P':
+        n_polyphony = parse_sizes (optarg, polyphony, MAX_POLYPHONY_LIMITS);
+        if (!n_polyphony) {
+          usage ();
+          return 1;
+        }
+        break;
+      case 'I':
+        n_instance_counts = parse_sizes (optarg, instance_counts,
+            MAX_INSTANCE_COUNTS);
+        if (!n_instance_counts) {
+          usage ();
+          return 1;
+        }
+        break;
+      default:
+        usage ();
+        return opt == 'h' ? 0 : 1;
+    }
+  }
+
+  uint32_t n_frames = 0;
+  float *audio = wav ? read_wav (wav, &rate, &n_frames)
+    : make_synthetic (rate, seconds, quiet, &n_frames);
+  uint32_t note_period = wav ? 0 : (uint32_t)(SYNTH_NOTE_S * rate)
+    + (uint32_t)(SYNTH_GAP_S * rate);
+  if (!audio) return 1;
+  if (aubio_simd_init (simd)) {
+    free (audio);
+    return 1;
+  }
+
+  if (compare_descriptors) {
+    double fused_ns, separate_ns, max_error;
+    run_descriptors (audio, n_frames, &fused_ns, &separate_ns, &max_error);
+    printf ("{\n  \"source\": \"%s\",\n", wav ? wav : "synthetic");
+    printf ("  \"simd\": \"%s\",\n", aubio_simd_get_name ());
+    printf ("  \"window\": %u,\n", DESCRIPTOR_WIN_SIZE);
+    printf ("  \"fused_us_per_hop\": %.2f,\n", fused_ns / 1e3);
+    printf ("  \"separate_us_per_hop\": %.2f,\n", separate_ns / 1e3);
+    printf ("  \"max_relative_error\": %.3g\n}\n", max_error);
+    free (audio);
+    return 0;
+  }
+
+  if (compare_yinfast) {
+    uint32_t yin_window = YIN_WIN_SIZE;
+    const uint32_t *windows = n_window_sizes ? window_sizes : &yin_window;
+    uint32_t n_windows = n_window_sizes ? n_window_sizes : 1;
+    int failed = 0;
+    printf ("{\n  \"source\": \"%s\",\n", wav ? wav : "synthetic");
+    printf ("  \"hop_size\": %u,\n", DETECTOR_HOP_SIZE);
+    printf ("  \"max_semitones_allowed\": %.3g,\n", YINFAST_MAX_SEMITONES);
+    printf ("  \"windows\": [");
+    for (uint32_t w = 0; w < n_windows; w++) {
+      yinfast_result res;
+      if (run_yinfast (windows[w], audio, n_frames, &res)) {
+        failed = 1;
+        continue;
+      }
+      if (res.max_semitones > YINFAST_MAX_SEMITONES || res.n_mismatch)
+        failed = 1;
+      printf ("%s\n    {\"window\": %u, \"hops\": %u, "
+          "\"yin_us_per_hop\": %.2f, \"yinfast_us_per_hop\": %.2f, "
+          "\"max_semitones\": %.3g, \"mismatched_hops\": %u}",
+          w ? "," : "", windows[w], res.n_hops, res.yin_ns / 1e3,
+          res.yinfast_ns / 1e3, res.max_semitones, res.n_mismatch);
+      fflush (stdout);
+    }
+    printf ("\n  ],\n  \"pass\": %s\n}\n", failed ? "false" : "true");
+    free (audio);
+    return failed;
+  }
+
+  if (compare_yin) {
+    double incremental_ns, whole_ns, max_error;
+    uint32_t n_hops;
+    int failed = run_yin (audio, n_frames, &incremental_ns, &whole_ns,
+        &max_error, &n_hops);
+    printf ("{\n  \"source\": \"%s\",\n", wav ? wav : "synthetic");
+    printf ("  \"window\": %u,\n", YIN_WIN_SIZE);
+    printf ("  \"hop_size\": %u,\n", DETECTOR_HOP_SIZE);
+    printf ("  \"hops\": %u,\n", n_hops);
+    printf ("  \"incremental_us_per_hop\": %.2f,\n", incremental_ns / 1e3);
+    printf ("  \"whole_us_per_hop\": %.2f,\n", whole_ns / 1e3);
+    printf ("  \"max_period_error\": %.3g\n}\n", max_error);
+    free (audio);
+    return failed || max_error > YIN_MAX_PERIOD_ERROR;
+  }
+
+  if (n_sweep) {
+    uint32_t window = n_window_sizes ? window_sizes[0] : SWEEP_WIN_SIZE;
+    printf ("{\n  \"samplerate\": %.0f,\n", rate);
+    printf ("  \"simd\": \"%s\",\n", aubio_simd_get_name ());
+    printf ("  \"window\": %u,\n", window);
+    printf ("  \"hop_size\": %u,\n", DETECTOR_HOP_SIZE);
+    printf ("  \"notes\": [%u, %u],\n", sweep[0], sweep[1]);
+    printf ("  \"note_range\": [%u, %u],\n", note_range[0], note_range[1]);
+    printf ("  \"detectors\": [");
+    int first = 1, failed = 0;
+    for (int p = 0; p < NUM_PITCH_METHODS; p++) {
+      if (only_pitch >= 0 && p != only_pitch) continue;
+      sweep_result res;
+      if (run_sweep (pitch_names[p], window, rate, sweep[0], sweep[1],
+            note_range, &res)) {
+        failed = 1;
+        continue;
+      }
+      printf ("%s\n    {\"pitch_method\": \"%s\", \"us_per_hop\": %.2f, "
+          "\"right\": %.3f, \"octave_errors\": %.3f, \"mean_cents\": %.2f, "
+          "\"lowest_note\": %d, \"highest_note\": %d}",
+          first ? "" : ",", pitch_names[p], res.ns_per_hop / 1e3,
+          res.n_hops ? (double)res.n_right / res.n_hops : 0.,
+          res.n_hops ? (double)res.n_octave / res.n_hops : 0.,
+          res.n_right ? res.cents_sum / res.n_right : 0.,
+          res.lowest, res.highest);
+      fflush (stdout);
+      first = 0;
+    }
+    printf ("\n  ]\n}\n");
+    free (audio);
+    return failed;
+  }
+
+  if (n_polyphony) {
+    uint32_t window = n_window_sizes ? window_sizes[0] : SWEEP_WIN_SIZE;
+    printf ("{\n  \"samplerate\": %.0f,\n", rate);
+    printf ("  \"simd\": \"%s\",\n", aubio_simd_get_name ());
+    printf ("  \"window\": %u,\n", window);
+    printf ("  \"hop_size\": %u,\n", DETECTOR_HOP_SIZE);
+    printf ("  \"polyphony\": [");
+    int failed = 0;
+    for (uint32_t i = 0; i < n_polyphony; i++) {
+      chord_result res;
+      if (run_chords (window, rate, polyphony[i], &res)) {
+        failed = 1;
+        continue;
+      }
+      printf ("%s\n    {\"voices\": %u, \"us_per_hop\": %.2f, "
+          "\"worst_hop_us\": %.2f, \"found\": %.3f, \"extra_per_hop\": %.3f}",
+          i ? "," : "", polyphony[i], res.ns_per_hop / 1e3,
+          res.worst_ns / 1e3,
+          res.n_notes ? (double)res.n_found / res.n_notes : 0.,
+          res.n_hops ? (double)res.n_extra / res.n_hops : 0.);
+      fflush (stdout);
+    }
+    printf ("\n  ]\n}\n");
+    free (audio);
+    return failed;
+  }
+
+  if (n_window_sizes) {
+    printf ("{\n  \"source\": \"%s\",\n", wav ? wav : "synthetic");
+    printf ("  \"samplerate\": %.0f,\n", rate);
+    printf ("  \"simd\": \"%s\",\n", aubio_simd_get_name ());
+    printf ("  \"hop_size\": %u,\n", DETECTOR_HOP_SIZE);
+    printf ("  \"detectors\": [");
+    int first = 1, failed = 0;
+    for (int p = 0; p < NUM_PITCH_METHODS; p++) {
+      if (only_pitch >= 0 && p != only_pitch) continue;
+      for (uint32_t w = 0; w < n_window_sizes; w++) {
+        double ns_per_hop, first_ns = 0., next_ns = 0.;
+        if (run_detector (pitch_names[p], window_sizes[w], rate, audio,
+              n_frames, &ns_per_hop, &first_ns)
+            || time_first_hops (pitch_names[p], window_sizes[w], rate, audio,
+              &first_ns, &next_ns)) {
+          failed = 1;
+          continue;
+        }
+        double ratio = next_ns > 0. ? first_ns / next_ns : 0.;
+        if (ratio > FIRST_HOP_MAX_RATIO) failed = 1;
+        printf ("%s\n    {\"pitch_method\": \"%s\", \"window\": %u, "
+            "\"us_per_hop\": %.2f, \"ns_per_sample\": %.2f, "
+            "\"first_hop_us\": %.2f, \"next_hop_us\": %.2f, "
+            "\"first_hop_ratio\": %.2f}",
+            first ? "" : ",", pitch_names[p], window_sizes[w],
+            ns_per_hop / 1e3, ns_per_hop / DETECTOR_HOP_SIZE, first_ns / 1e3,
+            next_ns / 1e3, ratio);
+        fflush (stdout);
+        first = 0;
+      }
+    }
+    printf ("\n  ],\n  \"pass\": %s\n}\n", failed ? "false" : "true");
+    free (audio);
+    return failed;
+  }
+
+  bench_urid_table urids;
+  memset (&urids, 0, sizeof (urids));
+  LV2_URID_Map map = { &urids, bench_map };
+  bench_log_state log_state;
+  log_state.log_Error = bench_map (&urids, LV2_LOG__Error);
+  log_state.log_Warning = bench_map (&urids, LV2_LOG__Warning);
+  LV2_Log_Log log = { &log_state, bench_printf, bench_vprintf };
+  LV2_Feature map_feature = { LV2_URID__map, &map };
+  LV2_Feature log_feature = { LV2_LOG__log, &log };
+  bench_worker worker;
+  LV2_Worker_Schedule schedule = { &worker, bench_schedule_work };
+  LV2_Feature schedule_feature = { LV2_WORKER__schedule, &schedule };
+  const LV2_Feature *features[] = { &map_feature, &log_feature,
+    use_worker ? &schedule_feature : NULL, NULL };
+  LV2_URID midi_MidiEvent = bench_map (&urids, LV2_MIDI__MidiEvent);
+
+  const LV2_Descriptor *desc = NULL;
+  for (uint32_t i = 0; (desc = lv2_descriptor (i)); i++) {
+    if (!strcmp (desc->URI, HARMONIZER_URI)) break;
+  }
+  if (!desc) {
+    fprintf (stderr, "harmonizer_bench: %s not found\n", HARMONIZER_URI);
+    return 1;
+  }
+
+  if (n_instance_counts) {
+    printf ("{\n  \"plugin\": \"%s\",\n", desc->URI);
+    printf ("  \"samplerate\": %.0f,\n", rate);
+    printf ("  \"worker\": %s,\n", use_worker ? "true" : "false");
+    printf ("  \"instances\": [");
+    int failed = 0;
+    for (uint32_t i = 0; i < n_instance_counts; i++) {
+      double ns, bytes;
+      uint32_t n_tables;
+      if (run_instances (desc, features, rate, instance_counts[i], &ns,
+            &bytes, &n_tables)) {
+        failed = 1;
+        continue;
+      }
+      printf ("%s\n    {\"count\": %u, "
+          "\"instantiate_us_per_instance\": %.1f, "
+          "\"bytes_per_instance\": %.0f, \"shared_tables\": %u}",
+          i ? "," : "", instance_counts[i], ns / 1e3, bytes, n_tables);
+      fflush (stdout);
+    }
+    printf ("\n  ]\n}\n");
+    free (audio);
+    for (uint32_t i = 0; i < urids.n_uris; i++) free (urids.uris[i]);
+    return failed;
+  }
+
+  printf ("{\n  \"plugin\": \"%s\",\n", desc->URI);
+  printf ("  \"source\": \"%s\",\n", wav ? wav : "synthetic");
+  if (!wav) printf ("  \"quiet\": %.2f,\n", quiet);
+  printf ("  \"samplerate\": %.0f,\n", rate);
+  printf ("  \"frames\": %u,\n", n_frames);
+  printf ("  \"worker\": %s,\n", use_worker ? "true" : "false");
+  printf ("  \"descriptors\": %s,\n", descriptors ? "true" : "false");
+  printf ("  \"trigger\": %s,\n", trigger ? "true" : "false");
+  printf ("  \"note_range\": [%u, %u],\n", note_range[0], note_range[1]);
+  printf ("  \"simd\": \"%s\",\n", aubio_simd_get_name ());
+  printf ("  \"results\": [");
+  int first = 1, failed = 0;
+  for (uint32_t t = 0; t < n_latency_tiers; t++) {
+    int tier = latency_tiers[t];
+    for (int o = 0; o < NUM_ONSET_METHODS; o++) {
+      if (only_onset >= 0 && o != only_onset) continue;
+      for (int p = 0; p < NUM_PITCH_METHODS; p++) {
+        if (only_pitch >= 0 && p != only_pitch) continue;
+        for (uint32_t b = 0; b < n_block_sizes; b++) {
+          bench_result res;
+          if (run_one (desc, features, &worker, midi_MidiEvent, rate, audio,
+                n_frames, note_period, block_sizes[b], o, p, tier,
+                descriptors, note_range, trigger, &res)) {
+            failed = 1;
+            continue;
+          }
+          uint32_t processed = res.n_runs * block_sizes[b];
+          printf ("%s\n    {\"latency_tier\": \"%s\", "
+              "\"onset_method\": \"%s\", \"pitch_method\": \"%s\", "
+              "\"block_size\": %u, \"instantiate_us\": %.1f, "
+              "\"instance_bytes\": %.0f, \"worker_jobs\": %u, "
+              "\"run_page_faults\": %ld, "
+              "\"ns_per_sample\": %.2f, \"mean_run_us\": %.2f, "
+              "\"worst_run_us\": %.2f, \"first_run_us\": %.2f, "
+              "\"note_on\": %u, \"note_off\": %u, "
+              "\"reported_latency_ms\": %.2f",
+              first ? "" : ",", tier_names[tier], onset_names[o],
+              pitch_names[p], block_sizes[b], res.instantiate_ns / 1e3, res.instance_bytes,
+              res.n_jobs, res.run_faults, processed ? res.total_ns / processed : 0.,
+              res.n_runs ? res.total_ns / res.n_runs / 1e3 : 0.,
+              res.worst_ns / 1e3, res.first_ns / 1e3, res.note_on, res.note_off,
+              1e3 * res.reported_latency / rate);
+          if (res.n_timed) {
+            double mean = res.latency_sum / res.n_timed;
+            double var = res.latency_sq_sum / res.n_timed - mean * mean;
+            printf (", \"latency_ms\": %.2f, \"latency_stddev_ms\": %.3f, "
+                "\"latency_spread_ms\": %.3f, \"retriggers\": %u", 1e3 * mean / rate,
+                1e3 * sqrt (var > 0. ? var : 0.) / rate,
+                1e3 * (res.latency_max - res.latency_min) / rate,
+                res.n_retriggers);
+          }
+          printf ("}");
+          fflush (stdout);
+          first = 0;
+        }
+      }
+    }
+  }
+  printf ("\n  ]\n}\n");
+
+  free (audio);
+  for (uint32_t i = 0; i < urids.n_uris; i++) free (urids.uris[i]);
+  return failed;
+}
@@ -1,14 +1,18 @@
 #include <string.h>
 #include "RingBuffer.h"
 
-RingBuffer::RingBuffer( int sizeBytes )
+RingBuffer::RingBuffer( int minSamples )
 {
-	_data = new unsigned char[sizeBytes];
-	memset( _data, 0, sizeBytes );
-	_size = sizeBytes;
-	_readPtr = 0;
-	_writePtr = 0;
-	_writeBytesAvail = sizeBytes;
+	_size = 1;
+	while( _size < (unsigned int)minSamples )
+	{
+		_size <<= 1;
+	}
+	_mask = _size - 1;
+	_data = new float[_size];
+	memset( _data, 0, _size * sizeof(float) );
+	_readPos.store( 0, std::memory_order_relaxed );
+	_writePos.store( 0, std::memory_order_relaxed );
 }
 
 RingBuffer::~RingBuffer( )
@@ -19,79 +23,108 @@ RingBuffer::~RingBuffer( )
 // Set all data to 0 and flag buffer as empty.
 bool RingBuffer::Empty( void )
 {
-    memset( _data, 0, _size );
-    _readPtr = 0;
-    _writePtr = 0;
-    _writeBytesAvail = _size;
-    return true;
+	memset( _data, 0, _size * sizeof(float) );
+	_readPos.store( 0, std::memory_order_relaxed );
+	_writePos.store( 0, std::memory_order_relaxed );
+	return true;
 }
 
-int RingBuffer::Read( unsigned char *dataPtr, int numBytes )
+// Write a block of samples.  Do not overwrite data that has not yet been
+// read; returns the number of samples actually written.
+int RingBuffer::Write( const float *dataPtr, int numSamples )
 {
-	// If there's nothing to read or no data available, then we can't read anything.
-	if( dataPtr == 0 || numBytes <= 0 || _writeBytesAvail == _size )
+	unsigned int w = _writePos.load( std::memory_order_relaxed );
+	unsigned int r = _readPos.load( std::memory_order_acquire );
+	unsigned int avail = _size - (w - r);
+
+	if( dataPtr == 0 || numSamples <= 0 || avail == 0 )
 	{
-    		return 0;
+		return 0;
 	}
-
-	int readBytesAvail = _size - _writeBytesAvail;
-
-	// Cap our read at the number of bytes available to be read.
-	if( numBytes > readBytesAvail )
+	if( (unsigned int)numSamples > avail )
 	{
-    		numBytes = readBytesAvail;
+		numSamples = avail;
 	}
 
-	// Simultaneously keep track of how many bytes we've read and our position in the outgoing buffer
-	if(numBytes > _size - _readPtr)
+	unsigned int start = w & _mask;
+	unsigned int len = _size - start;
+	if( (unsigned int)numSamples > len )
 	{
-    		int len = _size-_readPtr;
-    		memcpy(dataPtr,_data+_readPtr,len);
-    		memcpy(dataPtr+len, _data, numBytes-len);
+		memcpy( _data + start, dataPtr, len * sizeof(float) );
+		memcpy( _data, dataPtr + len, (numSamples - len) * sizeof(float) );
 	}
 	else
 	{
-    		memcpy(dataPtr, _data+_readPtr, numBytes);
+		memcpy( _data + start, dataPtr, numSamples * sizeof(float) );
 	}
 
-	_readPtr = (_readPtr + numBytes) % _size;
-	_writeBytesAvail += numBytes;
-
-	return numBytes;
+	_writePos.store( w + numSamples, std::memory_order_release );
+	return numSamples;
 }
 
-// Write to the ring buffer.  Do not overwrite data that has not yet
-// been read.
-int RingBuffer::Write( unsigned char *dataPtr, int numBytes )
+// Return a pointer to the next numSamples samples if they are readable and
+// contiguous in memory, NULL otherwise.  The view stays valid until
+// Advance() is called.
+const float *RingBuffer::Peek( int numSamples )
 {
-	// If there's nothing to write or no room available, we can't write anything.
-	if( dataPtr == 0 || numBytes <= 0 || _writeBytesAvail == 0 )
+	unsigned int r = _readPos.load( std::memory_order_relaxed );
+	unsigned int w = _writePos.load( std::memory_order_acquire );
+	unsigned int start = r & _mask;
+
+	if( numSamples <= 0 || (unsigned int)numSamples > w - r
+	    || (unsigned int)numSamples > _size - start )
 	{
-    		return 0;
+		return 0;
 	}
+	return _data + start;
+}
+
+int RingBuffer::Read( float *dataPtr, int numSamples )
+{
+	unsigned int r = _readPos.load( std::memory_order_relaxed );
+	unsigned int w = _writePos.load( std::memory_order_acquire );
+	unsigned int avail = w - r;
 
-	// Cap our write at the number of bytes available to be written.
-	if( numBytes > _writeBytesAvail )
+	if( dataPtr == 0 || numSamples <= 0 || avail == 0 )
 	{
-    		numBytes = _writeBytesAvail;
+		return 0;
+	}
+	if( (unsigned int)numSamples > avail )
+	{
+		numSamples = avail;
 	}
 
-	// Simultaneously keep track of how many bytes we've written and our position in the incoming buffer
-	if(numBytes > _size - _writePtr)
+	unsigned int start = r & _mask;
+	unsigned int len = _size - start;
+	if( (unsigned int)numSamples > len )
 	{
-    		int len = _size-_writePtr;
-    		memcpy(_data+_writePtr,dataPtr,len);
-    		memcpy(_data, dataPtr+len, numBytes-len);
+		memcpy( dataPtr, _data + start, len * sizeof(float) );
+		memcpy( dataPtr + len, _data, (numSamples - len) * sizeof(float) );
 	}
 	else
 	{
-    		memcpy(_data+_writePtr, dataPtr, numBytes);
+		memcpy( dataPtr, _data + start, numSamples * sizeof(float) );
 	}
 
-	_writePtr = (_writePtr + numBytes) % _size;
-	_writeBytesAvail -= numBytes;
+	_readPos.store( r + numSamples, std::memory_order_release );
+	return numSamples;
+}
+
+// Release samples previously obtained with Peek().
+void RingBuffer::Advance( int numSamples )
+{
+	unsigned int r = _readPos.load( std::memory_order_relaxed );
+	unsigned int avail = _writePos.load( std::memory_order_acquire ) - r;
 
-	return numBytes;
+	if( numSamples <= 0 )
+	{
+		return;
+	}
+	if( (unsigned int)numSamples > avail )
+	{
+		numSamples = avail;
+	}
+	_readPos.store( r + numSamples, std::memory_order_release );
 }
 
 int RingBuffer::GetSize( void )
@@ -101,10 +134,12 @@ int RingBuffer::GetSize( void )
 
 int RingBuffer::GetWriteAvail( void )
 {
-	return _writeBytesAvail;
+	return _size - (_writePos.load( std::memory_order_relaxed )
+	    - _readPos.load( std::memory_order_acquire ));
 }
 
 int RingBuffer::GetReadAvail( void )
 {
-	return _size - _writeBytesAvail;
+	return _writePos.load( std::memory_order_acquire )
+	    - _readPos.load( std::memory_order_relaxed );
 }
@@ -1,18 +1,35 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <atomic>
+
+// Single-producer/single-consumer ring buffer of float samples.  The size
+// is rounded up to a power of two so positions wrap with a mask; the read
+// and write positions run freely and are only masked on access.  Write()
+// may be called from one thread while Peek()/Read()/Advance() are called
+// from another.
 class RingBuffer
 {
   public:
-    RingBuffer( int sizeBytes );
+    RingBuffer( int minSamples );
     ~RingBuffer();
-    int Read( unsigned char* dataPtr, int numBytes );
-    int Write( unsigned char *dataPtr, int numBytes );
+    // producer side
+    int Write( const float *dataPtr, int numSamples );
+    int GetWriteAvail( void );
+    // consumer side
+    const float *Peek( int numSamples );
+    int Read( float *dataPtr, int numSamples );
+    void Advance( int numSamples );
+    int GetReadAvail( void );
+    // only safe when neither side is running
     bool Empty( void );
-    int GetSize( );
-    int GetWriteAvail( );
-    int GetReadAvail( );
+    int GetSize( void );
   private:
-    unsigned char * _data;
-    int _size;
-    int _readPtr;
-    int _writePtr;
-    int _writeBytesAvail;
+    float * _data;
+    unsigned int _size;
+    unsigned int _mask;
+    std::atomic<unsigned int> _readPos;
+    std::atomic<unsigned int> _writePos;
 };
+
+#endif
@@ -0,0 +1,207 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "utils/arena.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#endif
+
+/* one cache line */
+#define AUBIO_ARENA_ALIGN 64
+
+#ifdef _MSC_VER
+#define AUBIO_THREAD_LOCAL __declspec(thread)
+#else
+#define AUBIO_THREAD_LOCAL __thread
+#endif
+
+typedef struct _aubio_arena_chunk_t aubio_arena_chunk_t;
+
+struct _aubio_arena_chunk_t {
+  aubio_arena_chunk_t *next;  /**< chunk allocated before this one */
+  char_t *data;               /**< memory, AUBIO_ARENA_ALIGN aligned */
+  size_t size;                /**< bytes in data */
+  size_t used;                /**< bytes handed out */
+  uint_t locked;              /**< whether data is locked in memory */
+};
+
+struct _aubio_arena_t {
+  size_t chunk_size;          /**< size of new chunks */
+  uint_t lock;                /**< lock new chunks in memory */
+  size_t used;                /**< bytes handed out in all chunks */
+  aubio_arena_chunk_t *chunks;  /**< newest chunk first */
+  aubio_arena_t *previous;    /**< arena entered before this one */
+};
+
+/* arena the new_aubio_ functions of this thread allocate from */
+static AUBIO_THREAD_LOCAL aubio_arena_t *aubio_arena_current = NULL;
+
+static aubio_arena_chunk_t *
+new_aubio_arena_chunk (size_t size, uint_t lock)
+{
+  aubio_arena_chunk_t *c = (aubio_arena_chunk_t *)calloc (1, sizeof (*c));
+  if (!c) return NULL;
+  size = (size + AUBIO_ARENA_ALIGN - 1) & ~(size_t)(AUBIO_ARENA_ALIGN - 1);
+#ifdef _WIN32
+  c->data = (char_t *)_aligned_malloc (size, AUBIO_ARENA_ALIGN);
+#else
+  if (posix_memalign ((void **)&c->data, AUBIO_ARENA_ALIGN, size) != 0) {
+    c->data = NULL;
+  }
+#endif
+  if (!c->data) {
+    free (c);
+    return NULL;
+  }
+  c->size = size;
+  /* touch every page now rather than on first use */
+  memset (c->data, 0, size);
+#ifndef _WIN32
+  /* locking needs privileges the process may not have, run without */
+  if (lock) c->locked = mlock (c->data, size) == 0;
+#endif
+  return c;
+}
+
+static void
+del_aubio_arena_chunk (aubio_arena_chunk_t * c)
+{
+#ifdef _WIN32
+  _aligned_free (c->data);
+#else
+  if (c->locked) munlock (c->data, c->size);
+  free (c->data);
+#endif
+  free (c);
+}
+
+aubio_arena_t *
+new_aubio_arena (uint_t size, uint_t lock)
+{
+  aubio_arena_t *a;
+  if ((sint_t)size < 1) {
+    AUBIO_ERR ("arena: got size %d, but can not be < 1\n", size);
+    return NULL;
+  }
+  a = (aubio_arena_t *)calloc (1, sizeof (aubio_arena_t));
+  if (!a) return NULL;
+  a->chunk_size = size;
+  a->lock = lock;
+  a->chunks = new_aubio_arena_chunk (size, lock);
+  if (!a->chunks) {
+    free (a);
+    return NULL;
+  }
+  return a;
+}
+
+void
+del_aubio_arena (aubio_arena_t * a)
+{
+  while (a->chunks) {
+    aubio_arena_chunk_t *next = a->chunks->next;
+    del_aubio_arena_chunk (a->chunks);
+    a->chunks = next;
+  }
+  free (a);
+}
+
+void
+aubio_arena_enter (aubio_arena_t * a)
+{
+  a->previous = aubio_arena_current;
+  aubio_arena_current = a;
+}
+
+void
+aubio_arena_leave (aubio_arena_t * a)
+{
+  aubio_arena_current = a->previous;
+  a->previous = NULL;
+}
+
+void *
+aubio_arena_alloc (aubio_arena_t * a, uint_t size)
+{
+  aubio_arena_chunk_t *c = a->chunks;
+  size_t n = ((size_t)size + AUBIO_ARENA_ALIGN - 1)
+    & ~(size_t)(AUBIO_ARENA_ALIGN - 1);
+  void *p;
+  if (n == 0) n = AUBIO_ARENA_ALIGN;
+  if (c->size - c->used < n) {
+    /* a large block that does not fit gets a chunk of its own, after the
+     * current one so that the space left in it can still be used */
+    uint_t large = n > a->chunk_size / 4;
+    c = new_aubio_arena_chunk (large ? n : a->chunk_size, a->lock);
+    if (!c) return NULL;
+    if (large) {
+      c->next = a->chunks->next;
+      a->chunks->next = c;
+    } else {
+      c->next = a->chunks;
+      a->chunks = c;
+    }
+  }
+  p = c->data + c->used;
+  c->used += n;
+  a->used += n;
+  return p;
+}
+
+uint_t
+aubio_arena_get_used (const aubio_arena_t * a)
+{
+  return (uint_t)a->used;
+}
+
+static uint_t
+aubio_arena_owns (const aubio_arena_t * a, const void * p)
+{
+  const aubio_arena_chunk_t *c;
+  for (c = a->chunks; c; c = c->next) {
+    if ((const char_t *)p >= c->data && (const char_t *)p < c->data + c->size)
+      return 1;
+  }
+  return 0;
+}
+
+void *
+aubio_calloc (size_t size)
+{
+  if (aubio_arena_current) {
+    return aubio_arena_alloc (aubio_arena_current, (uint_t)size);
+  }
+  return calloc (size, 1);
+}
+
+void
+aubio_free (void * p)
+{
+  /* blocks of the entered arenas go back with them */
+  const aubio_arena_t *a;
+  for (a = aubio_arena_current; a; a = a->previous) {
+    if (aubio_arena_owns (a, p)) return;
+  }
+  free (p);
+}
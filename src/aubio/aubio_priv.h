@@ -121,6 +121,14 @@
 #undef HAVE_NOOPT
 #endif
 
+/* vectorized kernels, selected at run time by aubio_simd_init() */
+#if !defined(HAVE_ACCELERATE) && !HAVE_AUBIO_DOUBLE && \
+  (defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__)))
+#define HAVE_SIMD 1
+#else
+#undef HAVE_SIMD
+#endif
+
 #include "types.h"
 
 #define AUBIO_UNSTABLE 1
@@ -133,14 +141,18 @@
  *
  */
 
-/* Memory management */
+/* Memory management, from the arena the thread entered if any, see
+ * utils/arena.h */
+void *aubio_calloc (size_t size);
+void aubio_free (void *p);
+
 #define AUBIO_MALLOC(_n)             malloc(_n)
 #define AUBIO_REALLOC(_p,_n)         realloc(_p,_n)
-#define AUBIO_NEW(_t)                (_t*)calloc(sizeof(_t), 1)
-#define AUBIO_ARRAY(_t,_n)           (_t*)calloc((_n)*sizeof(_t), 1)
+#define AUBIO_NEW(_t)                (_t*)aubio_calloc(sizeof(_t))
+#define AUBIO_ARRAY(_t,_n)           (_t*)aubio_calloc((_n)*sizeof(_t))
 #define AUBIO_MEMCPY(_dst,_src,_n)   memcpy(_dst,_src,_n)
 #define AUBIO_MEMSET(_dst,_src,_t)   memset(_dst,_src,_t)
-#define AUBIO_FREE(_p)               free(_p)
+#define AUBIO_FREE(_p)               aubio_free(_p)
 
 
 /* file interface */
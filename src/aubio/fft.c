@@ -23,6 +23,10 @@
 #include "cvec.h"
 #include "mathutils.h"
 #include "spectral/fft.h"
+#include "spectral/mixfft.h"
+#include "spectral/pffft.h"
+#include "utils/tables.h"
+#include "simd.h"
 
 #ifdef HAVE_FFTW3             // using FFTW3
 /* note that <complex.h> is not included here but only in aubio_priv.h, so that
@@ -74,6 +78,12 @@ typedef FFTW_TYPE fft_data_t;
 #define real_t double
 #endif /* HAVE_FFTW3F */
 
+#ifndef AUBIO_FFTW_PLANNER
+/** planner flags; measuring is slow but only done once per size and process,
+ * FFTW keeps the result as wisdom for the following plans */
+#define AUBIO_FFTW_PLANNER FFTW_MEASURE
+#endif
+
 // a global mutex for FFTW thread safety
 pthread_mutex_t aubio_fftw_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -112,121 +122,299 @@ pthread_mutex_t aubio_fftw_mutex = PTHREAD_MUTEX_INITIALIZER;
 #define aubio_vvsqrt                   vvsqrt
 #endif /* HAVE_AUBIO_DOUBLE */
 
-#else                         // using OOURA
-// let's use ooura instead
+#endif /* HAVE_ACCELERATE */
+#endif /* HAVE_FFTW3 */
+
+// ooura is always built in, for power of two sizes
 extern void rdft(int, int, smpl_t *, int *, smpl_t *);
+extern void makewt(int, int *, smpl_t *);
+extern void makect(int, int *, smpl_t *);
 
-#endif /* HAVE_ACCELERATE */
+/** fft backends */
+typedef enum {
+  aubio_fft_ooura,      /**< `ooura`, Ooura's split-radix, power of two sizes */
+  aubio_fft_mixfft,     /**< `mixfft`, built-in mixed-radix, any size */
+  aubio_fft_pffft,      /**< `pffft`, SIMD, multiples of 32, single precision */
+  aubio_fft_fftw,       /**< `fftw3f` or `fftw3`, if built with HAVE_FFTW3 */
+  aubio_fft_accelerate, /**< `accelerate`, if built with HAVE_ACCELERATE */
+} aubio_fft_backend_t;
+
+/* the backends compiled in, by name */
+static const struct {
+  const char_t *name;
+  aubio_fft_backend_t backend;
+} aubio_fft_backends[] = {
+  { "ooura", aubio_fft_ooura },
+  { "mixfft", aubio_fft_mixfft },
+#if !HAVE_AUBIO_DOUBLE
+  { "pffft", aubio_fft_pffft },
+#endif /* !HAVE_AUBIO_DOUBLE */
+#ifdef HAVE_FFTW3
+#ifdef HAVE_FFTW3F
+  { "fftw3f", aubio_fft_fftw },
+#else
+  { "fftw3", aubio_fft_fftw },
+#endif
 #endif /* HAVE_FFTW3 */
+#ifdef HAVE_ACCELERATE
+  { "accelerate", aubio_fft_accelerate },
+#endif /* HAVE_ACCELERATE */
+};
+
+#define AUBIO_FFT_N_BACKENDS \
+  (sizeof (aubio_fft_backends) / sizeof (aubio_fft_backends[0]))
 
 struct _aubio_fft_t {
   uint_t winsize;
   uint_t fft_size;
+  aubio_fft_backend_t backend;
+  smpl_t *in, *out;
 #ifdef HAVE_FFTW3             // using FFTW3
-  real_t *in, *out;
   fftw_plan pfw, pbw;
   fft_data_t * specdata;      /* complex spectral data */
-#else
+#endif /* HAVE_FFTW3 */
 #ifdef HAVE_ACCELERATE        // using ACCELERATE
   int log2fftsize;
   aubio_FFTSetup fftSetup;
   aubio_DSPSplitComplex spec;
-  smpl_t *in, *out;
-#else                         // using OOURA
-  smpl_t *in, *out;
-  smpl_t *w;
-  int *ip;
 #endif /* HAVE_ACCELERATE */
-#endif /* HAVE_FFTW3 */
+  const smpl_t *w;            /* ooura twiddles, shared */
+  int *ip;                    /* ooura work area */
+  aubio_mixfft_t *mix;        /* mixed-radix plan */
+#if !HAVE_AUBIO_DOUBLE
+  PFFFT_Setup *pffft;         /* pffft twiddles; in, out and work are aligned */
+  smpl_t *work;
+#endif /* !HAVE_AUBIO_DOUBLE */
   fvec_t * compspec;
 };
 
+/* ooura twiddles for a size, computed once as rdft would on its first call;
+ * the two ints rdft keeps in ip[0] and ip[1] to know the tables are ready
+ * follow them. Without its scratch area the table is left unbuilt: with
+ * ip[1] still 0, rdft would build it on the first call, in place */
+static uint_t aubio_fft_ooura_init (void * data, const char_t * kind,
+    uint_t winsize, uint_t samplerate) {
+  smpl_t *w = (smpl_t *)data;
+  int *ready = (int *)(w + winsize / 2 + 1);
+  int n = (int)winsize, nw = n >> 2, nc = n >> 2;
+  /* rdft only writes its bit reversal work area at ip + 2 */
+  int *ip = (int *)calloc (winsize / 2 + 1, sizeof (int));
+  if (!ip) return AUBIO_FAIL;
+  makewt(nw, ip, w);
+  if (n > (ip[1] << 2)) makect(nc, ip, w + nw);
+  ready[0] = ip[0];
+  ready[1] = ip[1];
+  free (ip);
+  return AUBIO_OK;
+}
+
+#if !HAVE_AUBIO_DOUBLE
+/* whether pffft_new_setup takes this size: a multiple of 32 with no prime
+ * factor other than 2, 3 and 5 */
+static uint_t aubio_fft_pffft_size (uint_t winsize) {
+  uint_t n = winsize / 32, f;
+  if (winsize == 0 || winsize % 32 != 0) return 0;
+  for (f = 2; f <= 5; f++) {
+    while (n % f == 0) n /= f;
+  }
+  return n == 1;
+}
+#endif /* !HAVE_AUBIO_DOUBLE */
+
 aubio_fft_t * new_aubio_fft (uint_t winsize) {
+  return new_aubio_fft_with_backend (winsize, "default");
+}
+
+aubio_fft_t * new_aubio_fft_with_backend (uint_t winsize,
+    const char_t * backend) {
   aubio_fft_t * s = AUBIO_NEW(aubio_fft_t);
+  uint_t i;
   if ((sint_t)winsize < 2) {
     AUBIO_ERR("fft: got winsize %d, but can not be < 2\n", winsize);
     goto beach;
   }
-#ifdef HAVE_FFTW3
-  uint_t i;
-  s->winsize  = winsize;
-  /* allocate memory */
-  s->in       = AUBIO_ARRAY(real_t,winsize);
-  s->out      = AUBIO_ARRAY(real_t,winsize);
-  s->compspec = new_fvec(winsize);
-  /* create plans */
-  pthread_mutex_lock(&aubio_fftw_mutex);
-#ifdef HAVE_COMPLEX_H
-  s->fft_size = winsize/2 + 1;
-  s->specdata = (fft_data_t*)fftw_malloc(sizeof(fft_data_t)*s->fft_size);
-  s->pfw = fftw_plan_dft_r2c_1d(winsize, s->in,  s->specdata, FFTW_ESTIMATE);
-  s->pbw = fftw_plan_dft_c2r_1d(winsize, s->specdata, s->out, FFTW_ESTIMATE);
+  if (strcmp (backend, "default") == 0) {
+#if defined(HAVE_FFTW3)
+    s->backend = aubio_fft_fftw;
+#elif defined(HAVE_ACCELERATE)
+    s->backend = aubio_is_power_of_two(winsize) ? aubio_fft_accelerate
+      : aubio_fft_mixfft;
 #else
-  s->fft_size = winsize;
-  s->specdata = (fft_data_t*)fftw_malloc(sizeof(fft_data_t)*s->fft_size);
-  s->pfw = fftw_plan_r2r_1d(winsize, s->in,  s->specdata, FFTW_R2HC, FFTW_ESTIMATE);
-  s->pbw = fftw_plan_r2r_1d(winsize, s->specdata, s->out, FFTW_HC2R, FFTW_ESTIMATE);
+    s->backend = aubio_is_power_of_two(winsize) ? aubio_fft_ooura
+      : aubio_fft_mixfft;
+#if !HAVE_AUBIO_DOUBLE
+    /* vectorised, pffft takes about half the time of ooura in fft_bench;
+     * its scalar fallback does not beat it */
+    if (pffft_simd_size() > 1 && aubio_fft_pffft_size(winsize)) {
+      s->backend = aubio_fft_pffft;
+    }
+#endif /* !HAVE_AUBIO_DOUBLE */
 #endif
-  pthread_mutex_unlock(&aubio_fftw_mutex);
-  for (i = 0; i < s->winsize; i++) {
-    s->in[i] = 0.;
-    s->out[i] = 0.;
-  }
-  for (i = 0; i < s->fft_size; i++) {
-    s->specdata[i] = 0.;
+  } else {
+    for (i = 0; i < AUBIO_FFT_N_BACKENDS; i++) {
+      if (strcmp (backend, aubio_fft_backends[i].name) == 0) break;
+    }
+    if (i == AUBIO_FFT_N_BACKENDS) {
+      AUBIO_ERR("fft: unknown backend %s\n", backend);
+      goto beach;
+    }
+    s->backend = aubio_fft_backends[i].backend;
   }
-#else
-#ifdef HAVE_ACCELERATE        // using ACCELERATE
   s->winsize = winsize;
-  s->fft_size = winsize;
-  s->compspec = new_fvec(winsize);
-  s->log2fftsize = (uint_t)log2f(s->fft_size);
-  s->in = AUBIO_ARRAY(smpl_t, s->fft_size);
-  s->out = AUBIO_ARRAY(smpl_t, s->fft_size);
-  s->spec.realp = AUBIO_ARRAY(smpl_t, s->fft_size/2);
-  s->spec.imagp = AUBIO_ARRAY(smpl_t, s->fft_size/2);
-  s->fftSetup = aubio_vDSP_create_fftsetup(s->log2fftsize, FFT_RADIX2);
-#else                         // using OOURA
-  if (aubio_is_power_of_two(winsize) != 1) {
-    AUBIO_ERR("fft: can only create with sizes power of two,"
-              " requested %d\n", winsize);
-    goto beach;
+  switch (s->backend) {
+    case aubio_fft_ooura:
+      if (aubio_is_power_of_two(winsize) != 1) {
+        AUBIO_ERR("fft: ooura can only create with sizes power of two,"
+            " requested %d\n", winsize);
+        goto beach;
+      }
+      s->fft_size = winsize / 2 + 1;
+      s->in    = AUBIO_ARRAY(smpl_t, s->winsize);
+      s->out   = AUBIO_ARRAY(smpl_t, s->winsize);
+      s->ip    = AUBIO_ARRAY(int   , s->fft_size);
+      s->w     = (const smpl_t *)aubio_table_acquire ("ooura", winsize, 0,
+          s->fft_size * sizeof(smpl_t) + 2 * sizeof(int),
+          aubio_fft_ooura_init);
+      if (!s->w) goto beach;
+      /* the tables are there already, rdft will only read them */
+      s->ip[0] = ((const int *)(s->w + s->fft_size))[0];
+      s->ip[1] = ((const int *)(s->w + s->fft_size))[1];
+      break;
+    case aubio_fft_mixfft:
+      s->fft_size = winsize / 2 + 1;
+      s->mix = new_aubio_mixfft (winsize);
+      if (!s->mix) goto beach;
+      break;
+#if !HAVE_AUBIO_DOUBLE
+    case aubio_fft_pffft:
+      s->pffft = pffft_new_setup (winsize, PFFFT_REAL);
+      if (!s->pffft) {
+        AUBIO_ERR("fft: pffft can only create with sizes multiple of 32"
+            " made of factors 2, 3 and 5, requested %d\n", winsize);
+        goto beach;
+      }
+      s->fft_size = winsize / 2 + 1;
+      s->in   = (smpl_t *)pffft_aligned_malloc (winsize * sizeof(smpl_t));
+      s->out  = (smpl_t *)pffft_aligned_malloc (winsize * sizeof(smpl_t));
+      s->work = (smpl_t *)pffft_aligned_malloc (winsize * sizeof(smpl_t));
+      break;
+#endif /* !HAVE_AUBIO_DOUBLE */
+#ifdef HAVE_FFTW3
+    case aubio_fft_fftw:
+      /* allocate memory */
+      s->in       = AUBIO_ARRAY(real_t,winsize);
+      s->out      = AUBIO_ARRAY(real_t,winsize);
+      /* create plans */
+      pthread_mutex_lock(&aubio_fftw_mutex);
+#ifdef HAVE_COMPLEX_H
+      s->fft_size = winsize/2 + 1;
+      s->specdata = (fft_data_t*)fftw_malloc(sizeof(fft_data_t)*s->fft_size);
+      s->pfw = fftw_plan_dft_r2c_1d(winsize, s->in,  s->specdata,
+          AUBIO_FFTW_PLANNER);
+      s->pbw = fftw_plan_dft_c2r_1d(winsize, s->specdata, s->out,
+          AUBIO_FFTW_PLANNER);
+#else
+      s->fft_size = winsize;
+      s->specdata = (fft_data_t*)fftw_malloc(sizeof(fft_data_t)*s->fft_size);
+      s->pfw = fftw_plan_r2r_1d(winsize, s->in,  s->specdata, FFTW_R2HC,
+          AUBIO_FFTW_PLANNER);
+      s->pbw = fftw_plan_r2r_1d(winsize, s->specdata, s->out, FFTW_HC2R,
+          AUBIO_FFTW_PLANNER);
+#endif
+      pthread_mutex_unlock(&aubio_fftw_mutex);
+      /* measuring plans scribbles over the buffers */
+      for (i = 0; i < s->winsize; i++) {
+        s->in[i] = 0.;
+        s->out[i] = 0.;
+      }
+      for (i = 0; i < s->fft_size; i++) {
+        s->specdata[i] = 0.;
+      }
+      break;
+#endif /* HAVE_FFTW3 */
+#ifdef HAVE_ACCELERATE
+    case aubio_fft_accelerate:
+      if (aubio_is_power_of_two(winsize) != 1) {
+        AUBIO_ERR("fft: accelerate can only create with sizes power of two,"
+            " requested %d\n", winsize);
+        goto beach;
+      }
+      s->fft_size = winsize;
+      s->log2fftsize = (uint_t)log2f(s->fft_size);
+      s->in = AUBIO_ARRAY(smpl_t, s->fft_size);
+      s->out = AUBIO_ARRAY(smpl_t, s->fft_size);
+      s->spec.realp = AUBIO_ARRAY(smpl_t, s->fft_size/2);
+      s->spec.imagp = AUBIO_ARRAY(smpl_t, s->fft_size/2);
+      s->fftSetup = aubio_vDSP_create_fftsetup(s->log2fftsize, FFT_RADIX2);
+      break;
+#endif /* HAVE_ACCELERATE */
+    default:
+      AUBIO_ERR("fft: backend %s was not built in\n", backend);
+      goto beach;
   }
-  s->winsize = winsize;
-  s->fft_size = winsize / 2 + 1;
   s->compspec = new_fvec(winsize);
-  s->in    = AUBIO_ARRAY(smpl_t, s->winsize);
-  s->out   = AUBIO_ARRAY(smpl_t, s->winsize);
-  s->ip    = AUBIO_ARRAY(int   , s->fft_size);
-  s->w     = AUBIO_ARRAY(smpl_t, s->fft_size);
-  s->ip[0] = 0;
-#endif /* HAVE_ACCELERATE */
-#endif /* HAVE_FFTW3 */
   return s;
 beach:
+  if (s->in) AUBIO_FREE(s->in);
+  if (s->out) AUBIO_FREE(s->out);
+  if (s->ip) AUBIO_FREE(s->ip);
+  if (s->w) aubio_table_release(s->w);
   AUBIO_FREE(s);
   return NULL;
 }
 
+const char_t * aubio_fft_get_backend(const aubio_fft_t * s) {
+  uint_t i;
+  for (i = 0; i < AUBIO_FFT_N_BACKENDS; i++) {
+    if (aubio_fft_backends[i].backend == s->backend) break;
+  }
+  return aubio_fft_backends[i].name;
+}
+
+const char_t * aubio_fft_get_backend_name (uint_t i) {
+  return i < AUBIO_FFT_N_BACKENDS ? aubio_fft_backends[i].name : NULL;
+}
+
 void del_aubio_fft(aubio_fft_t * s) {
   /* destroy data */
   del_fvec(s->compspec);
+  switch (s->backend) {
 #ifdef HAVE_FFTW3             // using FFTW3
-  fftw_destroy_plan(s->pfw);
-  fftw_destroy_plan(s->pbw);
-  fftw_free(s->specdata);
-#else /* HAVE_FFTW3 */
+    case aubio_fft_fftw:
+      /* the planner is not thread safe either when plans are destroyed */
+      pthread_mutex_lock(&aubio_fftw_mutex);
+      fftw_destroy_plan(s->pfw);
+      fftw_destroy_plan(s->pbw);
+      pthread_mutex_unlock(&aubio_fftw_mutex);
+      fftw_free(s->specdata);
+      break;
+#endif /* HAVE_FFTW3 */
 #ifdef HAVE_ACCELERATE        // using ACCELERATE
-  AUBIO_FREE(s->spec.realp);
-  AUBIO_FREE(s->spec.imagp);
-  aubio_vDSP_destroy_fftsetup(s->fftSetup);
-#else                         // using OOURA
-  AUBIO_FREE(s->w);
-  AUBIO_FREE(s->ip);
+    case aubio_fft_accelerate:
+      AUBIO_FREE(s->spec.realp);
+      AUBIO_FREE(s->spec.imagp);
+      aubio_vDSP_destroy_fftsetup(s->fftSetup);
+      break;
 #endif /* HAVE_ACCELERATE */
-#endif /* HAVE_FFTW3 */
-  AUBIO_FREE(s->out);
-  AUBIO_FREE(s->in);
+    case aubio_fft_mixfft:
+      del_aubio_mixfft(s->mix);
+      break;
+#if !HAVE_AUBIO_DOUBLE
+    case aubio_fft_pffft:
+      pffft_destroy_setup(s->pffft);
+      pffft_aligned_free(s->work);
+      pffft_aligned_free(s->out);
+      pffft_aligned_free(s->in);
+      s->in = s->out = NULL;
+      break;
+#endif /* !HAVE_AUBIO_DOUBLE */
+    default:                  // using OOURA
+      aubio_table_release(s->w);
+      AUBIO_FREE(s->ip);
+      break;
+  }
+  if (s->out) AUBIO_FREE(s->out);
+  if (s->in) AUBIO_FREE(s->in);
   AUBIO_FREE(s);
 }
 
@@ -235,6 +423,34 @@ void aubio_fft_do(aubio_fft_t * s, const fvec_t * input, cvec_t * spectrum) {
   aubio_fft_get_spectrum(s->compspec, spectrum);
 }
 
+void aubio_fft_do_norm(aubio_fft_t * s, const fvec_t * input, cvec_t * spectrum) {
+  aubio_fft_do_complex(s, input, s->compspec);
+  aubio_fft_get_norm(s->compspec, spectrum);
+}
+
+void aubio_fft_do_bins(aubio_fft_t * s, const fvec_t * input,
+    cvec_t * spectrum, uint_t bins) {
+  const fvec_t *c = s->compspec;
+  aubio_fft_do_complex(s, input, s->compspec);
+  if (bins >= spectrum->length) {
+    aubio_fft_get_spectrum(c, spectrum);
+    return;
+  }
+  /* none of them is the last, real, bin */
+  spectrum->norm[0] = ABS(c->data[0]);
+  spectrum->phas[0] = c->data[0] < 0 ? PI : 0.;
+#if defined(HAVE_SIMD)
+  aubio_simd->spec_norm(c->data, c->length, spectrum->norm, bins);
+  aubio_simd->spec_phas(c->data, c->length, spectrum->phas, bins);
+#else
+  uint_t i;
+  for (i = 1; i < bins; i++) {
+    spectrum->norm[i] = SQRT(SQR(c->data[i]) + SQR(c->data[c->length - i]));
+    spectrum->phas[i] = ATAN2(c->data[c->length - i], c->data[i]);
+  }
+#endif
+}
+
 void aubio_fft_rdo(aubio_fft_t * s, const cvec_t * spectrum, fvec_t * output) {
   aubio_fft_get_realimag(spectrum, s->compspec);
   aubio_fft_rdo_complex(s, s->compspec, output);
@@ -242,6 +458,11 @@ void aubio_fft_rdo(aubio_fft_t * s, const cvec_t * spectrum, fvec_t * output) {
 
 void aubio_fft_do_complex(aubio_fft_t * s, const fvec_t * input, fvec_t * compspec) {
   uint_t i;
+  if (s->backend == aubio_fft_mixfft) {
+    /* no copy needed, the input is read once */
+    aubio_mixfft_do(s->mix, input->data, compspec->data);
+    return;
+  }
 #ifndef HAVE_MEMCPY_HACKS
   for (i=0; i < s->winsize; i++) {
     s->in[i] = input->data[i];
@@ -249,101 +470,155 @@ void aubio_fft_do_complex(aubio_fft_t * s, const fvec_t * input, fvec_t * compsp
 #else
   memcpy(s->in, input->data, s->winsize * sizeof(smpl_t));
 #endif /* HAVE_MEMCPY_HACKS */
+  switch (s->backend) {
 #ifdef HAVE_FFTW3             // using FFTW3
-  fftw_execute(s->pfw);
+    case aubio_fft_fftw:
+      fftw_execute(s->pfw);
 #ifdef HAVE_COMPLEX_H
-  compspec->data[0] = REAL(s->specdata[0]);
-  for (i = 1; i < s->fft_size -1 ; i++) {
-    compspec->data[i] = REAL(s->specdata[i]);
-    compspec->data[compspec->length - i] = IMAG(s->specdata[i]);
-  }
-  compspec->data[s->fft_size-1] = REAL(s->specdata[s->fft_size-1]);
+      compspec->data[0] = REAL(s->specdata[0]);
+      for (i = 1; i < s->fft_size -1 ; i++) {
+        compspec->data[i] = REAL(s->specdata[i]);
+        compspec->data[compspec->length - i] = IMAG(s->specdata[i]);
+      }
+      compspec->data[s->fft_size-1] = REAL(s->specdata[s->fft_size-1]);
 #else /* HAVE_COMPLEX_H  */
-  for (i = 0; i < s->fft_size; i++) {
-    compspec->data[i] = s->specdata[i];
-  }
+      for (i = 0; i < s->fft_size; i++) {
+        compspec->data[i] = s->specdata[i];
+      }
 #endif /* HAVE_COMPLEX_H */
-#else /* HAVE_FFTW3 */
+      break;
+#endif /* HAVE_FFTW3 */
 #ifdef HAVE_ACCELERATE        // using ACCELERATE
-  // convert real data to even/odd format used in vDSP
-  aubio_vDSP_ctoz((aubio_DSPComplex*)s->in, 2, &s->spec, 1, s->fft_size/2);
-  // compute the FFT
-  aubio_vDSP_fft_zrip(s->fftSetup, &s->spec, 1, s->log2fftsize, FFT_FORWARD);
-  // convert from vDSP complex split to [ r0, r1, ..., rN, iN-1, .., i2, i1]
-  compspec->data[0] = s->spec.realp[0];
-  compspec->data[s->fft_size / 2] = s->spec.imagp[0];
-  for (i = 1; i < s->fft_size / 2; i++) {
-    compspec->data[i] = s->spec.realp[i];
-    compspec->data[s->fft_size - i] = s->spec.imagp[i];
-  }
-  // apply scaling
-  smpl_t scale = 1./2.;
-  aubio_vDSP_vsmul(compspec->data, 1, &scale, compspec->data, 1, s->fft_size);
-#else                         // using OOURA
-  rdft(s->winsize, 1, s->in, s->ip, s->w);
-  compspec->data[0] = s->in[0];
-  compspec->data[s->winsize / 2] = s->in[1];
-  for (i = 1; i < s->fft_size - 1; i++) {
-    compspec->data[i] = s->in[2 * i];
-    compspec->data[s->winsize - i] = - s->in[2 * i + 1];
-  }
+    case aubio_fft_accelerate:
+      {
+        // convert real data to even/odd format used in vDSP
+        aubio_vDSP_ctoz((aubio_DSPComplex*)s->in, 2, &s->spec, 1, s->fft_size/2);
+        // compute the FFT
+        aubio_vDSP_fft_zrip(s->fftSetup, &s->spec, 1, s->log2fftsize, FFT_FORWARD);
+        // convert from vDSP complex split to [ r0, r1, ..., rN, iN-1, .., i2, i1]
+        compspec->data[0] = s->spec.realp[0];
+        compspec->data[s->fft_size / 2] = s->spec.imagp[0];
+        for (i = 1; i < s->fft_size / 2; i++) {
+          compspec->data[i] = s->spec.realp[i];
+          compspec->data[s->fft_size - i] = s->spec.imagp[i];
+        }
+        // apply scaling
+        smpl_t scale = 1./2.;
+        aubio_vDSP_vsmul(compspec->data, 1, &scale, compspec->data, 1, s->fft_size);
+      }
+      break;
 #endif /* HAVE_ACCELERATE */
-#endif /* HAVE_FFTW3 */
+#if !HAVE_AUBIO_DOUBLE
+    case aubio_fft_pffft:
+      /* ordered output is [ r0, rN/2, r1, i1, ... ], unscaled */
+      pffft_transform_ordered(s->pffft, s->in, s->out, s->work,
+          PFFFT_FORWARD);
+      compspec->data[0] = s->out[0];
+      compspec->data[s->winsize / 2] = s->out[1];
+      for (i = 1; i < s->fft_size - 1; i++) {
+        compspec->data[i] = s->out[2 * i];
+        compspec->data[s->winsize - i] = s->out[2 * i + 1];
+      }
+      break;
+#endif /* !HAVE_AUBIO_DOUBLE */
+    default:                  // using OOURA
+      rdft(s->winsize, 1, s->in, s->ip, (smpl_t *)s->w);
+      compspec->data[0] = s->in[0];
+      compspec->data[s->winsize / 2] = s->in[1];
+      for (i = 1; i < s->fft_size - 1; i++) {
+        compspec->data[i] = s->in[2 * i];
+        compspec->data[s->winsize - i] = - s->in[2 * i + 1];
+      }
+      break;
+  }
 }
 
 void aubio_fft_rdo_complex(aubio_fft_t * s, const fvec_t * compspec, fvec_t * output) {
   uint_t i;
+  switch (s->backend) {
+    case aubio_fft_mixfft:
+      aubio_mixfft_rdo(s->mix, compspec->data, output->data);
+      break;
 #ifdef HAVE_FFTW3
-  const smpl_t renorm = 1./(smpl_t)s->winsize;
+    case aubio_fft_fftw:
+      {
+        const smpl_t renorm = 1./(smpl_t)s->winsize;
 #ifdef HAVE_COMPLEX_H
-  s->specdata[0] = compspec->data[0];
-  for (i=1; i < s->fft_size - 1; i++) {
-    s->specdata[i] = compspec->data[i] +
-      I * compspec->data[compspec->length - i];
-  }
-  s->specdata[s->fft_size - 1] = compspec->data[s->fft_size - 1];
+        s->specdata[0] = compspec->data[0];
+        for (i=1; i < s->fft_size - 1; i++) {
+          s->specdata[i] = compspec->data[i] +
+            I * compspec->data[compspec->length - i];
+        }
+        s->specdata[s->fft_size - 1] = compspec->data[s->fft_size - 1];
 #else
-  for (i=0; i < s->fft_size; i++) {
-    s->specdata[i] = compspec->data[i];
-  }
+        for (i=0; i < s->fft_size; i++) {
+          s->specdata[i] = compspec->data[i];
+        }
 #endif
-  fftw_execute(s->pbw);
-  for (i = 0; i < output->length; i++) {
-    output->data[i] = s->out[i]*renorm;
-  }
-#else /* HAVE_FFTW3 */
+        fftw_execute(s->pbw);
+        for (i = 0; i < output->length; i++) {
+          output->data[i] = s->out[i]*renorm;
+        }
+      }
+      break;
+#endif /* HAVE_FFTW3 */
 #ifdef HAVE_ACCELERATE        // using ACCELERATE
-  // convert from real imag  [ r0, r1, ..., rN, iN-1, .., i2, i1]
-  // to vDSP packed format   [ r0, rN, r1, i1, ..., rN-1, iN-1 ]
-  s->out[0] = compspec->data[0];
-  s->out[1] = compspec->data[s->winsize / 2];
-  for (i = 1; i < s->fft_size / 2; i++) {
-    s->out[2 * i] = compspec->data[i];
-    s->out[2 * i + 1] = compspec->data[s->winsize - i];
-  }
-  // convert to split complex format used in vDSP
-  aubio_vDSP_ctoz((aubio_DSPComplex*)s->out, 2, &s->spec, 1, s->fft_size/2);
-  // compute the FFT
-  aubio_vDSP_fft_zrip(s->fftSetup, &s->spec, 1, s->log2fftsize, FFT_INVERSE);
-  // convert result to real output
-  aubio_vDSP_ztoc(&s->spec, 1, (aubio_DSPComplex*)output->data, 2, s->fft_size/2);
-  // apply scaling
-  smpl_t scale = 1.0 / s->winsize;
-  aubio_vDSP_vsmul(output->data, 1, &scale, output->data, 1, s->fft_size);
-#else                         // using OOURA
-  smpl_t scale = 2.0 / s->winsize;
-  s->out[0] = compspec->data[0];
-  s->out[1] = compspec->data[s->winsize / 2];
-  for (i = 1; i < s->fft_size - 1; i++) {
-    s->out[2 * i] = compspec->data[i];
-    s->out[2 * i + 1] = - compspec->data[s->winsize - i];
-  }
-  rdft(s->winsize, -1, s->out, s->ip, s->w);
-  for (i=0; i < s->winsize; i++) {
-    output->data[i] = s->out[i] * scale;
-  }
+    case aubio_fft_accelerate:
+      {
+        // convert from real imag  [ r0, r1, ..., rN, iN-1, .., i2, i1]
+        // to vDSP packed format   [ r0, rN, r1, i1, ..., rN-1, iN-1 ]
+        s->out[0] = compspec->data[0];
+        s->out[1] = compspec->data[s->winsize / 2];
+        for (i = 1; i < s->fft_size / 2; i++) {
+          s->out[2 * i] = compspec->data[i];
+          s->out[2 * i + 1] = compspec->data[s->winsize - i];
+        }
+        // convert to split complex format used in vDSP
+        aubio_vDSP_ctoz((aubio_DSPComplex*)s->out, 2, &s->spec, 1, s->fft_size/2);
+        // compute the FFT
+        aubio_vDSP_fft_zrip(s->fftSetup, &s->spec, 1, s->log2fftsize, FFT_INVERSE);
+        // convert result to real output
+        aubio_vDSP_ztoc(&s->spec, 1, (aubio_DSPComplex*)output->data, 2, s->fft_size/2);
+        // apply scaling
+        smpl_t scale = 1.0 / s->winsize;
+        aubio_vDSP_vsmul(output->data, 1, &scale, output->data, 1, s->fft_size);
+      }
+      break;
 #endif /* HAVE_ACCELERATE */
-#endif /* HAVE_FFTW3 */
+#if !HAVE_AUBIO_DOUBLE
+    case aubio_fft_pffft:
+      {
+        smpl_t scale = 1.0 / s->winsize;
+        s->in[0] = compspec->data[0];
+        s->in[1] = compspec->data[s->winsize / 2];
+        for (i = 1; i < s->fft_size - 1; i++) {
+          s->in[2 * i] = compspec->data[i];
+          s->in[2 * i + 1] = compspec->data[s->winsize - i];
+        }
+        pffft_transform_ordered(s->pffft, s->in, s->out, s->work,
+            PFFFT_BACKWARD);
+        for (i = 0; i < s->winsize; i++) {
+          output->data[i] = s->out[i] * scale;
+        }
+      }
+      break;
+#endif /* !HAVE_AUBIO_DOUBLE */
+    default:                  // using OOURA
+      {
+        smpl_t scale = 2.0 / s->winsize;
+        s->out[0] = compspec->data[0];
+        s->out[1] = compspec->data[s->winsize / 2];
+        for (i = 1; i < s->fft_size - 1; i++) {
+          s->out[2 * i] = compspec->data[i];
+          s->out[2 * i + 1] = - compspec->data[s->winsize - i];
+        }
+        rdft(s->winsize, -1, s->out, s->ip, (smpl_t *)s->w);
+        for (i=0; i < s->winsize; i++) {
+          output->data[i] = s->out[i] * scale;
+        }
+      }
+      break;
+  }
 }
 
 void aubio_fft_get_spectrum(const fvec_t * compspec, cvec_t * spectrum) {
@@ -357,16 +632,23 @@ void aubio_fft_get_realimag(const cvec_t * spectrum, fvec_t * compspec) {
 }
 
 void aubio_fft_get_phas(const fvec_t * compspec, cvec_t * spectrum) {
-  uint_t i;
+  /* with odd sizes, the last bin is not real and is computed as the others */
+  uint_t n = compspec->length % 2 ? spectrum->length : spectrum->length - 1;
   if (compspec->data[0] < 0) {
     spectrum->phas[0] = PI;
   } else {
     spectrum->phas[0] = 0.;
   }
-  for (i=1; i < spectrum->length - 1; i++) {
+#if defined(HAVE_SIMD)
+  aubio_simd->spec_phas(compspec->data, compspec->length, spectrum->phas, n);
+#else
+  uint_t i;
+  for (i=1; i < n; i++) {
     spectrum->phas[i] = ATAN2(compspec->data[compspec->length-i],
         compspec->data[i]);
   }
+#endif
+  if (n == spectrum->length) return;
   if (compspec->data[compspec->length/2] < 0) {
     spectrum->phas[spectrum->length - 1] = PI;
   } else {
@@ -375,12 +657,18 @@ void aubio_fft_get_phas(const fvec_t * compspec, cvec_t * spectrum) {
 }
 
 void aubio_fft_get_norm(const fvec_t * compspec, cvec_t * spectrum) {
-  uint_t i = 0;
+  uint_t n = compspec->length % 2 ? spectrum->length : spectrum->length - 1;
   spectrum->norm[0] = ABS(compspec->data[0]);
-  for (i=1; i < spectrum->length - 1; i++) {
+#if defined(HAVE_SIMD)
+  aubio_simd->spec_norm(compspec->data, compspec->length, spectrum->norm, n);
+#else
+  uint_t i;
+  for (i=1; i < n; i++) {
     spectrum->norm[i] = SQRT(SQR(compspec->data[i])
         + SQR(compspec->data[compspec->length - i]) );
   }
+#endif
+  if (n == spectrum->length) return;
   spectrum->norm[spectrum->length-1] =
     ABS(compspec->data[compspec->length/2]);
 }
@@ -0,0 +1,229 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "cvec.h"
+#include "mathutils.h"
+#include "musicutils.h"
+#include "spectral/fft.h"
+#include "spectral/frontend.h"
+
+#define AUBIO_FRONTEND_MAX_SPECTRA 4
+
+/** spectrum of one window size */
+typedef struct {
+  uint_t win_s;         /**< window size */
+  const fvec_t *w;      /**< hanningz window, shared */
+  fvec_t *data;         /**< windowed and shifted frame */
+  fvec_t *compspec;     /**< real/imag spectrum */
+  cvec_t *grain;        /**< norm/phas spectrum */
+  aubio_fft_t *fft;     /**< fft object */
+  uint_t fft_hop;       /**< hop for which compspec was computed */
+  uint_t norm_hop;      /**< hop for which norm was computed */
+  uint_t phas_hop;      /**< hop for which phas was computed */
+} aubio_frontend_spectrum_t;
+
+struct _aubio_frontend_t {
+  uint_t max_win_s;     /**< longest window */
+  uint_t hop_s;         /**< hop size */
+  fvec_t *buf;          /**< last max_win_s samples, stored twice */
+  uint_t pos;           /**< position of the oldest sample in buf */
+  uint_t hops;          /**< hops pushed so far */
+  uint_t ffts;          /**< FFTs computed so far */
+  smpl_t db_spl;        /**< level of the latest hop */
+  uint_t db_spl_hop;    /**< hop for which db_spl was computed */
+  uint_t n_spectra;     /**< spectra in use */
+  aubio_frontend_spectrum_t spectra[AUBIO_FRONTEND_MAX_SPECTRA];
+};
+
+aubio_frontend_t *
+new_aubio_frontend (uint_t max_win_s, uint_t hop_s)
+{
+  aubio_frontend_t *f = AUBIO_NEW (aubio_frontend_t);
+  if ((sint_t)hop_s < 1) {
+    AUBIO_ERR ("frontend: got hop_size %d, but can not be < 1\n", hop_s);
+    goto beach;
+  } else if (max_win_s < hop_s) {
+    AUBIO_ERR ("frontend: hop size (%d) is larger than win size (%d)\n",
+        hop_s, max_win_s);
+    goto beach;
+  }
+  f->max_win_s = max_win_s;
+  f->hop_s = hop_s;
+  /* the second half mirrors the first, so that any frame ending at the
+   * latest sample is contiguous in memory */
+  f->buf = new_fvec (2 * max_win_s);
+  return f;
+
+beach:
+  AUBIO_FREE (f);
+  return NULL;
+}
+
+void
+del_aubio_frontend (aubio_frontend_t * f)
+{
+  uint_t i;
+  for (i = 0; i < f->n_spectra; i++) {
+    aubio_frontend_spectrum_t *s = &f->spectra[i];
+    if (s->w) aubio_window_release (s->w);
+    if (s->data) del_fvec (s->data);
+    if (s->compspec) del_fvec (s->compspec);
+    if (s->grain) del_cvec (s->grain);
+    if (s->fft) del_aubio_fft (s->fft);
+  }
+  del_fvec (f->buf);
+  AUBIO_FREE (f);
+}
+
+static aubio_frontend_spectrum_t *
+aubio_frontend_find (aubio_frontend_t * f, uint_t win_s)
+{
+  uint_t i;
+  for (i = 0; i < f->n_spectra; i++) {
+    if (f->spectra[i].win_s == win_s) return &f->spectra[i];
+  }
+  return NULL;
+}
+
+uint_t
+aubio_frontend_add_spectrum (aubio_frontend_t * f, uint_t win_s)
+{
+  aubio_frontend_spectrum_t *s;
+  if (aubio_frontend_find (f, win_s)) return AUBIO_OK;
+  if (win_s > f->max_win_s || win_s < f->hop_s) {
+    AUBIO_ERR ("frontend: can not add a window of %d samples\n", win_s);
+    return AUBIO_FAIL;
+  }
+  if (f->n_spectra == AUBIO_FRONTEND_MAX_SPECTRA) {
+    AUBIO_ERR ("frontend: no more than %d window sizes\n",
+        AUBIO_FRONTEND_MAX_SPECTRA);
+    return AUBIO_FAIL;
+  }
+  s = &f->spectra[f->n_spectra++];
+  s->win_s = win_s;
+  s->w = aubio_window_acquire ("hanningz", win_s);
+  s->data = new_fvec (win_s);
+  s->compspec = new_fvec (win_s);
+  s->grain = new_cvec (win_s);
+  s->fft = new_aubio_fft (win_s);
+  if (!s->w || !s->data || !s->compspec || !s->grain || !s->fft) {
+    return AUBIO_FAIL;
+  }
+  return AUBIO_OK;
+}
+
+void
+aubio_frontend_do (aubio_frontend_t * f, const fvec_t * hop)
+{
+  smpl_t *data = f->buf->data;
+  uint_t max = f->max_win_s;
+  /* overwrite the oldest samples in both halves, wrapping around */
+  uint_t tail = MIN (f->hop_s, max - f->pos);
+  memcpy (data + f->pos, hop->data, tail * sizeof (smpl_t));
+  memcpy (data + f->pos + max, hop->data, tail * sizeof (smpl_t));
+  memcpy (data, hop->data + tail, (f->hop_s - tail) * sizeof (smpl_t));
+  memcpy (data + max, hop->data + tail, (f->hop_s - tail) * sizeof (smpl_t));
+  f->pos = (f->pos + f->hop_s) % max;
+  f->hops++;
+}
+
+void
+aubio_frontend_get_hop (aubio_frontend_t * f, fvec_t * hop)
+{
+  hop->data = f->buf->data + f->pos + f->max_win_s - f->hop_s;
+  hop->length = f->hop_s;
+}
+
+uint_t
+aubio_frontend_get_frame (aubio_frontend_t * f, uint_t win_s, fvec_t * frame)
+{
+  if (win_s > f->max_win_s) return AUBIO_FAIL;
+  frame->data = f->buf->data + f->pos + f->max_win_s - win_s;
+  frame->length = win_s;
+  return AUBIO_OK;
+}
+
+uint_t
+aubio_frontend_has_spectrum (aubio_frontend_t * f, uint_t win_s)
+{
+  return aubio_frontend_find (f, win_s) != NULL;
+}
+
+smpl_t
+aubio_frontend_get_db_spl (aubio_frontend_t * f)
+{
+  if (f->db_spl_hop != f->hops) {
+    fvec_t hop;
+    aubio_frontend_get_hop (f, &hop);
+    f->db_spl = aubio_db_spl (&hop);
+    f->db_spl_hop = f->hops;
+  }
+  return f->db_spl;
+}
+
+/* compute the packed spectrum of the latest frame, once per hop */
+static aubio_frontend_spectrum_t *
+aubio_frontend_fft (aubio_frontend_t * f, uint_t win_s)
+{
+  aubio_frontend_spectrum_t *s = aubio_frontend_find (f, win_s);
+  if (!s) return NULL;
+  if (s->fft_hop != f->hops) {
+    fvec_t frame;
+    aubio_frontend_get_frame (f, win_s, &frame);
+    /* window and shift as aubio_pvoc_do does */
+    fvec_weighted_shift (&frame, 0, s->w, s->data);
+    aubio_fft_do_complex (s->fft, s->data, s->compspec);
+    s->fft_hop = f->hops;
+    f->ffts++;
+  }
+  return s;
+}
+
+const fvec_t *
+aubio_frontend_get_compspec (aubio_frontend_t * f, uint_t win_s)
+{
+  aubio_frontend_spectrum_t *s = aubio_frontend_fft (f, win_s);
+  return s ? s->compspec : NULL;
+}
+
+const cvec_t *
+aubio_frontend_get_spectrum (aubio_frontend_t * f, uint_t win_s,
+    uint_t phase)
+{
+  aubio_frontend_spectrum_t *s = aubio_frontend_fft (f, win_s);
+  if (!s) return NULL;
+  if (s->norm_hop != f->hops) {
+    aubio_fft_get_norm (s->compspec, s->grain);
+    s->norm_hop = f->hops;
+  }
+  if (phase && s->phas_hop != f->hops) {
+    aubio_fft_get_phas (s->compspec, s->grain);
+    s->phas_hop = f->hops;
+  }
+  return s->grain;
+}
+
+uint_t
+aubio_frontend_get_ffts (const aubio_frontend_t * f)
+{
+  return f->ffts;
+}
@@ -20,6 +20,7 @@
 
 #include "aubio_priv.h"
 #include "fvec.h"
+#include "simd.h"
 
 fvec_t * new_fvec(uint_t length) {
   fvec_t * s;
@@ -96,7 +97,9 @@ void fvec_rev(fvec_t *s) {
 }
 
 void fvec_weight(fvec_t *s, const fvec_t *weight) {
-#ifndef HAVE_ACCELERATE
+#if defined(HAVE_SIMD)
+  aubio_simd->weight(s->data, weight->data, MIN(s->length, weight->length));
+#elif !defined(HAVE_ACCELERATE)
   uint_t j;
   uint_t length = MIN(s->length, weight->length);
   for (j=0; j< length; j++) {
@@ -108,7 +111,10 @@ void fvec_weight(fvec_t *s, const fvec_t *weight) {
 }
 
 void fvec_weighted_copy(const fvec_t *in, const fvec_t *weight, fvec_t *out) {
-#ifndef HAVE_ACCELERATE
+#if defined(HAVE_SIMD)
+  aubio_simd->weighted_copy(in->data, weight->data, out->data,
+      MIN(out->length, weight->length));
+#elif !defined(HAVE_ACCELERATE)
   uint_t j;
   uint_t length = MIN(out->length, weight->length);
   for (j=0; j< length; j++) {
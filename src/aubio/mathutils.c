@@ -24,6 +24,8 @@
 #include "fvec.h"
 #include "mathutils.h"
 #include "musicutils.h"
+#include "simd.h"
+#include "utils/tables.h"
 #include "config.h"
 
 /** Window types */
@@ -57,6 +59,39 @@ new_aubio_window (char_t * window_type, uint_t length)
   return win;
 }
 
+/* shared windows are a vector followed by its elements */
+static uint_t
+aubio_window_table_init (void * data, const char_t * kind, uint_t size,
+    uint_t samplerate)
+{
+  fvec_t *win = (fvec_t *)data;
+  win->length = size;
+  win->data = (smpl_t *)(win + 1);
+  return fvec_set_window (win, (char_t *)kind);
+}
+
+const fvec_t *
+aubio_window_acquire (const char_t * window_type, uint_t size)
+{
+  fvec_t probe;
+  if ((sint_t)size < 1) {
+    AUBIO_ERR ("window: got size %d, but can not be < 1\n", size);
+    return NULL;
+  }
+  /* check the type before making a table of it */
+  probe.length = 0;
+  probe.data = NULL;
+  if (fvec_set_window (&probe, (char_t *)window_type) != 0) return NULL;
+  return (const fvec_t *)aubio_table_acquire (window_type, size, 0,
+      sizeof (fvec_t) + size * sizeof (smpl_t), aubio_window_table_init);
+}
+
+void
+aubio_window_release (const fvec_t * window)
+{
+  aubio_table_release (window);
+}
+
 uint_t fvec_set_window (fvec_t *win, char_t *window_type) {
   smpl_t * w = win->data;
   uint_t i, size = win->length;
@@ -155,7 +190,10 @@ smpl_t
 fvec_mean (fvec_t * s)
 {
   smpl_t tmp = 0.0;
-#ifndef HAVE_ACCELERATE
+#if defined(HAVE_SIMD)
+  tmp = aubio_simd->sum (s->data, s->length);
+  return tmp / (smpl_t) (s->length);
+#elif !defined(HAVE_ACCELERATE)
   uint_t j;
   for (j = 0; j < s->length; j++) {
     tmp += s->data[j];
@@ -171,7 +209,9 @@ smpl_t
 fvec_sum (fvec_t * s)
 {
   smpl_t tmp = 0.0;
-#ifndef HAVE_ACCELERATE
+#if defined(HAVE_SIMD)
+  tmp = aubio_simd->sum (s->data, s->length);
+#elif !defined(HAVE_ACCELERATE)
   uint_t j;
   for (j = 0; j < s->length; j++) {
     tmp += s->data[j];
@@ -201,7 +241,9 @@ fvec_max (fvec_t * s)
 smpl_t
 fvec_min (fvec_t * s)
 {
-#ifndef HAVE_ACCELERATE
+#if defined(HAVE_SIMD)
+  smpl_t tmp = aubio_simd->min (s->data, s->length);
+#elif !defined(HAVE_ACCELERATE)
   uint_t j;
   smpl_t tmp = s->data[0];
   for (j = 0; j < s->length; j++) {
@@ -217,7 +259,14 @@ fvec_min (fvec_t * s)
 uint_t
 fvec_min_elem (fvec_t * s)
 {
-#ifndef HAVE_ACCELERATE
+#if defined(HAVE_SIMD)
+  // last position of the minimum, as in the loop below
+  uint_t pos = s->length - 1;
+  smpl_t tmp = aubio_simd->min (s->data, s->length);
+  while (pos > 0 && s->data[pos] != tmp) {
+    pos--;
+  }
+#elif !defined(HAVE_ACCELERATE)
   uint_t j, pos = 0.;
   smpl_t tmp = s->data[0];
   for (j = 0; j < s->length; j++) {
@@ -270,6 +319,24 @@ fvec_shift (fvec_t * s)
   }
 }
 
+void
+fvec_weighted_shift (const fvec_t * in, uint_t pos, const fvec_t * weight,
+    fvec_t * out)
+{
+  uint_t length = in->length, j = 0;
+  // out[j] is element w of the window, w = (j + length - length / 2) % length,
+  // the same index fvec_shift would move there, odd middle element included
+  uint_t w = length - length / 2, i = (pos + w) % length;
+  // copy contiguous runs up to the next wrap of either the input or the window
+  while (j < length) {
+    uint_t n = MIN (length - j, MIN (length - i, length - w));
+    aubio_simd->weighted_copy (in->data + i, weight->data + w, out->data + j, n);
+    j += n;
+    i = (i + n) % length;
+    w = (w + n) % length;
+  }
+}
+
 void
 fvec_ishift (fvec_t * s)
 {
@@ -294,7 +361,9 @@ smpl_t
 aubio_level_lin (const fvec_t * f)
 {
   smpl_t energy = 0.;
-#ifndef HAVE_ATLAS
+#if defined(HAVE_SIMD)
+  energy = aubio_simd->sum_sq (f->data, f->length);
+#elif !defined(HAVE_ATLAS)
   uint_t j;
   for (j = 0; j < f->length; j++) {
     energy += SQR (f->data[j]);
@@ -347,10 +416,14 @@ fvec_alpha_normalise (fvec_t * o, smpl_t alpha)
 void
 fvec_add (fvec_t * o, smpl_t val)
 {
+#if defined(HAVE_SIMD)
+  aubio_simd->add (o->data, val, o->length);
+#else
   uint_t j;
   for (j = 0; j < o->length; j++) {
     o->data[j] += val;
   }
+#endif
 }
 
 void fvec_adapt_thres(fvec_t * vec, fvec_t * tmp,
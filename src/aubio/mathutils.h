@@ -117,6 +117,22 @@ of the resulting spectrum. See Amalia de Götzen's paper referred to above.
 */
 void fvec_ishift (fvec_t * v);
 
+/** apply a window to a circular vector and shift it, in one pass
+
+  Same as copying `in` rotated to start at `pos`, then calling fvec_weight()
+  and fvec_shift() on the copy, without moving any element of `in`. This lets
+  a phase vocoder keep its input in a circular buffer and window it straight
+  into the fft input.
+
+  \param in input vector, read circularly starting at `pos`
+  \param pos position of the oldest element of `in`, less than its length
+  \param weight window, as long as `in`
+  \param out output vector, as long as `in`
+
+*/
+void fvec_weighted_shift (const fvec_t * in, uint_t pos, const fvec_t * weight,
+    fvec_t * out);
+
 /** compute the sum of all elements of a vector
 
   \param v vector to compute the sum of
@@ -0,0 +1,176 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "utils/median.h"
+
+/* The heap is indexed from -max_count to min_count: position 0 holds the
+ * median, positions -1, -2, ... a max-heap of the values below it (children
+ * of i are 2i and 2i-1) and positions 1, 2, ... a min-heap of the values
+ * above it (children of i are 2i and 2i+1). With max_count = (win_s-1)/2
+ * values below and min_count = win_s/2 above, the median has rank
+ * (win_s-1)/2, the lower one for even windows, as in fvec_median(). */
+struct _aubio_median_t {
+  uint_t win_s;      /**< window length */
+  uint_t idx;        /**< position of the oldest value in data */
+  sint_t min_count;  /**< number of values in the min-heap */
+  sint_t max_count;  /**< number of values in the max-heap */
+  smpl_t *data;      /**< circular buffer of values */
+  sint_t *pos;       /**< heap position of each value in data */
+  sint_t *heap_mem;  /**< heap storage */
+  sint_t *heap;      /**< heap_mem + max_count, so that heap[0] is the median */
+};
+
+static uint_t
+aubio_median_less (const aubio_median_t * m, sint_t i, sint_t j)
+{
+  return m->data[m->heap[i]] < m->data[m->heap[j]];
+}
+
+/* swap heap positions i and j if the value at i is less than the one at j */
+static uint_t
+aubio_median_swap_if_less (aubio_median_t * m, sint_t i, sint_t j)
+{
+  sint_t tmp;
+  if (!aubio_median_less (m, i, j)) return 0;
+  tmp = m->heap[i];
+  m->heap[i] = m->heap[j];
+  m->heap[j] = tmp;
+  m->pos[m->heap[i]] = i;
+  m->pos[m->heap[j]] = j;
+  return 1;
+}
+
+/* move the value at i, a child position of the min-heap, down to its place */
+static void
+aubio_median_min_sort_down (aubio_median_t * m, sint_t i)
+{
+  for (; i <= m->min_count; i *= 2) {
+    if (i > 1 && i < m->min_count && aubio_median_less (m, i + 1, i)) ++i;
+    if (!aubio_median_swap_if_less (m, i, i / 2)) break;
+  }
+}
+
+/* move the value at i, a child position of the max-heap, down to its place */
+static void
+aubio_median_max_sort_down (aubio_median_t * m, sint_t i)
+{
+  for (; i >= -m->max_count; i *= 2) {
+    if (i < -1 && i > -m->max_count && aubio_median_less (m, i, i - 1)) --i;
+    if (!aubio_median_swap_if_less (m, i / 2, i)) break;
+  }
+}
+
+/* move the value at i up the min-heap, returns 1 if it became the median */
+static uint_t
+aubio_median_min_sort_up (aubio_median_t * m, sint_t i)
+{
+  while (i > 0 && aubio_median_swap_if_less (m, i, i / 2)) i /= 2;
+  return i == 0;
+}
+
+/* move the value at i up the max-heap, returns 1 if it became the median */
+static uint_t
+aubio_median_max_sort_up (aubio_median_t * m, sint_t i)
+{
+  while (i < 0 && aubio_median_swap_if_less (m, i / 2, i)) i /= 2;
+  return i == 0;
+}
+
+aubio_median_t *
+new_aubio_median (uint_t win_s)
+{
+  aubio_median_t *m = AUBIO_NEW (aubio_median_t);
+  if ((sint_t)win_s < 1) {
+    AUBIO_ERR ("median: got window size %d, but can not be < 1\n", win_s);
+    goto beach;
+  }
+  m->win_s = win_s;
+  m->max_count = (win_s - 1) / 2;
+  m->min_count = win_s / 2;
+  m->data = AUBIO_ARRAY (smpl_t, win_s);
+  m->pos = AUBIO_ARRAY (sint_t, win_s);
+  m->heap_mem = AUBIO_ARRAY (sint_t, win_s);
+  m->heap = m->heap_mem + m->max_count;
+  aubio_median_reset (m);
+  return m;
+
+beach:
+  AUBIO_FREE (m);
+  return NULL;
+}
+
+void
+del_aubio_median (aubio_median_t * m)
+{
+  AUBIO_FREE (m->heap_mem);
+  AUBIO_FREE (m->pos);
+  AUBIO_FREE (m->data);
+  AUBIO_FREE (m);
+}
+
+void
+aubio_median_reset (aubio_median_t * m)
+{
+  uint_t i;
+  /* all values are equal, any layout is a valid heap: alternate the values
+   * between the two sides, 0, 1, -1, 2, -2, ... */
+  for (i = 0; i < m->win_s; i++) {
+    sint_t p = (sint_t)(i + 1) / 2;
+    m->data[i] = 0.;
+    m->pos[i] = (i & 1) ? p : -p;
+    m->heap[m->pos[i]] = i;
+  }
+  m->idx = 0;
+}
+
+void
+aubio_median_push (aubio_median_t * m, smpl_t input)
+{
+  sint_t p = m->pos[m->idx];
+  smpl_t old = m->data[m->idx];
+  m->data[m->idx] = input;
+  m->idx = (m->idx + 1) % m->win_s;
+  if (p > 0) {
+    if (old < input) aubio_median_min_sort_down (m, p * 2);
+    else if (aubio_median_min_sort_up (m, p)) aubio_median_max_sort_down (m, -1);
+  } else if (p < 0) {
+    if (input < old) aubio_median_max_sort_down (m, p * 2);
+    else if (aubio_median_max_sort_up (m, p)) aubio_median_min_sort_down (m, 1);
+  } else {
+    if (m->max_count) aubio_median_max_sort_down (m, -1);
+    if (m->min_count) aubio_median_min_sort_down (m, 1);
+  }
+}
+
+smpl_t
+aubio_median_get (const aubio_median_t * m)
+{
+  return m->data[m->heap[0]];
+}
+
+void
+aubio_median_get_window (const aubio_median_t * m, fvec_t * out)
+{
+  uint_t tail = m->win_s - m->idx;
+  memcpy (out->data, m->data + m->idx, tail * sizeof (smpl_t));
+  memcpy (out->data + tail, m->data, m->idx * sizeof (smpl_t));
+}
@@ -0,0 +1,393 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "spectral/mixfft.h"
+
+#define AUBIO_MIXFFT_MAX_STAGES 32
+
+/** one Stockham pass: `radix`-point butterflies over a length `radix * m` */
+typedef struct {
+  uint_t radix;       /**< butterfly size */
+  uint_t m;           /**< butterflies per sub-transform */
+  uint_t s;           /**< number of interleaved sub-transforms (stride) */
+  smpl_t *twr;        /**< twiddles W^(p * u), at [(u - 1) * m + p], real */
+  smpl_t *twi;        /**< twiddles W^(p * u), imaginary */
+  smpl_t *rr;         /**< radix roots W_radix^k, generic butterfly only */
+  smpl_t *ri;         /**< radix roots, imaginary */
+} aubio_mixfft_stage_t;
+
+struct _aubio_mixfft_t {
+  uint_t size;        /**< real transform length */
+  uint_t n;           /**< complex transform length, size / 2 if size is even */
+  uint_t n_stages;    /**< number of passes */
+  aubio_mixfft_stage_t stages[AUBIO_MIXFFT_MAX_STAGES];
+  smpl_t *ar, *ai;    /**< ping buffer */
+  smpl_t *br, *bi;    /**< pong buffer */
+  smpl_t *wr, *wi;    /**< W_size^k, to split the half length transform */
+  smpl_t *gr, *gi;    /**< scratch for the generic butterfly */
+};
+
+static void
+aubio_mixfft_pass2 (const aubio_mixfft_stage_t * st,
+    const smpl_t * restrict xr, const smpl_t * restrict xi,
+    smpl_t * restrict yr, smpl_t * restrict yi)
+{
+  uint_t p, q, m = st->m, s = st->s;
+  for (p = 0; p < m; p++) {
+    const smpl_t w1r = st->twr[p], w1i = st->twi[p];
+    const smpl_t *x0r = xr + s * p, *x0i = xi + s * p;
+    const smpl_t *x1r = x0r + s * m, *x1i = x0i + s * m;
+    smpl_t *y0r = yr + s * 2 * p, *y0i = yi + s * 2 * p;
+    smpl_t *y1r = y0r + s, *y1i = y0i + s;
+    for (q = 0; q < s; q++) {
+      smpl_t dr = x0r[q] - x1r[q], di = x0i[q] - x1i[q];
+      y0r[q] = x0r[q] + x1r[q];
+      y0i[q] = x0i[q] + x1i[q];
+      y1r[q] = dr * w1r - di * w1i;
+      y1i[q] = dr * w1i + di * w1r;
+    }
+  }
+}
+
+static void
+aubio_mixfft_pass3 (const aubio_mixfft_stage_t * st,
+    const smpl_t * restrict xr, const smpl_t * restrict xi,
+    smpl_t * restrict yr, smpl_t * restrict yi)
+{
+  const smpl_t h = 0.86602540378443864676; /* sqrt(3) / 2 */
+  uint_t p, q, m = st->m, s = st->s;
+  for (p = 0; p < m; p++) {
+    const smpl_t w1r = st->twr[p], w1i = st->twi[p];
+    const smpl_t w2r = st->twr[m + p], w2i = st->twi[m + p];
+    const smpl_t *x0r = xr + s * p, *x0i = xi + s * p;
+    const smpl_t *x1r = x0r + s * m, *x1i = x0i + s * m;
+    const smpl_t *x2r = x1r + s * m, *x2i = x1i + s * m;
+    smpl_t *y0r = yr + s * 3 * p, *y0i = yi + s * 3 * p;
+    smpl_t *y1r = y0r + s, *y1i = y0i + s;
+    smpl_t *y2r = y1r + s, *y2i = y1i + s;
+    for (q = 0; q < s; q++) {
+      smpl_t tr = x1r[q] + x2r[q], ti = x1i[q] + x2i[q];
+      smpl_t ur = x0r[q] - .5 * tr, ui = x0i[q] - .5 * ti;
+      /* -i * sqrt(3) / 2 * (x1 - x2) */
+      smpl_t vr = h * (x1i[q] - x2i[q]), vi = - h * (x1r[q] - x2r[q]);
+      smpl_t b1r = ur + vr, b1i = ui + vi;
+      smpl_t b2r = ur - vr, b2i = ui - vi;
+      y0r[q] = x0r[q] + tr;
+      y0i[q] = x0i[q] + ti;
+      y1r[q] = b1r * w1r - b1i * w1i;
+      y1i[q] = b1r * w1i + b1i * w1r;
+      y2r[q] = b2r * w2r - b2i * w2i;
+      y2i[q] = b2r * w2i + b2i * w2r;
+    }
+  }
+}
+
+static void
+aubio_mixfft_pass4 (const aubio_mixfft_stage_t * st,
+    const smpl_t * restrict xr, const smpl_t * restrict xi,
+    smpl_t * restrict yr, smpl_t * restrict yi)
+{
+  uint_t p, q, m = st->m, s = st->s;
+  if (s == 1) {
+    /* first pass: loop over the butterflies, reading contiguous inputs */
+    const smpl_t *twr = st->twr, *twi = st->twi;
+    for (p = 0; p < m; p++) {
+      smpl_t t0r = xr[p] + xr[p + 2 * m], t0i = xi[p] + xi[p + 2 * m];
+      smpl_t t1r = xr[p] - xr[p + 2 * m], t1i = xi[p] - xi[p + 2 * m];
+      smpl_t t2r = xr[p + m] + xr[p + 3 * m], t2i = xi[p + m] + xi[p + 3 * m];
+      smpl_t t3r = xr[p + m] - xr[p + 3 * m], t3i = xi[p + m] - xi[p + 3 * m];
+      smpl_t b1r = t1r + t3i, b1i = t1i - t3r;
+      smpl_t b2r = t0r - t2r, b2i = t0i - t2i;
+      smpl_t b3r = t1r - t3i, b3i = t1i + t3r;
+      yr[4 * p] = t0r + t2r;
+      yi[4 * p] = t0i + t2i;
+      yr[4 * p + 1] = b1r * twr[p] - b1i * twi[p];
+      yi[4 * p + 1] = b1r * twi[p] + b1i * twr[p];
+      yr[4 * p + 2] = b2r * twr[m + p] - b2i * twi[m + p];
+      yi[4 * p + 2] = b2r * twi[m + p] + b2i * twr[m + p];
+      yr[4 * p + 3] = b3r * twr[2 * m + p] - b3i * twi[2 * m + p];
+      yi[4 * p + 3] = b3r * twi[2 * m + p] + b3i * twr[2 * m + p];
+    }
+    return;
+  }
+  for (p = 0; p < m; p++) {
+    const smpl_t w1r = st->twr[p], w1i = st->twi[p];
+    const smpl_t w2r = st->twr[m + p], w2i = st->twi[m + p];
+    const smpl_t w3r = st->twr[2 * m + p], w3i = st->twi[2 * m + p];
+    const smpl_t *x0r = xr + s * p, *x0i = xi + s * p;
+    const smpl_t *x1r = x0r + s * m, *x1i = x0i + s * m;
+    const smpl_t *x2r = x1r + s * m, *x2i = x1i + s * m;
+    const smpl_t *x3r = x2r + s * m, *x3i = x2i + s * m;
+    smpl_t *y0r = yr + s * 4 * p, *y0i = yi + s * 4 * p;
+    smpl_t *y1r = y0r + s, *y1i = y0i + s;
+    smpl_t *y2r = y1r + s, *y2i = y1i + s;
+    smpl_t *y3r = y2r + s, *y3i = y2i + s;
+    for (q = 0; q < s; q++) {
+      smpl_t t0r = x0r[q] + x2r[q], t0i = x0i[q] + x2i[q];
+      smpl_t t1r = x0r[q] - x2r[q], t1i = x0i[q] - x2i[q];
+      smpl_t t2r = x1r[q] + x3r[q], t2i = x1i[q] + x3i[q];
+      smpl_t t3r = x1r[q] - x3r[q], t3i = x1i[q] - x3i[q];
+      /* b1 = t1 - i t3, b3 = t1 + i t3 */
+      smpl_t b1r = t1r + t3i, b1i = t1i - t3r;
+      smpl_t b2r = t0r - t2r, b2i = t0i - t2i;
+      smpl_t b3r = t1r - t3i, b3i = t1i + t3r;
+      y0r[q] = t0r + t2r;
+      y0i[q] = t0i + t2i;
+      y1r[q] = b1r * w1r - b1i * w1i;
+      y1i[q] = b1r * w1i + b1i * w1r;
+      y2r[q] = b2r * w2r - b2i * w2i;
+      y2i[q] = b2r * w2i + b2i * w2r;
+      y3r[q] = b3r * w3r - b3i * w3i;
+      y3i[q] = b3r * w3i + b3i * w3r;
+    }
+  }
+}
+
+/* any radix, in O(radix^2) per butterfly */
+static void
+aubio_mixfft_passg (const aubio_mixfft_stage_t * st,
+    const smpl_t * xr, const smpl_t * xi, smpl_t * yr, smpl_t * yi,
+    smpl_t * gr, smpl_t * gi)
+{
+  uint_t p, q, t, u, m = st->m, s = st->s, r = st->radix;
+  for (p = 0; p < m; p++) {
+    for (q = 0; q < s; q++) {
+      for (t = 0; t < r; t++) {
+        gr[t] = xr[q + s * (p + t * m)];
+        gi[t] = xi[q + s * (p + t * m)];
+      }
+      for (u = 0; u < r; u++) {
+        smpl_t br = 0., bi = 0.;
+        uint_t k = 0;
+        for (t = 0; t < r; t++) {
+          br += gr[t] * st->rr[k] - gi[t] * st->ri[k];
+          bi += gr[t] * st->ri[k] + gi[t] * st->rr[k];
+          k += u;
+          if (k >= r) k -= r;
+        }
+        if (u > 0) {
+          smpl_t wr = st->twr[(u - 1) * m + p], wi = st->twi[(u - 1) * m + p];
+          yr[q + s * (r * p + u)] = br * wr - bi * wi;
+          yi[q + s * (r * p + u)] = br * wi + bi * wr;
+        } else {
+          yr[q + s * r * p] = br;
+          yi[q + s * r * p] = bi;
+        }
+      }
+    }
+  }
+}
+
+/* forward complex transform of (xr, xi), using (yr, yi) as work space; the
+ * result is left in one of the two pairs, returned in (outr, outi) */
+static void
+aubio_mixfft_cfft (aubio_mixfft_t * f, smpl_t * xr, smpl_t * xi,
+    smpl_t * yr, smpl_t * yi, smpl_t ** outr, smpl_t ** outi)
+{
+  uint_t i;
+  smpl_t *tr, *ti;
+  for (i = 0; i < f->n_stages; i++) {
+    const aubio_mixfft_stage_t *st = &f->stages[i];
+    switch (st->radix) {
+      case 4:
+        aubio_mixfft_pass4 (st, xr, xi, yr, yi);
+        break;
+      case 2:
+        aubio_mixfft_pass2 (st, xr, xi, yr, yi);
+        break;
+      case 3:
+        aubio_mixfft_pass3 (st, xr, xi, yr, yi);
+        break;
+      default:
+        aubio_mixfft_passg (st, xr, xi, yr, yi, f->gr, f->gi);
+        break;
+    }
+    tr = xr; xr = yr; yr = tr;
+    ti = xi; xi = yi; yi = ti;
+  }
+  *outr = xr;
+  *outi = xi;
+}
+
+aubio_mixfft_t *
+new_aubio_mixfft (uint_t size)
+{
+  aubio_mixfft_t *f = AUBIO_NEW (aubio_mixfft_t);
+  uint_t n, rest, radix, len, s = 1, max_radix = 4, i, p, u;
+  if ((sint_t)size < 2) {
+    AUBIO_ERR ("mixfft: got size %d, but can not be < 2\n", size);
+    goto beach;
+  }
+  f->size = size;
+  f->n = n = (size % 2 == 0) ? size / 2 : size;
+  /* factor n, radix 4 first, then 2, 3, and remaining primes */
+  rest = n;
+  len = n;
+  while (rest > 1) {
+    if (rest % 4 == 0) radix = 4;
+    else if (rest % 2 == 0) radix = 2;
+    else if (rest % 3 == 0) radix = 3;
+    else {
+      radix = 5;
+      while (rest % radix != 0) radix += 2;
+    }
+    if (f->n_stages == AUBIO_MIXFFT_MAX_STAGES) goto beach;
+    aubio_mixfft_stage_t *st = &f->stages[f->n_stages++];
+    st->radix = radix;
+    st->m = len / radix;
+    st->s = s;
+    st->twr = AUBIO_ARRAY (smpl_t, (radix - 1) * st->m);
+    st->twi = AUBIO_ARRAY (smpl_t, (radix - 1) * st->m);
+    for (u = 1; u < radix; u++) {
+      for (p = 0; p < st->m; p++) {
+        double phi = 2. * M_PI * (double)(p * u) / (double)len;
+        st->twr[(u - 1) * st->m + p] = cos (phi);
+        st->twi[(u - 1) * st->m + p] = - sin (phi);
+      }
+    }
+    if (radix > 4) {
+      st->rr = AUBIO_ARRAY (smpl_t, radix);
+      st->ri = AUBIO_ARRAY (smpl_t, radix);
+      for (i = 0; i < radix; i++) {
+        st->rr[i] = cos (2. * M_PI * (double)i / (double)radix);
+        st->ri[i] = - sin (2. * M_PI * (double)i / (double)radix);
+      }
+      if (radix > max_radix) max_radix = radix;
+    }
+    rest /= radix;
+    len /= radix;
+    s *= radix;
+  }
+  f->ar = AUBIO_ARRAY (smpl_t, n);
+  f->ai = AUBIO_ARRAY (smpl_t, n);
+  f->br = AUBIO_ARRAY (smpl_t, n);
+  f->bi = AUBIO_ARRAY (smpl_t, n);
+  f->gr = AUBIO_ARRAY (smpl_t, max_radix);
+  f->gi = AUBIO_ARRAY (smpl_t, max_radix);
+  if (size % 2 == 0) {
+    f->wr = AUBIO_ARRAY (smpl_t, n);
+    f->wi = AUBIO_ARRAY (smpl_t, n);
+    for (i = 0; i < n; i++) {
+      f->wr[i] = cos (2. * M_PI * (double)i / (double)size);
+      f->wi[i] = - sin (2. * M_PI * (double)i / (double)size);
+    }
+  }
+  return f;
+
+beach:
+  del_aubio_mixfft (f);
+  return NULL;
+}
+
+void
+del_aubio_mixfft (aubio_mixfft_t * f)
+{
+  uint_t i;
+  for (i = 0; i < f->n_stages; i++) {
+    if (f->stages[i].twr) AUBIO_FREE (f->stages[i].twr);
+    if (f->stages[i].twi) AUBIO_FREE (f->stages[i].twi);
+    if (f->stages[i].rr) AUBIO_FREE (f->stages[i].rr);
+    if (f->stages[i].ri) AUBIO_FREE (f->stages[i].ri);
+  }
+  if (f->ar) AUBIO_FREE (f->ar);
+  if (f->ai) AUBIO_FREE (f->ai);
+  if (f->br) AUBIO_FREE (f->br);
+  if (f->bi) AUBIO_FREE (f->bi);
+  if (f->gr) AUBIO_FREE (f->gr);
+  if (f->gi) AUBIO_FREE (f->gi);
+  if (f->wr) AUBIO_FREE (f->wr);
+  if (f->wi) AUBIO_FREE (f->wi);
+  AUBIO_FREE (f);
+}
+
+void
+aubio_mixfft_do (aubio_mixfft_t * f, const smpl_t * in, smpl_t * compspec)
+{
+  uint_t k, n = f->n, size = f->size;
+  smpl_t *zr, *zi;
+  if (size % 2 == 0) {
+    /* pack even and odd samples as one complex signal of half the length */
+    for (k = 0; k < n; k++) {
+      f->ar[k] = in[2 * k];
+      f->ai[k] = in[2 * k + 1];
+    }
+    aubio_mixfft_cfft (f, f->ar, f->ai, f->br, f->bi, &zr, &zi);
+    /* X[k] = E[k] + W^k O[k], with E and O the spectra of the even and odd
+     * samples, E[k] = (Z[k] + Z*[n - k]) / 2, O[k] = -i (Z[k] - Z*[n - k]) / 2 */
+    compspec[0] = zr[0] + zi[0];
+    compspec[n] = zr[0] - zi[0];
+    for (k = 1; k < n; k++) {
+      smpl_t er = .5 * (zr[k] + zr[n - k]), ei = .5 * (zi[k] - zi[n - k]);
+      smpl_t or = .5 * (zi[k] + zi[n - k]), oi = - .5 * (zr[k] - zr[n - k]);
+      compspec[k] = er + f->wr[k] * or - f->wi[k] * oi;
+      compspec[size - k] = ei + f->wr[k] * oi + f->wi[k] * or;
+    }
+  } else {
+    for (k = 0; k < n; k++) {
+      f->ar[k] = in[k];
+      f->ai[k] = 0.;
+    }
+    aubio_mixfft_cfft (f, f->ar, f->ai, f->br, f->bi, &zr, &zi);
+    compspec[0] = zr[0];
+    for (k = 1; k <= n / 2; k++) {
+      compspec[k] = zr[k];
+      compspec[size - k] = zi[k];
+    }
+  }
+}
+
+void
+aubio_mixfft_rdo (aubio_mixfft_t * f, const smpl_t * compspec, smpl_t * out)
+{
+  uint_t k, n = f->n, size = f->size;
+  smpl_t scale = 1. / (smpl_t)size;
+  smpl_t *zr, *zi;
+  if (size % 2 == 0) {
+    /* rebuild 2 Z[k] = 2 E[k] + 2 i O[k] from X[k] and X[k + n] = X*[n - k] */
+    for (k = 0; k < n; k++) {
+      smpl_t xr = compspec[k], xi = k > 0 ? compspec[size - k] : 0.;
+      smpl_t yr = compspec[n - k], yi = k > 0 ? - compspec[n + k] : 0.;
+      smpl_t dr = xr - yr, di = xi - yi;
+      smpl_t or = dr * f->wr[k] + di * f->wi[k];
+      smpl_t oi = di * f->wr[k] - dr * f->wi[k];
+      f->ar[k] = xr + yr - oi;
+      f->ai[k] = xi + yi + or;
+    }
+    /* inverse transform, swapping real and imaginary parts */
+    aubio_mixfft_cfft (f, f->ai, f->ar, f->bi, f->br, &zi, &zr);
+    for (k = 0; k < n; k++) {
+      out[2 * k] = zr[k] * scale;
+      out[2 * k + 1] = zi[k] * scale;
+    }
+  } else {
+    f->ar[0] = compspec[0];
+    f->ai[0] = 0.;
+    for (k = 1; k <= n / 2; k++) {
+      f->ar[k] = f->ar[n - k] = compspec[k];
+      f->ai[k] = compspec[size - k];
+      f->ai[n - k] = - compspec[size - k];
+    }
+    aubio_mixfft_cfft (f, f->ai, f->ar, f->bi, f->br, &zi, &zr);
+    for (k = 0; k < n; k++) {
+      out[k] = zr[k] * scale;
+    }
+  }
+}
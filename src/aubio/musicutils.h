@@ -37,6 +37,24 @@ extern "C" {
 */
 fvec_t *new_aubio_window (char_t * window_type, uint_t size);
 
+/** get a shared, read-only window
+
+  \param window_type type of the window (see fvec_set_window())
+  \param size length of the window
+
+  \return the window, the same one for every caller asking for this type and
+  size, to be released with aubio_window_release(), or NULL on error
+
+*/
+const fvec_t *aubio_window_acquire (const char_t * window_type, uint_t size);
+
+/** release a window
+
+  \param window window as returned by aubio_window_acquire()
+
+*/
+void aubio_window_release (const fvec_t * window);
+
 /** set elements of a vector to window coefficients
 
   \param window exsting ::fvec_t to use
@@ -23,6 +23,7 @@
 #include "cvec.h"
 #include "spectral/specdesc.h"
 #include "spectral/phasevoc.h"
+#include "spectral/frontend.h"
 #include "onset/peakpicker.h"
 #include "mathutils.h"
 #include "onset/onset.h"
@@ -33,27 +34,27 @@ struct _aubio_onset_t {
   aubio_specdesc_t * od;        /**< spectral descriptor */
   aubio_peakpicker_t * pp;      /**< peak picker */
   cvec_t * fftgrain;            /**< phase vocoder output */
+  fvec_t * frame;               /**< last buf_size samples, replacing the phase vocoder for time-domain descriptors */
   fvec_t * desc;                /**< spectral description */
   smpl_t silence;               /**< silence threhsold */
   uint_t minioi;                /**< minimum inter onset interval */
   uint_t delay;                 /**< constant delay, in samples, removed from detected onset times */
   uint_t samplerate;            /**< sampling rate of the input signal */
   uint_t hop_size;              /**< number of samples between two runs */
+  uint_t buf_size;              /**< analysis window size */
+  uint_t frontend_only;         /**< neither frame nor phase vocoder, see new_aubio_onset_frontend() */
 
   uint_t total_frames;          /**< total number of frames processed since the beginning */
   uint_t last_onset;            /**< last detected onset location, in frames */
 };
 
-/* execute onset detection function on iput buffer */
-void aubio_onset_do (aubio_onset_t *o, const fvec_t * input, fvec_t * onset)
+/* mark an onset at the peak picked in the description of the current frame,
+ * unless the hop is silent or too close to the last onset */
+static void aubio_onset_mark (aubio_onset_t *o, uint_t silent, fvec_t * onset)
 {
-  smpl_t isonset = 0;
-  aubio_pvoc_do (o->pv,input, o->fftgrain);
-  aubio_specdesc_do (o->od, o->fftgrain, o->desc);
-  aubio_peakpicker_do(o->pp, o->desc, onset);
-  isonset = onset->data[0];
+  smpl_t isonset = onset->data[0];
   if (isonset > 0.) {
-    if (aubio_silence_detection(input, o->silence)==1) {
+    if (silent) {
       //AUBIO_DBG ("silent onset, not marking as onset\n");
       isonset  = 0;
     } else {
@@ -70,7 +71,7 @@ void aubio_onset_do (aubio_onset_t *o, const fvec_t * input, fvec_t * onset)
     // we are at the beginning of the file
     if (o->total_frames <= o->delay) {
       // and we don't find silence
-      if (aubio_silence_detection(input, o->silence) == 0) {
+      if (!silent) {
         uint_t new_onset = o->total_frames;
         if (o->total_frames == 0 || o->last_onset + o->minioi < new_onset) {
           isonset = o->delay / o->hop_size;
@@ -84,6 +85,59 @@ void aubio_onset_do (aubio_onset_t *o, const fvec_t * input, fvec_t * onset)
   return;
 }
 
+/* execute onset detection function on iput buffer */
+void aubio_onset_do (aubio_onset_t *o, const fvec_t * input, fvec_t * onset)
+{
+  if (o->frontend_only) {
+    onset->data[0] = 0.;
+    return;
+  }
+  if (o->frame) {
+    uint_t keep = o->buf_size - o->hop_size;
+    memmove (o->frame->data, o->frame->data + o->hop_size,
+        keep * sizeof (smpl_t));
+    memcpy (o->frame->data + keep, input->data, o->hop_size * sizeof (smpl_t));
+    aubio_specdesc_do_frame (o->od, o->frame, o->desc);
+  } else {
+    aubio_pvoc_do (o->pv,input, o->fftgrain);
+    aubio_specdesc_do (o->od, o->fftgrain, o->desc);
+  }
+  aubio_peakpicker_do(o->pp, o->desc, onset);
+  aubio_onset_mark (o, aubio_silence_detection(input, o->silence), onset);
+}
+
+void aubio_onset_do_frontend (aubio_onset_t *o, aubio_frontend_t * f,
+    fvec_t * onset)
+{
+  fvec_t hop, frame;
+  const cvec_t *fftgrain;
+  uint_t time_domain = aubio_specdesc_is_time_domain (o->od);
+  if (time_domain ? aubio_frontend_get_frame (f, o->buf_size, &frame)
+      != AUBIO_OK : !aubio_frontend_has_spectrum (f, o->buf_size)) {
+    aubio_frontend_get_hop (f, &hop);
+    aubio_onset_do (o, &hop, onset);
+    return;
+  }
+  if (aubio_frontend_get_db_spl (f) < o->silence) {
+    /* no onset can be marked on a silent hop: skip the spectrum, and let
+     * the detector see silence so that the next loud frame stands out */
+    aubio_specdesc_reset (o->od);
+    fvec_zeros (o->desc);
+  } else if (time_domain) {
+    aubio_specdesc_do_frame (o->od, &frame, o->desc);
+  } else if (aubio_specdesc_takes_compspec (o->od)) {
+    /* complex and phase, without trigonometric functions */
+    aubio_specdesc_do_compspec (o->od,
+        aubio_frontend_get_compspec (f, o->buf_size), o->desc);
+  } else {
+    fftgrain = aubio_frontend_get_spectrum (f, o->buf_size,
+        aubio_specdesc_needs_phase (o->od));
+    aubio_specdesc_do (o->od, fftgrain, o->desc);
+  }
+  aubio_peakpicker_do(o->pp, o->desc, onset);
+  aubio_onset_mark (o, aubio_frontend_get_db_spl (f) < o->silence, onset);
+}
+
 uint_t aubio_onset_get_last (const aubio_onset_t *o)
 {
   return o->last_onset - o->delay;
@@ -177,8 +231,8 @@ smpl_t aubio_onset_get_thresholded_descriptor(const aubio_onset_t * o) {
 }
 
 /* Allocate memory for an onset detection */
-aubio_onset_t * new_aubio_onset (const char_t * onset_mode,
-    uint_t buf_size, uint_t hop_size, uint_t samplerate)
+static aubio_onset_t * new_aubio_onset_with (const char_t * onset_mode,
+    uint_t buf_size, uint_t hop_size, uint_t samplerate, uint_t frontend_only)
 {
   aubio_onset_t * o = AUBIO_NEW(aubio_onset_t);
 
@@ -200,12 +254,22 @@ aubio_onset_t * new_aubio_onset (const char_t * onset_mode,
   /* store creation parameters */
   o->samplerate = samplerate;
   o->hop_size = hop_size;
+  o->buf_size = buf_size;
+  o->frontend_only = frontend_only;
 
   /* allocate memory */
-  o->pv = new_aubio_pvoc(buf_size, o->hop_size);
   o->pp = new_aubio_peakpicker();
   o->od = new_aubio_specdesc(onset_mode,buf_size);
-  o->fftgrain = new_cvec(buf_size);
+  if (frontend_only) {
+    /* frame and spectrum are read from the front-end */
+  } else if (aubio_specdesc_is_time_domain(o->od)) {
+    /* no FFT at all */
+    o->frame = new_fvec(buf_size);
+  } else {
+    o->pv = new_aubio_pvoc(buf_size, o->hop_size);
+    aubio_pvoc_set_phase(o->pv, aubio_specdesc_needs_phase(o->od));
+    o->fftgrain = new_cvec(buf_size);
+  }
   o->desc = new_fvec(1);
 
   /* set some default parameter */
@@ -224,12 +288,25 @@ beach:
   return NULL;
 }
 
+aubio_onset_t * new_aubio_onset (const char_t * onset_mode,
+    uint_t buf_size, uint_t hop_size, uint_t samplerate)
+{
+  return new_aubio_onset_with (onset_mode, buf_size, hop_size, samplerate, 0);
+}
+
+aubio_onset_t * new_aubio_onset_frontend (const char_t * onset_mode,
+    uint_t buf_size, uint_t hop_size, uint_t samplerate)
+{
+  return new_aubio_onset_with (onset_mode, buf_size, hop_size, samplerate, 1);
+}
+
 void del_aubio_onset (aubio_onset_t *o)
 {
   del_aubio_specdesc(o->od);
   del_aubio_peakpicker(o->pp);
-  del_aubio_pvoc(o->pv);
+  if (o->pv) del_aubio_pvoc(o->pv);
+  if (o->frame) del_fvec(o->frame);
   del_fvec(o->desc);
-  del_cvec(o->fftgrain);
+  if (o->fftgrain) del_cvec(o->fftgrain);
   AUBIO_FREE(o);
 }
@@ -62,6 +62,24 @@ typedef struct _aubio_onset_t aubio_onset_t;
 aubio_onset_t * new_aubio_onset (const char_t * method,
     uint_t buf_size, uint_t hop_size, uint_t samplerate);
 
+/** create onset detection object run on a front-end only
+
+  \param method onset detection type as specified in specdesc.h
+  \param buf_size size of the frames read from the front-end
+  \param hop_size hop size of the front-end
+  \param samplerate sampling rate of the input signal
+
+  Same as new_aubio_onset(), without the phase vocoder, or the frame of the
+  time-domain methods. Use it with aubio_onset_do_frontend() on a front-end
+  that holds frames of `buf_size` and their spectrum; aubio_onset_do(), or
+  a front-end without them, finds no onset.
+
+  \return newly created ::aubio_onset_t
+
+*/
+aubio_onset_t * new_aubio_onset_frontend (const char_t * method,
+    uint_t buf_size, uint_t hop_size, uint_t samplerate);
+
 /** execute onset detection
 
   \param o onset detection object as returned by new_aubio_onset()
@@ -90,6 +108,27 @@ aubio_onset_t * new_aubio_onset (const char_t * method,
 */
 void aubio_onset_do (aubio_onset_t *o, const fvec_t * input, fvec_t * onset);
 
+/** execute onset detection on the latest frame of a front-end
+
+  \param o onset detection object as returned by new_aubio_onset()
+  \param f front-end, already fed with the current hop by aubio_frontend_do()
+  \param onset output vector of length 1, as in aubio_onset_do()
+
+  The spectrum is read from `f` when a spectrum of `buf_size` was prepared
+  with aubio_frontend_add_spectrum(); otherwise the latest hop of `f` is
+  passed to aubio_onset_do(). The time-domain methods, `energy` and `tdhfc`,
+  only read the frame from `f` and never ask it for a spectrum; `complex`
+  and `phase` read its packed spectrum, see aubio_specdesc_do_compspec().
+  Not to be mixed with aubio_onset_do() on the same object, see frontend.h.
+
+  On hops quieter than the silence threshold, see aubio_onset_set_silence(),
+  the spectrum is not computed: the descriptor is reset with
+  aubio_specdesc_reset() and the peak picker is fed a zero.
+
+*/
+void aubio_onset_do_frontend (aubio_onset_t *o, aubio_frontend_t * f,
+    fvec_t * onset);
+
 /** get the time of the latest onset detected, in samples
 
   \param o onset detection object as returned by new_aubio_onset()
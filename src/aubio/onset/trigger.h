@@ -0,0 +1,143 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Low latency onset detection, for drum triggering
+
+  ::aubio_onset_t looks at the signal once per hop, and its peak picker
+  waits for the next frames before it confirms a peak: an onset is known a
+  few milliseconds after it happened at best. This detector follows a small
+  set of bins of a short window instead, updated with every sample by a
+  sliding DFT (see ::aubio_slidingdft_t), and reads them every `block_s`
+  samples.
+
+  The onset detection function is a spectral flux: the rise of the log
+  magnitude of each bin above its peak envelope, which holds the peaks of
+  the bin and then falls at 400 dB/s, averaged over the bins. It is compared
+  to the median of its recent values, without waiting for the next ones:
+  an onset is marked on the first block that rises more than the threshold
+  above that median, unless the window is below the silence threshold or
+  the last onset is closer than the minimum inter-onset interval. The onset
+  is then reported at most `block_s` samples after it.
+
+*/
+
+#ifndef AUBIO_TRIGGER_H
+#define AUBIO_TRIGGER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** drum trigger object */
+typedef struct _aubio_trigger_t aubio_trigger_t;
+
+/** create a drum trigger
+
+  \param win_s window size of the sliding DFT, 128 at 44.1 kHz
+  \param block_s number of samples between two reads of the bins, 16 at
+  44.1 kHz
+  \param samplerate sampling rate of the input signal
+
+*/
+aubio_trigger_t *new_aubio_trigger (uint_t win_s, uint_t block_s,
+    uint_t samplerate);
+
+/** delete a drum trigger
+
+  \param o trigger as returned by new_aubio_trigger()
+
+*/
+void del_aubio_trigger (aubio_trigger_t * o);
+
+/** execute onset detection on new samples
+
+  \param o trigger as returned by new_aubio_trigger()
+  \param input new samples, of any length up to the minimum inter-onset
+  interval
+  \param onset output vector of length 1, set to 0 if no onset was found in
+  `input`, to 1 plus the position of the sample it was found at otherwise
+
+  The blocks go on from one call to the next, whatever the length of
+  `input`: an onset is found at the last sample of a block, which may be
+  anywhere in `input`.
+
+*/
+void aubio_trigger_do (aubio_trigger_t * o, const fvec_t * input,
+    fvec_t * onset);
+
+/** set the peak picking threshold
+
+  \param o trigger as returned by new_aubio_trigger()
+  \param threshold rise of the flux over its recent median, in nepers
+  [default 0.3]
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_trigger_set_threshold (aubio_trigger_t * o, smpl_t threshold);
+
+/** set the silence threshold
+
+  \param o trigger as returned by new_aubio_trigger()
+  \param silence level of the window below which no onset is marked, in dB
+  [default -70]
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_trigger_set_silence (aubio_trigger_t * o, smpl_t silence);
+
+/** set the minimum inter-onset interval
+
+  \param o trigger as returned by new_aubio_trigger()
+  \param minioi minimum interval between two consecutive onsets, in
+  milliseconds [default 20]
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_trigger_set_minioi_ms (aubio_trigger_t * o, smpl_t minioi);
+
+/** get the level of the last onset
+
+  \param o trigger as returned by new_aubio_trigger()
+
+  \return level of the window when the last onset was found, in dB SPL
+
+*/
+smpl_t aubio_trigger_get_level (const aubio_trigger_t * o);
+
+/** get the delay of the onsets
+
+  \param o trigger as returned by new_aubio_trigger()
+
+  \return largest time between an onset and the sample it is reported at,
+  in samples: `block_s`
+
+*/
+uint_t aubio_trigger_get_delay (const aubio_trigger_t * o);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_TRIGGER_H */
@@ -57,8 +57,10 @@ struct _aubio_peakpicker_t
 
         /** biquad lowpass filter */
   aubio_filter_t *biquad;
-        /** original onsets */
+        /** original onsets, circular */
   fvec_t *onset_keep;
+        /** position of the oldest value in onset_keep */
+  uint_t keep_pos;
         /** modified onsets */
   fvec_t *onset_proc;
         /** peak picked window [3] */
@@ -95,14 +97,14 @@ aubio_peakpicker_do (aubio_peakpicker_t * p, fvec_t * onset, fvec_t * out)
   uint_t length = p->win_post + p->win_pre + 1;
   uint_t j = 0;
 
-  /* store onset in onset_keep */
-  /* shift all elements but last, then write last */
-  for (j = 0; j < length - 1; j++) {
-    onset_keep->data[j] = onset_keep->data[j + 1];
-    onset_proc->data[j] = onset_keep->data[j];
-  }
-  onset_keep->data[length - 1] = onset->data[0];
-  onset_proc->data[length - 1] = onset->data[0];
+  /* store onset in place of the oldest value of onset_keep, then unroll
+   * the window, oldest value first, into onset_proc */
+  onset_keep->data[p->keep_pos] = onset->data[0];
+  p->keep_pos = (p->keep_pos + 1) % length;
+  memcpy (onset_proc->data, onset_keep->data + p->keep_pos,
+      (length - p->keep_pos) * sizeof (smpl_t));
+  memcpy (onset_proc->data + length - p->keep_pos, onset_keep->data,
+      p->keep_pos * sizeof (smpl_t));
 
   /* filter onset_proc */
   /** \bug filtfilt calculated post+pre times, should be only once !? */
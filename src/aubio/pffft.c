@@ -0,0 +1,1194 @@
+/* Copyright (c) 2013  Julien Pommier ( pommier@modartt.com )
+
+   Based on original fortran 77 code from FFTPACKv4 from NETLIB
+   (http://www.netlib.org/fftpack), authored by Dr Paul Swarztrauber
+   of NCAR, in 1985.
+
+   As confirmed by the NCAR fftpack software curators, the following
+   FFTPACKv5 license applies to FFTPACKv4 sources. My changes are
+   released under the same terms.
+
+   FFTPACK license:
+
+   http://www.cisl.ucar.edu/css/software/fftpack5/ftpk.html
+
+   Copyright (c) 2004 the University Corporation for Atmospheric
+   Research ("UCAR"). All rights reserved. Developed by NCAR's
+   Computational and Information Systems Laboratory, UCAR,
+   www.cisl.ucar.edu.
+
+   Redistribution and use of the Software in source and binary forms,
+   with or without modification, is permitted provided that the
+   following conditions are met:
+
+   - Neither the names of NCAR's Computational and Information Systems
+   Laboratory, the University Corporation for Atmospheric Research,
+   nor the names of its sponsors or contributors may be used to
+   endorse or promote products derived from this Software without
+   specific prior written permission.
+
+   - Redistributions of source code must retain the above copyright
+   notices, this list of conditions, and the disclaimer below.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions, and the disclaimer below in the
+   documentation and/or other materials provided with the
+   distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   "AS IS" AND ANY EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO THE
+   WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+   NONINFRINGEMENT. IN NO EVENT SHALL THE CONTRIBUTORS OR COPYRIGHT
+   HOLDERS BE LIABLE FOR ANY CLAIM, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+   ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+   CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS WITH THE
+   SOFTWARE.
+*/
+
+// modifications made for aubio:
+//  - only the real transform is kept: no complex passes, no
+//    pffft_zconvolve_accumulate, no altivec
+//  - allocate with aubio_calloc, so that setups and buffers created inside
+//    an aubio arena are taken from it
+//  - pffft_new_setup returns NULL for unsupported sizes instead of asserting
+//  - the work area is always given by the caller, nothing is put on the stack
+//  - the radix passes index the FFTPACK arrays through CC and CH macros
+
+#include "aubio_priv.h"
+#include "spectral/pffft.h"
+
+#include <assert.h>
+
+/* detect compiler flavour */
+#if defined(_MSC_VER)
+#  define COMPILER_MSVC
+#elif defined(__GNUC__)
+#  define COMPILER_GCC
+#endif
+
+#if defined(COMPILER_GCC)
+#  define ALWAYS_INLINE(return_type) inline return_type __attribute__ ((always_inline))
+#  define NEVER_INLINE(return_type) return_type __attribute__ ((noinline))
+#  define RESTRICT __restrict
+#elif defined(COMPILER_MSVC)
+#  define ALWAYS_INLINE(return_type) __forceinline return_type
+#  define NEVER_INLINE(return_type) __declspec(noinline) return_type
+#  define RESTRICT __restrict
+#else
+#  define ALWAYS_INLINE(return_type) inline return_type
+#  define NEVER_INLINE(return_type) return_type
+#  define RESTRICT
+#endif
+
+/*
+   vector support macros: the rest of the code is independant of
+   SSE/NEON -- adding support for other platforms with 4-element
+   vectors should be limited to these macros
+*/
+
+// define PFFFT_SIMD_DISABLE if you want to use scalar code instead of simd code
+//#define PFFFT_SIMD_DISABLE
+
+/*
+  SSE1 support macros
+*/
+#if !defined(PFFFT_SIMD_DISABLE) && (defined(__x86_64__) || defined(_M_X64) \
+    || defined(i386) || defined(__i386__) || defined(_M_IX86) \
+    || defined(__SSE__))
+
+#include <xmmintrin.h>
+typedef __m128 v4sf;
+#  define SIMD_SZ 4 // 4 floats by simd vector -- this is pretty much hardcoded in the preprocess/finalize functions anyway so you will have to work if you want to enable AVX with its 256-bit vectors.
+#  define VZERO() _mm_setzero_ps()
+#  define VMUL(a,b) _mm_mul_ps(a,b)
+#  define VADD(a,b) _mm_add_ps(a,b)
+#  define VMADD(a,b,c) _mm_add_ps(_mm_mul_ps(a,b), c)
+#  define VSUB(a,b) _mm_sub_ps(a,b)
+#  define LD_PS1(p) _mm_set1_ps(p)
+#  define INTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = _mm_unpacklo_ps(in1, in2); out2 = _mm_unpackhi_ps(in1, in2); out1 = tmp__; }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) { v4sf tmp__ = _mm_shuffle_ps(in1, in2, _MM_SHUFFLE(2,0,2,0)); out2 = _mm_shuffle_ps(in1, in2, _MM_SHUFFLE(3,1,3,1)); out1 = tmp__; }
+#  define VTRANSPOSE4(x0,x1,x2,x3) _MM_TRANSPOSE4_PS(x0,x1,x2,x3)
+#  define VSWAPHL(a,b) _mm_shuffle_ps(b, a, _MM_SHUFFLE(3,2,1,0))
+#  define VALIGNED(ptr) ((((size_t)(ptr)) & 0xF) == 0)
+
+/*
+  ARM NEON support macros
+*/
+#elif !defined(PFFFT_SIMD_DISABLE) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#  include <arm_neon.h>
+typedef float32x4_t v4sf;
+#  define SIMD_SZ 4
+#  define VZERO() vdupq_n_f32(0)
+#  define VMUL(a,b) vmulq_f32(a,b)
+#  define VADD(a,b) vaddq_f32(a,b)
+#  define VMADD(a,b,c) vmlaq_f32(c,a,b)
+#  define VSUB(a,b) vsubq_f32(a,b)
+#  define LD_PS1(p) vld1q_dup_f32(&(p))
+#  define INTERLEAVE2(in1, in2, out1, out2) { float32x4x2_t tmp__ = vzipq_f32(in1,in2); out1=tmp__.val[0]; out2=tmp__.val[1]; }
+#  define UNINTERLEAVE2(in1, in2, out1, out2) { float32x4x2_t tmp__ = vuzpq_f32(in1,in2); out1=tmp__.val[0]; out2=tmp__.val[1]; }
+#  define VTRANSPOSE4(x0,x1,x2,x3) {                                    \
+    float32x4x2_t t0_ = vzipq_f32(x0, x2);                              \
+    float32x4x2_t t1_ = vzipq_f32(x1, x3);                              \
+    float32x4x2_t u0_ = vzipq_f32(t0_.val[0], t1_.val[0]);              \
+    float32x4x2_t u1_ = vzipq_f32(t0_.val[1], t1_.val[1]);              \
+    x0 = u0_.val[0]; x1 = u0_.val[1]; x2 = u1_.val[0]; x3 = u1_.val[1]; \
+  }
+// marginally faster version
+//#  define VTRANSPOSE4(x0,x1,x2,x3) { asm("vtrn.32 %q0, %q1;\n vtrn.32 %q2,%q3\n vswp %f0,%e2\n vswp %f1,%e3" : "+w"(x0), "+w"(x1), "+w"(x2), "+w"(x3)::); }
+#  define VSWAPHL(a,b) vcombine_f32(vget_low_f32(b), vget_high_f32(a))
+#  define VALIGNED(ptr) ((((size_t)(ptr)) & 0x3) == 0)
+#else
+#  if !defined(PFFFT_SIMD_DISABLE)
+#    warning "building with simd disabled !\n"
+#    define PFFFT_SIMD_DISABLE // fallback to scalar code
+#  endif
+#endif
+
+// fallback mode for situations where SSE/NEON are not available, use scalar mode instead
+#ifdef PFFFT_SIMD_DISABLE
+typedef float v4sf;
+#  define SIMD_SZ 1
+#  define VZERO() 0.f
+#  define VMUL(a,b) ((a)*(b))
+#  define VADD(a,b) ((a)+(b))
+#  define VMADD(a,b,c) ((a)*(b)+(c))
+#  define VSUB(a,b) ((a)-(b))
+#  define LD_PS1(p) (p)
+#  define VALIGNED(ptr) ((((size_t)(ptr)) & 0x3) == 0)
+#endif
+
+// shortcuts for complex multiplcations
+#define VCPLXMUL(ar,ai,br,bi) { v4sf tmp; tmp=VMUL(ar,bi); ar=VMUL(ar,br); ar=VSUB(ar,VMUL(ai,bi)); ai=VMUL(ai,br); ai=VADD(ai,tmp); }
+#define VCPLXMULCONJ(ar,ai,br,bi) { v4sf tmp; tmp=VMUL(ar,bi); ar=VMUL(ar,br); ar=VADD(ar,VMUL(ai,bi)); ai=VMUL(ai,br); ai=VSUB(ai,tmp); }
+#ifndef SVMUL
+// multiply a scalar with a vector
+#define SVMUL(f,v) VMUL(LD_PS1(f),v)
+#endif
+
+#if !defined(PFFFT_SIMD_DISABLE)
+typedef union v4sf_union {
+  v4sf  v;
+  float f[4];
+} v4sf_union;
+#endif
+
+/* SSE and co like 16-bytes aligned pointers */
+#define MALLOC_V4SF_ALIGNMENT 64 // with a 64-byte alignment, we are even aligned on L2 cache lines...
+void *pffft_aligned_malloc(size_t nb_bytes) {
+  void *p, *p0 = aubio_calloc(nb_bytes + MALLOC_V4SF_ALIGNMENT);
+  if (!p0) return (void *) 0;
+  p = (void *) (((size_t) p0 + MALLOC_V4SF_ALIGNMENT) & (~((size_t) (MALLOC_V4SF_ALIGNMENT-1))));
+  *((void **) p - 1) = p0;
+  return p;
+}
+
+void pffft_aligned_free(void *p) {
+  if (p) AUBIO_FREE(*((void **) p - 1));
+}
+
+int pffft_simd_size(void) { return SIMD_SZ; }
+
+/*
+  FFTPACK real passes, on vectors of SIMD_SZ independent transforms.
+
+  radfN: cc is CC(ido,l1,N), ch is CH(ido,N,l1)
+  radbN: cc is CC(ido,N,l1), ch is CH(ido,l1,N)
+*/
+
+static NEVER_INLINE(void) radf2_ps(int ido, int l1, const v4sf * RESTRICT cc,
+    v4sf * RESTRICT ch, const float *wa1) {
+#define CC(a,b,c) cc[(a) + ido*((b) + l1*(c))]
+#define CH(a,b,c) ch[(a) + ido*((b) + 2*(c))]
+  static const float minus_one = -1.f;
+  int i, k;
+  for (k=0; k < l1; ++k) {
+    v4sf a = CC(0,k,0), b = CC(0,k,1);
+    CH(0,0,k) = VADD(a, b);
+    CH(ido-1,1,k) = VSUB(a, b);
+  }
+  if (ido < 2) return;
+  if (ido != 2) {
+    for (k=0; k < l1; ++k) {
+      for (i=2; i < ido; i+=2) {
+        int ic = ido - i;
+        v4sf tr2 = CC(i-1,k,1), ti2 = CC(i,k,1);
+        v4sf br = CC(i-1,k,0), bi = CC(i,k,0);
+        VCPLXMULCONJ(tr2, ti2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1]));
+        CH(i,0,k) = VADD(bi, ti2);
+        CH(ic,1,k) = VSUB(ti2, bi);
+        CH(i-1,0,k) = VADD(br, tr2);
+        CH(ic-1,1,k) = VSUB(br, tr2);
+      }
+    }
+    if (ido % 2 == 1) return;
+  }
+  for (k=0; k < l1; ++k) {
+    CH(0,1,k) = SVMUL(minus_one, CC(ido-1,k,1));
+    CH(ido-1,0,k) = CC(ido-1,k,0);
+  }
+#undef CC
+#undef CH
+} /* radf2 */
+
+static NEVER_INLINE(void) radb2_ps(int ido, int l1, const v4sf *cc, v4sf *ch,
+    const float *wa1) {
+#define CC(a,b,c) cc[(a) + ido*((b) + 2*(c))]
+#define CH(a,b,c) ch[(a) + ido*((b) + l1*(c))]
+  static const float minus_two = -2.f;
+  int i, k;
+  for (k=0; k < l1; ++k) {
+    v4sf a = CC(0,0,k), b = CC(ido-1,1,k);
+    CH(0,k,0) = VADD(a, b);
+    CH(0,k,1) = VSUB(a, b);
+  }
+  if (ido < 2) return;
+  if (ido != 2) {
+    for (k=0; k < l1; ++k) {
+      for (i=2; i < ido; i+=2) {
+        int ic = ido - i;
+        v4sf a = CC(i-1,0,k), b = CC(ic-1,1,k);
+        v4sf c = CC(i,0,k), d = CC(ic,1,k);
+        v4sf tr2 = VSUB(a, b), ti2 = VADD(c, d);
+        CH(i-1,k,0) = VADD(a, b);
+        CH(i,k,0) = VSUB(c, d);
+        VCPLXMUL(tr2, ti2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1]));
+        CH(i-1,k,1) = tr2;
+        CH(i,k,1) = ti2;
+      }
+    }
+    if (ido % 2 == 1) return;
+  }
+  for (k=0; k < l1; ++k) {
+    v4sf a = CC(ido-1,0,k);
+    CH(ido-1,k,0) = VADD(a, a);
+    CH(ido-1,k,1) = SVMUL(minus_two, CC(0,1,k));
+  }
+#undef CC
+#undef CH
+} /* radb2 */
+
+static void radf3_ps(int ido, int l1, const v4sf * RESTRICT cc,
+    v4sf * RESTRICT ch, const float *wa1, const float *wa2) {
+#define CC(a,b,c) cc[(a) + ido*((b) + l1*(c))]
+#define CH(a,b,c) ch[(a) + ido*((b) + 3*(c))]
+  static const float taur = -0.5f;
+  static const float taui = 0.866025403784439f;
+  int i, k;
+  v4sf ci2, di2, di3, cr2, dr2, dr3, ti2, ti3, tr2, tr3;
+  for (k=0; k < l1; ++k) {
+    cr2 = VADD(CC(0,k,1), CC(0,k,2));
+    CH(0,0,k) = VADD(CC(0,k,0), cr2);
+    CH(0,2,k) = SVMUL(taui, VSUB(CC(0,k,2), CC(0,k,1)));
+    CH(ido-1,1,k) = VADD(CC(0,k,0), SVMUL(taur, cr2));
+  }
+  if (ido == 1) return;
+  for (k=0; k < l1; ++k) {
+    for (i=2; i < ido; i+=2) {
+      int ic = ido - i;
+      dr2 = CC(i-1,k,1); di2 = CC(i,k,1);
+      VCPLXMULCONJ(dr2, di2, LD_PS1(wa1[i - 2]), LD_PS1(wa1[i - 1]));
+      dr3 = CC(i-1,k,2); di3 = CC(i,k,2);
+      VCPLXMULCONJ(dr3, di3, LD_PS1(wa2[i - 2]), LD_PS1(wa2[i - 1]));
+      cr2 = VADD(dr2, dr3);
+      ci2 = VADD(di2, di3);
+      CH(i-1,0,k) = VADD(CC(i-1,k,0), cr2);
+      CH(i,0,k) = VADD(CC(i,k,0), ci2);
+      tr2 = VADD(CC(i-1,k,0), SVMUL(taur, cr2));
+      ti2 = VADD(CC(i,k,0), SVMUL(taur, ci2));
+      tr3 = SVMUL(taui, VSUB(di2, di3));
+      ti3 = SVMUL(taui, VSUB(dr3, dr2));
+      CH(i-1,2,k) = VADD(tr2, tr3);
+      CH(ic-1,1,k) = VSUB(tr2, tr3);
+      CH(i,2,k) = VADD(ti2, ti3);
+      CH(ic,1,k) = VSUB(ti3, ti2);
+    }
+  }
+#undef CC
+#undef CH
+} /* radf3 */
+
+static void radb3_ps(int ido, int l1, const v4sf * RESTRICT cc,
+    v4sf * RESTRICT ch, const float *wa1, const float *wa2) {
+#define CC(a,b,c) cc[(a) + ido*((b) + 3*(c))]
+#define CH(a,b,c) ch[(a) + ido*((b) + l1*(c))]
+  static const float taur = -0.5f;
+  static const float taui = 0.866025403784439f;
+  static const float taui_2 = 0.866025403784439f*2;
+  int i, k;
+  v4sf ci2, ci3, di2, di3, cr2, cr3, dr2, dr3, ti2, tr2;
+  for (k=0; k < l1; ++k) {
+    tr2 = VADD(CC(ido-1,1,k), CC(ido-1,1,k));
+    cr2 = VMADD(LD_PS1(taur), tr2, CC(0,0,k));
+    CH(0,k,0) = VADD(CC(0,0,k), tr2);
+    ci3 = SVMUL(taui_2, CC(0,2,k));
+    CH(0,k,1) = VSUB(cr2, ci3);
+    CH(0,k,2) = VADD(cr2, ci3);
+  }
+  if (ido == 1) return;
+  for (k=0; k < l1; ++k) {
+    for (i=2; i < ido; i+=2) {
+      int ic = ido - i;
+      tr2 = VADD(CC(i-1,2,k), CC(ic-1,1,k));
+      cr2 = VMADD(LD_PS1(taur), tr2, CC(i-1,0,k));
+      CH(i-1,k,0) = VADD(CC(i-1,0,k), tr2);
+      ti2 = VSUB(CC(i,2,k), CC(ic,1,k));
+      ci2 = VMADD(LD_PS1(taur), ti2, CC(i,0,k));
+      CH(i,k,0) = VADD(CC(i,0,k), ti2);
+      cr3 = SVMUL(taui, VSUB(CC(i-1,2,k), CC(ic-1,1,k)));
+      ci3 = SVMUL(taui, VADD(CC(i,2,k), CC(ic,1,k)));
+      dr2 = VSUB(cr2, ci3);
+      dr3 = VADD(cr2, ci3);
+      di2 = VADD(ci2, cr3);
+      di3 = VSUB(ci2, cr3);
+      VCPLXMUL(dr2, di2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
+      CH(i-1,k,1) = dr2;
+      CH(i,k,1) = di2;
+      VCPLXMUL(dr3, di3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
+      CH(i-1,k,2) = dr3;
+      CH(i,k,2) = di3;
+    }
+  }
+#undef CC
+#undef CH
+} /* radb3 */
+
+static NEVER_INLINE(void) radf4_ps(int ido, int l1, const v4sf *RESTRICT cc,
+    v4sf * RESTRICT ch, const float * RESTRICT wa1,
+    const float * RESTRICT wa2, const float * RESTRICT wa3) {
+#define CC(a,b,c) cc[(a) + ido*((b) + l1*(c))]
+#define CH(a,b,c) ch[(a) + ido*((b) + 4*(c))]
+  static const float minus_hsqt2 = (float)-0.7071067811865475;
+  int i, k;
+  for (k=0; k < l1; ++k) {
+    v4sf a0 = CC(0,k,0), a1 = CC(0,k,1), a2 = CC(0,k,2), a3 = CC(0,k,3);
+    v4sf tr1 = VADD(a1, a3);
+    v4sf tr2 = VADD(a0, a2);
+    CH(0,0,k) = VADD(tr1, tr2);
+    CH(ido-1,3,k) = VSUB(tr2, tr1);
+    CH(ido-1,1,k) = VSUB(a0, a2);
+    CH(0,2,k) = VSUB(a3, a1);
+  }
+  if (ido < 2) return;
+  if (ido != 2) {
+    for (k=0; k < l1; ++k) {
+      for (i=2; i < ido; i+=2) {
+        int ic = ido - i;
+        v4sf cr2, ci2, cr3, ci3, cr4, ci4;
+        v4sf tr1, tr2, tr3, tr4, ti1, ti2, ti3, ti4;
+        v4sf pc = CC(i-1,k,0), pi = CC(i,k,0);
+        cr2 = CC(i-1,k,1); ci2 = CC(i,k,1);
+        VCPLXMULCONJ(cr2, ci2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
+        cr3 = CC(i-1,k,2); ci3 = CC(i,k,2);
+        VCPLXMULCONJ(cr3, ci3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
+        cr4 = CC(i-1,k,3); ci4 = CC(i,k,3);
+        VCPLXMULCONJ(cr4, ci4, LD_PS1(wa3[i-2]), LD_PS1(wa3[i-1]));
+        tr1 = VADD(cr2, cr4);
+        tr4 = VSUB(cr4, cr2);
+        ti1 = VADD(ci2, ci4);
+        ti4 = VSUB(ci2, ci4);
+        ti2 = VADD(pi, ci3);
+        ti3 = VSUB(pi, ci3);
+        tr2 = VADD(pc, cr3);
+        tr3 = VSUB(pc, cr3);
+        CH(i-1,0,k) = VADD(tr1, tr2);
+        CH(ic-1,3,k) = VSUB(tr2, tr1);
+        CH(i,0,k) = VADD(ti1, ti2);
+        CH(ic,3,k) = VSUB(ti1, ti2);
+        CH(i-1,2,k) = VADD(ti4, tr3);
+        CH(ic-1,1,k) = VSUB(tr3, ti4);
+        CH(i,2,k) = VADD(tr4, ti3);
+        CH(ic,1,k) = VSUB(tr4, ti3);
+      }
+    }
+    if (ido % 2 == 1) return;
+  }
+  for (k=0; k < l1; ++k) {
+    v4sf a = CC(ido-1,k,1), b = CC(ido-1,k,3);
+    v4sf c = CC(ido-1,k,0), d = CC(ido-1,k,2);
+    v4sf ti1 = SVMUL(minus_hsqt2, VADD(a, b));
+    v4sf tr1 = SVMUL(minus_hsqt2, VSUB(b, a));
+    CH(ido-1,0,k) = VADD(tr1, c);
+    CH(ido-1,2,k) = VSUB(c, tr1);
+    CH(0,1,k) = VSUB(ti1, d);
+    CH(0,3,k) = VADD(ti1, d);
+  }
+#undef CC
+#undef CH
+} /* radf4 */
+
+static NEVER_INLINE(void) radb4_ps(int ido, int l1, const v4sf * RESTRICT cc,
+    v4sf * RESTRICT ch, const float * RESTRICT wa1,
+    const float * RESTRICT wa2, const float *RESTRICT wa3) {
+#define CC(a,b,c) cc[(a) + ido*((b) + 4*(c))]
+#define CH(a,b,c) ch[(a) + ido*((b) + l1*(c))]
+  static const float minus_sqrt2 = (float)-1.414213562373095;
+  static const float two = 2.f;
+  int i, k;
+  for (k=0; k < l1; ++k) {
+    v4sf a = CC(0,0,k), b = CC(ido-1,3,k);
+    v4sf tr1 = VSUB(a, b);
+    v4sf tr2 = VADD(a, b);
+    v4sf tr3 = SVMUL(two, CC(ido-1,1,k));
+    v4sf tr4 = SVMUL(two, CC(0,2,k));
+    CH(0,k,0) = VADD(tr2, tr3);
+    CH(0,k,1) = VSUB(tr1, tr4);
+    CH(0,k,2) = VSUB(tr2, tr3);
+    CH(0,k,3) = VADD(tr1, tr4);
+  }
+  if (ido < 2) return;
+  if (ido != 2) {
+    for (k=0; k < l1; ++k) {
+      for (i=2; i < ido; i+=2) {
+        int ic = ido - i;
+        v4sf ci2, ci3, ci4, cr2, cr3, cr4;
+        v4sf ti1, ti2, ti3, ti4, tr1, tr2, tr3, tr4;
+        ti1 = VADD(CC(i,0,k), CC(ic,3,k));
+        ti2 = VSUB(CC(i,0,k), CC(ic,3,k));
+        ti3 = VSUB(CC(i,2,k), CC(ic,1,k));
+        tr4 = VADD(CC(i,2,k), CC(ic,1,k));
+        tr1 = VSUB(CC(i-1,0,k), CC(ic-1,3,k));
+        tr2 = VADD(CC(i-1,0,k), CC(ic-1,3,k));
+        ti4 = VSUB(CC(i-1,2,k), CC(ic-1,1,k));
+        tr3 = VADD(CC(i-1,2,k), CC(ic-1,1,k));
+        CH(i-1,k,0) = VADD(tr2, tr3);
+        cr3 = VSUB(tr2, tr3);
+        CH(i,k,0) = VADD(ti2, ti3);
+        ci3 = VSUB(ti2, ti3);
+        cr2 = VSUB(tr1, tr4);
+        cr4 = VADD(tr1, tr4);
+        ci2 = VADD(ti1, ti4);
+        ci4 = VSUB(ti1, ti4);
+        VCPLXMUL(cr2, ci2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
+        CH(i-1,k,1) = cr2;
+        CH(i,k,1) = ci2;
+        VCPLXMUL(cr3, ci3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
+        CH(i-1,k,2) = cr3;
+        CH(i,k,2) = ci3;
+        VCPLXMUL(cr4, ci4, LD_PS1(wa3[i-2]), LD_PS1(wa3[i-1]));
+        CH(i-1,k,3) = cr4;
+        CH(i,k,3) = ci4;
+      }
+    }
+    if (ido % 2 == 1) return;
+  }
+  for (k=0; k < l1; ++k) {
+    v4sf ti1 = VADD(CC(0,1,k), CC(0,3,k));
+    v4sf ti2 = VSUB(CC(0,3,k), CC(0,1,k));
+    v4sf tr1 = VSUB(CC(ido-1,0,k), CC(ido-1,2,k));
+    v4sf tr2 = VADD(CC(ido-1,0,k), CC(ido-1,2,k));
+    CH(ido-1,k,0) = VADD(tr2, tr2);
+    CH(ido-1,k,1) = SVMUL(minus_sqrt2, VSUB(ti1, tr1));
+    CH(ido-1,k,2) = VADD(ti2, ti2);
+    CH(ido-1,k,3) = SVMUL(minus_sqrt2, VADD(ti1, tr1));
+  }
+#undef CC
+#undef CH
+} /* radb4 */
+
+static void radf5_ps(int ido, int l1, const v4sf * RESTRICT cc,
+    v4sf * RESTRICT ch, const float *wa1, const float *wa2,
+    const float *wa3, const float *wa4) {
+#define CC(a,b,c) cc[(a) + ido*((b) + l1*(c))]
+#define CH(a,b,c) ch[(a) + ido*((b) + 5*(c))]
+  static const float tr11 = .309016994374947f;
+  static const float ti11 = .951056516295154f;
+  static const float tr12 = -.809016994374947f;
+  static const float ti12 = .587785252292473f;
+  int i, k;
+  v4sf ci2, di2, ci4, ci5, di3, di4, di5, ci3, cr2, cr3, dr2, dr3, dr4, dr5,
+       cr5, cr4, ti2, ti3, ti5, ti4, tr2, tr3, tr4, tr5;
+  for (k = 0; k < l1; ++k) {
+    cr2 = VADD(CC(0,k,4), CC(0,k,1));
+    ci5 = VSUB(CC(0,k,4), CC(0,k,1));
+    cr3 = VADD(CC(0,k,3), CC(0,k,2));
+    ci4 = VSUB(CC(0,k,3), CC(0,k,2));
+    CH(0,0,k) = VADD(CC(0,k,0), VADD(cr2, cr3));
+    CH(ido-1,1,k) = VADD(CC(0,k,0), VADD(SVMUL(tr11, cr2), SVMUL(tr12, cr3)));
+    CH(0,2,k) = VADD(SVMUL(ti11, ci5), SVMUL(ti12, ci4));
+    CH(ido-1,3,k) = VADD(CC(0,k,0), VADD(SVMUL(tr12, cr2), SVMUL(tr11, cr3)));
+    CH(0,4,k) = VSUB(SVMUL(ti12, ci5), SVMUL(ti11, ci4));
+  }
+  if (ido == 1) return;
+  for (k = 0; k < l1; ++k) {
+    for (i = 2; i < ido; i += 2) {
+      int ic = ido - i;
+      dr2 = CC(i-1,k,1); di2 = CC(i,k,1);
+      VCPLXMULCONJ(dr2, di2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
+      dr3 = CC(i-1,k,2); di3 = CC(i,k,2);
+      VCPLXMULCONJ(dr3, di3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
+      dr4 = CC(i-1,k,3); di4 = CC(i,k,3);
+      VCPLXMULCONJ(dr4, di4, LD_PS1(wa3[i-2]), LD_PS1(wa3[i-1]));
+      dr5 = CC(i-1,k,4); di5 = CC(i,k,4);
+      VCPLXMULCONJ(dr5, di5, LD_PS1(wa4[i-2]), LD_PS1(wa4[i-1]));
+      cr2 = VADD(dr2, dr5);
+      ci5 = VSUB(dr5, dr2);
+      cr5 = VSUB(di2, di5);
+      ci2 = VADD(di2, di5);
+      cr3 = VADD(dr3, dr4);
+      ci4 = VSUB(dr4, dr3);
+      cr4 = VSUB(di3, di4);
+      ci3 = VADD(di3, di4);
+      CH(i-1,0,k) = VADD(CC(i-1,k,0), VADD(cr2, cr3));
+      CH(i,0,k) = VADD(CC(i,k,0), VADD(ci2, ci3));
+      tr2 = VADD(CC(i-1,k,0), VADD(SVMUL(tr11, cr2), SVMUL(tr12, cr3)));
+      ti2 = VADD(CC(i,k,0), VADD(SVMUL(tr11, ci2), SVMUL(tr12, ci3)));
+      tr3 = VADD(CC(i-1,k,0), VADD(SVMUL(tr12, cr2), SVMUL(tr11, cr3)));
+      ti3 = VADD(CC(i,k,0), VADD(SVMUL(tr12, ci2), SVMUL(tr11, ci3)));
+      tr5 = VADD(SVMUL(ti11, cr5), SVMUL(ti12, cr4));
+      ti5 = VADD(SVMUL(ti11, ci5), SVMUL(ti12, ci4));
+      tr4 = VSUB(SVMUL(ti12, cr5), SVMUL(ti11, cr4));
+      ti4 = VSUB(SVMUL(ti12, ci5), SVMUL(ti11, ci4));
+      CH(i-1,2,k) = VADD(tr2, tr5);
+      CH(ic-1,1,k) = VSUB(tr2, tr5);
+      CH(i,2,k) = VADD(ti2, ti5);
+      CH(ic,1,k) = VSUB(ti5, ti2);
+      CH(i-1,4,k) = VADD(tr3, tr4);
+      CH(ic-1,3,k) = VSUB(tr3, tr4);
+      CH(i,4,k) = VADD(ti3, ti4);
+      CH(ic,3,k) = VSUB(ti4, ti3);
+    }
+  }
+#undef CC
+#undef CH
+} /* radf5 */
+
+static void radb5_ps(int ido, int l1, const v4sf *RESTRICT cc,
+    v4sf *RESTRICT ch, const float *wa1, const float *wa2,
+    const float *wa3, const float *wa4) {
+#define CC(a,b,c) cc[(a) + ido*((b) + 5*(c))]
+#define CH(a,b,c) ch[(a) + ido*((b) + l1*(c))]
+  static const float tr11 = .309016994374947f;
+  static const float ti11 = .951056516295154f;
+  static const float tr12 = -.809016994374947f;
+  static const float ti12 = .587785252292473f;
+  int i, k;
+  v4sf ci2, ci3, ci4, ci5, di3, di4, di5, di2, cr2, cr3, cr5, cr4, ti2, ti3,
+       ti4, ti5, dr3, dr4, dr5, dr2, tr2, tr3, tr4, tr5;
+  for (k = 0; k < l1; ++k) {
+    ti5 = VADD(CC(0,2,k), CC(0,2,k));
+    ti4 = VADD(CC(0,4,k), CC(0,4,k));
+    tr2 = VADD(CC(ido-1,1,k), CC(ido-1,1,k));
+    tr3 = VADD(CC(ido-1,3,k), CC(ido-1,3,k));
+    CH(0,k,0) = VADD(CC(0,0,k), VADD(tr2, tr3));
+    cr2 = VADD(CC(0,0,k), VADD(SVMUL(tr11, tr2), SVMUL(tr12, tr3)));
+    cr3 = VADD(CC(0,0,k), VADD(SVMUL(tr12, tr2), SVMUL(tr11, tr3)));
+    ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
+    ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
+    CH(0,k,1) = VSUB(cr2, ci5);
+    CH(0,k,2) = VSUB(cr3, ci4);
+    CH(0,k,3) = VADD(cr3, ci4);
+    CH(0,k,4) = VADD(cr2, ci5);
+  }
+  if (ido == 1) return;
+  for (k = 0; k < l1; ++k) {
+    for (i = 2; i < ido; i += 2) {
+      int ic = ido - i;
+      ti5 = VADD(CC(i,2,k), CC(ic,1,k));
+      ti2 = VSUB(CC(i,2,k), CC(ic,1,k));
+      ti4 = VADD(CC(i,4,k), CC(ic,3,k));
+      ti3 = VSUB(CC(i,4,k), CC(ic,3,k));
+      tr5 = VSUB(CC(i-1,2,k), CC(ic-1,1,k));
+      tr2 = VADD(CC(i-1,2,k), CC(ic-1,1,k));
+      tr4 = VSUB(CC(i-1,4,k), CC(ic-1,3,k));
+      tr3 = VADD(CC(i-1,4,k), CC(ic-1,3,k));
+      CH(i-1,k,0) = VADD(CC(i-1,0,k), VADD(tr2, tr3));
+      CH(i,k,0) = VADD(CC(i,0,k), VADD(ti2, ti3));
+      cr2 = VADD(CC(i-1,0,k), VADD(SVMUL(tr11, tr2), SVMUL(tr12, tr3)));
+      ci2 = VADD(CC(i,0,k), VADD(SVMUL(tr11, ti2), SVMUL(tr12, ti3)));
+      cr3 = VADD(CC(i-1,0,k), VADD(SVMUL(tr12, tr2), SVMUL(tr11, tr3)));
+      ci3 = VADD(CC(i,0,k), VADD(SVMUL(tr12, ti2), SVMUL(tr11, ti3)));
+      cr5 = VADD(SVMUL(ti11, tr5), SVMUL(ti12, tr4));
+      ci5 = VADD(SVMUL(ti11, ti5), SVMUL(ti12, ti4));
+      cr4 = VSUB(SVMUL(ti12, tr5), SVMUL(ti11, tr4));
+      ci4 = VSUB(SVMUL(ti12, ti5), SVMUL(ti11, ti4));
+      dr3 = VSUB(cr3, ci4);
+      dr4 = VADD(cr3, ci4);
+      di3 = VADD(ci3, cr4);
+      di4 = VSUB(ci3, cr4);
+      dr5 = VADD(cr2, ci5);
+      dr2 = VSUB(cr2, ci5);
+      di5 = VSUB(ci2, cr5);
+      di2 = VADD(ci2, cr5);
+      VCPLXMUL(dr2, di2, LD_PS1(wa1[i-2]), LD_PS1(wa1[i-1]));
+      VCPLXMUL(dr3, di3, LD_PS1(wa2[i-2]), LD_PS1(wa2[i-1]));
+      VCPLXMUL(dr4, di4, LD_PS1(wa3[i-2]), LD_PS1(wa3[i-1]));
+      VCPLXMUL(dr5, di5, LD_PS1(wa4[i-2]), LD_PS1(wa4[i-1]));
+      CH(i-1,k,1) = dr2; CH(i,k,1) = di2;
+      CH(i-1,k,2) = dr3; CH(i,k,2) = di3;
+      CH(i-1,k,3) = dr4; CH(i,k,3) = di4;
+      CH(i-1,k,4) = dr5; CH(i,k,4) = di5;
+    }
+  }
+#undef CC
+#undef CH
+} /* radb5 */
+
+static NEVER_INLINE(v4sf *) rfftf1_ps(int n, const v4sf *input_readonly,
+    v4sf *work1, v4sf *work2, const float *wa, const int *ifac) {
+  v4sf *in  = (v4sf*)input_readonly;
+  v4sf *out = (in == work2 ? work1 : work2);
+  int nf = ifac[1], k1;
+  int l2 = n;
+  int iw = n-1;
+  assert(in != out && work1 != work2);
+  for (k1 = 1; k1 <= nf; ++k1) {
+    int kh = nf - k1;
+    int ip = ifac[kh + 2];
+    int l1 = l2 / ip;
+    int ido = n / l2;
+    iw -= (ip - 1)*ido;
+    switch (ip) {
+      case 5: {
+        int ix2 = iw + ido;
+        int ix3 = ix2 + ido;
+        int ix4 = ix3 + ido;
+        radf5_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4]);
+      } break;
+      case 4: {
+        int ix2 = iw + ido;
+        int ix3 = ix2 + ido;
+        radf4_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3]);
+      } break;
+      case 3: {
+        int ix2 = iw + ido;
+        radf3_ps(ido, l1, in, out, &wa[iw], &wa[ix2]);
+      } break;
+      case 2:
+        radf2_ps(ido, l1, in, out, &wa[iw]);
+        break;
+      default:
+        assert(0);
+        break;
+    }
+    l2 = l1;
+    if (out == work2) {
+      out = work1; in = work2;
+    } else {
+      out = work2; in = work1;
+    }
+  }
+  return in; /* this is in fact the output .. */
+} /* rfftf1 */
+
+static NEVER_INLINE(v4sf *) rfftb1_ps(int n, const v4sf *input_readonly,
+    v4sf *work1, v4sf *work2, const float *wa, const int *ifac) {
+  v4sf *in  = (v4sf*)input_readonly;
+  v4sf *out = (in == work2 ? work1 : work2);
+  int nf = ifac[1], k1;
+  int l1 = 1;
+  int iw = 0;
+  assert(in != out);
+  for (k1=1; k1<=nf; k1++) {
+    int ip = ifac[k1 + 1];
+    int l2 = ip*l1;
+    int ido = n / l2;
+    switch (ip) {
+      case 5: {
+        int ix2 = iw + ido;
+        int ix3 = ix2 + ido;
+        int ix4 = ix3 + ido;
+        radb5_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3], &wa[ix4]);
+      } break;
+      case 4: {
+        int ix2 = iw + ido;
+        int ix3 = ix2 + ido;
+        radb4_ps(ido, l1, in, out, &wa[iw], &wa[ix2], &wa[ix3]);
+      } break;
+      case 3: {
+        int ix2 = iw + ido;
+        radb3_ps(ido, l1, in, out, &wa[iw], &wa[ix2]);
+      } break;
+      case 2:
+        radb2_ps(ido, l1, in, out, &wa[iw]);
+        break;
+      default:
+        assert(0);
+        break;
+    }
+    l1 = l2;
+    iw += (ip - 1)*ido;
+
+    if (out == work2) {
+      out = work1; in = work2;
+    } else {
+      out = work2; in = work1;
+    }
+  }
+  return in; /* this is in fact the output .. */
+}
+
+static int decompose(int n, int *ifac, const int *ntryh) {
+  int nl = n, nf = 0, i, j = 0;
+  for (j=0; ntryh[j]; ++j) {
+    int ntry = ntryh[j];
+    while (nl != 1) {
+      int nq = nl / ntry;
+      int nr = nl - ntry * nq;
+      if (nr == 0) {
+        ifac[2+nf++] = ntry;
+        nl = nq;
+        if (ntry == 2 && nf != 1) {
+          for (i = 2; i <= nf; ++i) {
+            int ib = nf - i + 2;
+            ifac[ib + 1] = ifac[ib];
+          }
+          ifac[2] = 2;
+        }
+      } else break;
+    }
+  }
+  ifac[0] = n;
+  ifac[1] = nf;
+  return nf;
+}
+
+static void rffti1_ps(int n, float *wa, int *ifac) {
+  static const int ntryh[] = { 4,2,3,5,0 };
+  int k1, j, ii;
+
+  int nf = decompose(n,ifac,ntryh);
+  float argh = (2*M_PI) / n;
+  int is = 0;
+  int nfm1 = nf - 1;
+  int l1 = 1;
+  for (k1 = 1; k1 <= nfm1; k1++) {
+    int ip = ifac[k1 + 1];
+    int ld = 0;
+    int l2 = l1*ip;
+    int ido = n / l2;
+    int ipm = ip - 1;
+    for (j = 1; j <= ipm; ++j) {
+      float argld;
+      int i = is, fi=0;
+      ld += l1;
+      argld = ld*argh;
+      for (ii = 3; ii <= ido; ii += 2) {
+        i += 2;
+        fi += 1;
+        wa[i - 2] = cos(fi*argld);
+        wa[i - 1] = sin(fi*argld);
+      }
+      is += ido;
+    }
+    l1 = l2;
+  }
+} /* rffti1 */
+
+struct PFFFT_Setup {
+  int     N;
+  int     Ncvec; // nb of complex simd vectors (N/8 for real transforms)
+  int ifac[15];
+  pffft_transform_t transform;
+  v4sf *data; // allocated room for twiddle coefs
+  float *e;    // points into 'data' , N/4*3 elements
+  float *twiddle; // points into 'data', N/4 elements
+};
+
+PFFFT_Setup *pffft_new_setup(int N, pffft_transform_t transform) {
+  PFFFT_Setup *s;
+  int k, m;
+  /* unfortunately, the fft size must be a multiple of 32 for real FFTs --
+     a lot of stuff would need to be rewritten to handle other cases */
+  if (transform != PFFFT_REAL) return 0;
+  if (N <= 0 || (N % (2*SIMD_SZ*SIMD_SZ)) != 0) return 0;
+  s = AUBIO_NEW(PFFFT_Setup);
+  s->N = N;
+  s->transform = transform;
+  /* nb of complex simd vectors */
+  s->Ncvec = N/2/SIMD_SZ;
+  s->data = (v4sf*)pffft_aligned_malloc(2*s->Ncvec * sizeof(v4sf));
+  if (!s->data) { AUBIO_FREE(s); return 0; }
+  s->e = (float*)s->data;
+  s->twiddle = (float*)(s->data + (2*s->Ncvec*(SIMD_SZ-1))/SIMD_SZ);
+
+  for (k=0; k < s->Ncvec; ++k) {
+    int i = k/SIMD_SZ;
+    int j = k%SIMD_SZ;
+    for (m=0; m < SIMD_SZ-1; ++m) {
+      double A = -2*M_PI*(m+1)*k / N;
+      s->e[(2*(i*3 + m) + 0) * SIMD_SZ + j] = cos(A);
+      s->e[(2*(i*3 + m) + 1) * SIMD_SZ + j] = sin(A);
+    }
+  }
+  rffti1_ps(N/SIMD_SZ, s->twiddle, s->ifac);
+
+  /* check that N is decomposable with allowed prime factors */
+  for (k=0, m=1; k < s->ifac[1]; ++k) { m *= s->ifac[2+k]; }
+  if (m != N/SIMD_SZ) {
+    pffft_destroy_setup(s); s = 0;
+  }
+
+  return s;
+}
+
+void pffft_destroy_setup(PFFFT_Setup *s) {
+  pffft_aligned_free(s->data);
+  AUBIO_FREE(s);
+}
+
+#if !defined(PFFFT_SIMD_DISABLE)
+
+/* [0 0 1 2 3 4 5 6 7 8] -> [0 8 7 6 5 4 3 2 1] */
+static void reversed_copy(int N, const v4sf *in, int in_stride, v4sf *out) {
+  v4sf g0, g1;
+  int k;
+  INTERLEAVE2(in[0], in[1], g0, g1); in += in_stride;
+
+  *--out = VSWAPHL(g0, g1); // [g0l, g0h], [g1l g1h] -> [g1l, g0h]
+  for (k=1; k < N; ++k) {
+    v4sf h0, h1;
+    INTERLEAVE2(in[0], in[1], h0, h1); in += in_stride;
+    *--out = VSWAPHL(g1, h0);
+    *--out = VSWAPHL(h0, h1);
+    g1 = h1;
+  }
+  *--out = VSWAPHL(g1, g0);
+}
+
+static void unreversed_copy(int N, const v4sf *in, v4sf *out, int out_stride) {
+  v4sf g0, g1, h0, h1;
+  int k;
+  g0 = g1 = in[0]; ++in;
+  for (k=1; k < N; ++k) {
+    h0 = *in++; h1 = *in++;
+    g1 = VSWAPHL(g1, h0);
+    h0 = VSWAPHL(h0, h1);
+    UNINTERLEAVE2(h0, g1, out[0], out[1]); out += out_stride;
+    g1 = h1;
+  }
+  h0 = *in++; h1 = g0;
+  g1 = VSWAPHL(g1, h0);
+  h0 = VSWAPHL(h0, h1);
+  UNINTERLEAVE2(h0, g1, out[0], out[1]);
+}
+
+void pffft_zreorder(PFFFT_Setup *setup, const float *in, float *out,
+    pffft_direction_t direction) {
+  int k, N = setup->N;
+  const v4sf *vin = (const v4sf*)in;
+  v4sf *vout = (v4sf*)out;
+  int dk = N/32;
+  assert(in != out);
+  if (direction == PFFFT_FORWARD) {
+    for (k=0; k < dk; ++k) {
+      INTERLEAVE2(vin[k*8 + 0], vin[k*8 + 1], vout[2*(0*dk + k) + 0], vout[2*(0*dk + k) + 1]);
+      INTERLEAVE2(vin[k*8 + 4], vin[k*8 + 5], vout[2*(2*dk + k) + 0], vout[2*(2*dk + k) + 1]);
+    }
+    reversed_copy(dk, vin+2, 8, (v4sf*)(out + N/2));
+    reversed_copy(dk, vin+6, 8, (v4sf*)(out + N));
+  } else {
+    for (k=0; k < dk; ++k) {
+      UNINTERLEAVE2(vin[2*(0*dk + k) + 0], vin[2*(0*dk + k) + 1], vout[k*8 + 0], vout[k*8 + 1]);
+      UNINTERLEAVE2(vin[2*(2*dk + k) + 0], vin[2*(2*dk + k) + 1], vout[k*8 + 4], vout[k*8 + 5]);
+    }
+    unreversed_copy(dk, (v4sf*)(in + N/4), (v4sf*)(out + N - 6*SIMD_SZ), -8);
+    unreversed_copy(dk, (v4sf*)(in + 3*N/4), (v4sf*)(out + N - 2*SIMD_SZ), -8);
+  }
+}
+
+static ALWAYS_INLINE(void) pffft_real_finalize_4x4(const v4sf *in0,
+    const v4sf *in1, const v4sf *in, const v4sf *e, v4sf *out) {
+  v4sf r0, i0, r1, i1, r2, i2, r3, i3;
+  v4sf sr0, dr0, sr1, dr1, si0, di0, si1, di1;
+  r0 = *in0; i0 = *in1;
+  r1 = *in++; i1 = *in++; r2 = *in++; i2 = *in++; r3 = *in++; i3 = *in++;
+  VTRANSPOSE4(r0,r1,r2,r3);
+  VTRANSPOSE4(i0,i1,i2,i3);
+
+  /*
+    transformation for each column is:
+
+    [1   1   1   1   0   0   0   0]   [r0]
+    [1   0  -1   0   0  -1   0   1]   [r1]
+    [1   0  -1   0   0   1   0  -1]   [r2]
+    [1  -1   1  -1   0   0   0   0]   [r3]
+    [0   0   0   0   1   1   1   1] * [i0]
+    [0  -1   0   1  -1   0   1   0]   [i1]
+    [0  -1   0   1   1   0  -1   0]   [i2]
+    [0   0   0   0  -1   1  -1   1]   [i3]
+  */
+
+  VCPLXMUL(r1,i1,e[0],e[1]);
+  VCPLXMUL(r2,i2,e[2],e[3]);
+  VCPLXMUL(r3,i3,e[4],e[5]);
+
+  sr0 = VADD(r0,r2); dr0 = VSUB(r0,r2);
+  sr1 = VADD(r1,r3); dr1 = VSUB(r3,r1);
+  si0 = VADD(i0,i2); di0 = VSUB(i0,i2);
+  si1 = VADD(i1,i3); di1 = VSUB(i3,i1);
+
+  r0 = VADD(sr0, sr1);
+  r3 = VSUB(sr0, sr1);
+  i0 = VADD(si0, si1);
+  i3 = VSUB(si1, si0);
+  r1 = VADD(dr0, di1);
+  r2 = VSUB(dr0, di1);
+  i1 = VSUB(dr1, di0);
+  i2 = VADD(dr1, di0);
+
+  *out++ = r0;
+  *out++ = i0;
+  *out++ = r1;
+  *out++ = i1;
+  *out++ = r2;
+  *out++ = i2;
+  *out++ = r3;
+  *out++ = i3;
+}
+
+static NEVER_INLINE(void) pffft_real_finalize(int Ncvec, const v4sf *in,
+    v4sf *out, const v4sf *e) {
+  int k, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
+  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
+
+  v4sf_union cr, ci, *uout = (v4sf_union*)out;
+  v4sf save = in[7], zero=VZERO();
+  float xr0, xi0, xr1, xi1, xr2, xi2, xr3, xi3;
+  static const float s = M_SQRT2/2;
+
+  cr.v = in[0];
+  ci.v = in[Ncvec*2-1];
+  assert(in != out);
+  pffft_real_finalize_4x4(&zero, &zero, in+1, e, out);
+
+  /*
+    [cr0 cr1 cr2 cr3 ci0 ci1 ci2 ci3]
+
+    [Xr(1)]  ] [1   1   1   1   0   0   0   0]
+    [Xr(N/4) ] [0   0   0   0   1   s   0  -s]
+    [Xr(N/2) ] [1   0  -1   0   0   0   0   0]
+    [Xr(3N/4)] [0   0   0   0   1  -s   0   s]
+    [Xi(1)   ] [1  -1   1  -1   0   0   0   0]
+    [Xi(N/4) ] [0   0   0   0   0  -s  -1  -s]
+    [Xi(N/2) ] [0  -1   0   1   0   0   0   0]
+    [Xi(3N/4)] [0   0   0   0   0  -s   1  -s]
+  */
+
+  xr0=(cr.f[0]+cr.f[2]) + (cr.f[1]+cr.f[3]); uout[0].f[0] = xr0;
+  xi0=(cr.f[0]+cr.f[2]) - (cr.f[1]+cr.f[3]); uout[1].f[0] = xi0;
+  xr2=(cr.f[0]-cr.f[2]);                     uout[4].f[0] = xr2;
+  xi2=(cr.f[3]-cr.f[1]);                     uout[5].f[0] = xi2;
+  xr1= ci.f[0] + s*(ci.f[1]-ci.f[3]);        uout[2].f[0] = xr1;
+  xi1=-ci.f[2] - s*(ci.f[1]+ci.f[3]);        uout[3].f[0] = xi1;
+  xr3= ci.f[0] - s*(ci.f[1]-ci.f[3]);        uout[6].f[0] = xr3;
+  xi3= ci.f[2] - s*(ci.f[1]+ci.f[3]);        uout[7].f[0] = xi3;
+
+  for (k=1; k < dk; ++k) {
+    v4sf save_next = in[8*k+7];
+    pffft_real_finalize_4x4(&save, &in[8*k+0], in + 8*k+1,
+                           e + k*6, out + k*8);
+    save = save_next;
+  }
+
+}
+
+static ALWAYS_INLINE(void) pffft_real_preprocess_4x4(const v4sf *in,
+    const v4sf *e, v4sf *out, int first) {
+  v4sf r0=in[0], i0=in[1], r1=in[2], i1=in[3], r2=in[4], i2=in[5], r3=in[6], i3=in[7];
+  /*
+    transformation for each column is:
+
+    [1   1   1   1   0   0   0   0]   [r0]
+    [1   0   0  -1   0  -1  -1   0]   [r1]
+    [1  -1  -1   1   0   0   0   0]   [r2]
+    [1   0   0  -1   0   1   1   0]   [r3]
+    [0   0   0   0   1  -1   1  -1] * [i0]
+    [0  -1   1   0   1   0   0   1]   [i1]
+    [0   0   0   0   1   1  -1  -1]   [i2]
+    [0   1  -1   0   1   0   0   1]   [i3]
+  */
+
+  v4sf sr0 = VADD(r0,r3), dr0 = VSUB(r0,r3);
+  v4sf sr1 = VADD(r1,r2), dr1 = VSUB(r1,r2);
+  v4sf si0 = VADD(i0,i3), di0 = VSUB(i0,i3);
+  v4sf si1 = VADD(i1,i2), di1 = VSUB(i1,i2);
+
+  r0 = VADD(sr0, sr1);
+  r2 = VSUB(sr0, sr1);
+  r1 = VSUB(dr0, si1);
+  r3 = VADD(dr0, si1);
+  i0 = VSUB(di0, di1);
+  i2 = VADD(di0, di1);
+  i1 = VSUB(si0, dr1);
+  i3 = VADD(si0, dr1);
+
+  VCPLXMULCONJ(r1,i1,e[0],e[1]);
+  VCPLXMULCONJ(r2,i2,e[2],e[3]);
+  VCPLXMULCONJ(r3,i3,e[4],e[5]);
+
+  VTRANSPOSE4(r0,r1,r2,r3);
+  VTRANSPOSE4(i0,i1,i2,i3);
+
+  if (!first) {
+    *out++ = r0;
+    *out++ = i0;
+  }
+  *out++ = r1;
+  *out++ = i1;
+  *out++ = r2;
+  *out++ = i2;
+  *out++ = r3;
+  *out++ = i3;
+}
+
+static NEVER_INLINE(void) pffft_real_preprocess(int Ncvec, const v4sf *in,
+    v4sf *out, const v4sf *e) {
+  int k, dk = Ncvec/SIMD_SZ; // number of 4x4 matrix blocks
+  /* fftpack order is f0r f1r f1i f2r f2i ... f(n-1)r f(n-1)i f(n)r */
+
+  v4sf_union Xr, Xi, *uout = (v4sf_union*)out;
+  float cr0, ci0, cr1, ci1, cr2, ci2, cr3, ci3;
+  static const float s = M_SQRT2;
+  assert(in != out);
+  for (k=0; k < 4; ++k) {
+    Xr.f[k] = ((float*)in)[8*k];
+    Xi.f[k] = ((float*)in)[8*k+4];
+  }
+
+  pffft_real_preprocess_4x4(in, e, out+1, 1); // will write only 6 values
+
+  /*
+    [Xr0 Xr1 Xr2 Xr3 Xi0 Xi1 Xi2 Xi3]
+
+    [cr0] [1   0   2   0   1   0   0   0]
+    [cr1] [1   0   0   0  -1   0  -2   0]
+    [cr2] [1   0  -2   0   1   0   0   0]
+    [cr3] [1   0   0   0  -1   0   2   0]
+    [ci0] [0   2   0   2   0   0   0   0]
+    [ci1] [0   s   0  -s   0  -s   0  -s]
+    [ci2] [0   0   0   0   0  -2   0   2]
+    [ci3] [0  -s   0   s   0  -s   0  -s]
+  */
+  for (k=1; k < dk; ++k) {
+    pffft_real_preprocess_4x4(in+8*k, e + k*6, out-1+k*8, 0);
+  }
+
+  cr0=(Xr.f[0]+Xi.f[0]) + 2*Xr.f[2]; uout[0].f[0] = cr0;
+  cr1=(Xr.f[0]-Xi.f[0]) - 2*Xi.f[2]; uout[0].f[1] = cr1;
+  cr2=(Xr.f[0]+Xi.f[0]) - 2*Xr.f[2]; uout[0].f[2] = cr2;
+  cr3=(Xr.f[0]-Xi.f[0]) + 2*Xi.f[2]; uout[0].f[3] = cr3;
+  ci0= 2*(Xr.f[1]+Xr.f[3]);                       uout[2*Ncvec-1].f[0] = ci0;
+  ci1= s*(Xr.f[1]-Xr.f[3]) - s*(Xi.f[1]+Xi.f[3]); uout[2*Ncvec-1].f[1] = ci1;
+  ci2= 2*(Xi.f[3]-Xi.f[1]);                       uout[2*Ncvec-1].f[2] = ci2;
+  ci3=-s*(Xr.f[1]-Xr.f[3]) - s*(Xi.f[1]+Xi.f[3]); uout[2*Ncvec-1].f[3] = ci3;
+}
+
+static void pffft_transform_internal(PFFFT_Setup *setup, const float *finput,
+    float *foutput, v4sf *scratch, pffft_direction_t direction, int ordered) {
+  int k, Ncvec   = setup->Ncvec;
+  int nf_odd = (setup->ifac[1] & 1);
+
+  const v4sf *vinput = (const v4sf*)finput;
+  v4sf *voutput      = (v4sf*)foutput;
+  v4sf *buff[2]      = { voutput, scratch };
+  int ib = (nf_odd ^ ordered ? 1 : 0);
+
+  assert(VALIGNED(finput) && VALIGNED(foutput) && VALIGNED(scratch));
+
+  if (direction == PFFFT_FORWARD) {
+    ib = !ib;
+    ib = (rfftf1_ps(Ncvec*2, vinput, buff[ib], buff[!ib],
+                    setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
+    pffft_real_finalize(Ncvec, buff[ib], buff[!ib], (v4sf*)setup->e);
+    if (ordered) {
+      pffft_zreorder(setup, (float*)buff[!ib], (float*)buff[ib], PFFFT_FORWARD);
+    } else ib = !ib;
+  } else {
+    if (vinput == buff[ib]) {
+      ib = !ib; // may happen when finput == foutput
+    }
+    if (ordered) {
+      pffft_zreorder(setup, (float*)vinput, (float*)buff[ib], PFFFT_BACKWARD);
+      vinput = buff[ib];
+      ib = !ib;
+    }
+    pffft_real_preprocess(Ncvec, vinput, buff[ib], (v4sf*)setup->e);
+    ib = (rfftb1_ps(Ncvec*2, buff[ib], buff[0], buff[1],
+                    setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
+  }
+
+  if (buff[ib] != voutput) {
+    /* extra copy required -- this situation should only happen when finput == foutput */
+    assert(finput==foutput);
+    for (k=0; k < Ncvec; ++k) {
+      v4sf a = buff[ib][2*k], b = buff[ib][2*k+1];
+      voutput[2*k] = a; voutput[2*k+1] = b;
+    }
+    ib = !ib;
+  }
+  assert(buff[ib] == voutput);
+}
+
+#else // defined(PFFFT_SIMD_DISABLE)
+
+// standard routine using scalar floats, without SIMD stuff.
+
+void pffft_zreorder(PFFFT_Setup *setup, const float *in, float *out,
+    pffft_direction_t direction) {
+  int k, N = setup->N;
+  if (direction == PFFFT_FORWARD) {
+    float x_N = in[N-1];
+    for (k=N-1; k > 1; --k) out[k] = in[k-1];
+    out[0] = in[0];
+    out[1] = x_N;
+  } else {
+    float x_N = in[1];
+    for (k=1; k < N-1; ++k) out[k] = in[k+1];
+    out[0] = in[0];
+    out[N-1] = x_N;
+  }
+}
+
+static void pffft_transform_internal(PFFFT_Setup *setup, const float *input,
+    float *output, float *scratch, pffft_direction_t direction, int ordered) {
+  int Ncvec   = setup->Ncvec;
+  int nf_odd = (setup->ifac[1] & 1);
+
+  float *buff[2];
+  int ib;
+  buff[0] = output; buff[1] = scratch;
+
+  ib = (nf_odd ^ ordered ? 1 : 0);
+
+  if (direction == PFFFT_FORWARD) {
+    ib = (rfftf1_ps(Ncvec*2, input, buff[ib], buff[!ib],
+                    setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
+    if (ordered) {
+      pffft_zreorder(setup, buff[ib], buff[!ib], PFFFT_FORWARD); ib = !ib;
+    }
+  } else {
+    if (input == buff[ib]) {
+      ib = !ib; // may happen when finput == foutput
+    }
+    if (ordered) {
+      pffft_zreorder(setup, input, buff[!ib], PFFFT_BACKWARD);
+      input = buff[!ib];
+    }
+    ib = (rfftb1_ps(Ncvec*2, input, buff[ib], buff[!ib],
+                    setup->twiddle, &setup->ifac[0]) == buff[0] ? 0 : 1);
+  }
+  if (buff[ib] != output) {
+    int k;
+    // extra copy required -- this situation should happens only when finput == foutput
+    assert(input==output);
+    for (k=0; k < Ncvec; ++k) {
+      float a = buff[ib][2*k], b = buff[ib][2*k+1];
+      output[2*k] = a; output[2*k+1] = b;
+    }
+    ib = !ib;
+  }
+  assert(buff[ib] == output);
+}
+
+#endif // defined(PFFFT_SIMD_DISABLE)
+
+void pffft_transform(PFFFT_Setup *setup, const float *input, float *output,
+    float *work, pffft_direction_t direction) {
+  pffft_transform_internal(setup, input, output, (v4sf*)work, direction, 0);
+}
+
+void pffft_transform_ordered(PFFFT_Setup *setup, const float *input,
+    float *output, float *work, pffft_direction_t direction) {
+  pffft_transform_internal(setup, input, output, (v4sf*)work, direction, 1);
+}
@@ -30,20 +30,20 @@ struct _aubio_pvoc_t {
   uint_t win_s;       /** grain length */
   uint_t hop_s;       /** overlap step */
   aubio_fft_t * fft;  /** fft object */
-  fvec_t * data;      /** current input grain, [win_s] frames */
-  fvec_t * dataold;   /** memory of past grain, [win_s-hop_s] frames */
+  fvec_t * data;      /** windowed and shifted input grain, [win_s] frames */
+  fvec_t * dataold;   /** circular memory of past input, [win_s] frames */
+  uint_t pos;         /** position of the oldest frame in dataold */
   fvec_t * synth;     /** current output grain, [win_s] frames */
   fvec_t * synthold;  /** memory of past grain, [win_s-hop_s] frames */
-  fvec_t * w;         /** grain window [win_s] */
+  const fvec_t * w;   /** grain window [win_s], shared */
   uint_t start;       /** where to start additive synthesis */
   uint_t end;         /** where to end it */
   smpl_t scale;       /** scaling factor for synthesis */
-  uint_t end_datasize;  /** size of memory to end */
-  uint_t hop_datasize;  /** size of memory to hop_s */
+  uint_t phase;       /** compute the phase in aubio_pvoc_do */
 };
 
 
-/** returns data and dataold slided by hop_s */
+/** writes new over the oldest hop_s frames of dataold */
 static void aubio_pvoc_swapbuffers(aubio_pvoc_t *pv, const fvec_t *new);
 
 /** do additive synthesis from 'old' and 'cur' */
@@ -52,12 +52,14 @@ static void aubio_pvoc_addsynth(aubio_pvoc_t *pv, fvec_t * synthnew);
 void aubio_pvoc_do(aubio_pvoc_t *pv, const fvec_t * datanew, cvec_t *fftgrain) {
   /* slide  */
   aubio_pvoc_swapbuffers(pv, datanew);
-  /* windowing */
-  fvec_weight(pv->data, pv->w);
-  /* shift */
-  fvec_shift(pv->data);
+  /* windowing and shift, read in place from the circular memory */
+  fvec_weighted_shift(pv->dataold, pv->pos, pv->w, pv->data);
   /* calculate fft */
-  aubio_fft_do (pv->fft,pv->data,fftgrain);
+  if (pv->phase) {
+    aubio_fft_do (pv->fft,pv->data,fftgrain);
+  } else {
+    aubio_fft_do_norm (pv->fft,pv->data,fftgrain);
+  }
 }
 
 void aubio_pvoc_rdo(aubio_pvoc_t *pv,cvec_t * fftgrain, fvec_t * synthnew) {
@@ -102,17 +104,17 @@ aubio_pvoc_t * new_aubio_pvoc (uint_t win_s, uint_t hop_s) {
   pv->synth    = new_fvec (win_s);
 
   /* new input output */
+  pv->dataold  = new_fvec  (win_s);
   if (win_s > hop_s) {
-    pv->dataold  = new_fvec  (win_s-hop_s);
     pv->synthold = new_fvec (win_s-hop_s);
   } else {
-    pv->dataold  = new_fvec  (1);
     pv->synthold = new_fvec (1);
   }
-  pv->w        = new_aubio_window ("hanningz", win_s);
+  pv->w        = aubio_window_acquire ("hanningz", win_s);
 
   pv->hop_s    = hop_s;
   pv->win_s    = win_s;
+  pv->phase    = 1;
 
   /* more than 50% overlap, overlap anyway */
   if (win_s < 2 * hop_s) pv->start = 0;
@@ -122,9 +124,6 @@ aubio_pvoc_t * new_aubio_pvoc (uint_t win_s, uint_t hop_s) {
   if (win_s > hop_s) pv->end = win_s - hop_s;
   else pv->end = 0;
 
-  pv->end_datasize = pv->end * sizeof(smpl_t);
-  pv->hop_datasize = pv->hop_s * sizeof(smpl_t);
-
   // for reconstruction with 75% overlap
   if (win_s == hop_s * 4) {
     pv->scale = 2./3.;
@@ -143,12 +142,17 @@ beach:
   return NULL;
 }
 
+uint_t aubio_pvoc_set_phase(aubio_pvoc_t *pv, uint_t phase) {
+  pv->phase = phase ? 1 : 0;
+  return AUBIO_OK;
+}
+
 void del_aubio_pvoc(aubio_pvoc_t *pv) {
   del_fvec(pv->data);
   del_fvec(pv->synth);
   del_fvec(pv->dataold);
   del_fvec(pv->synthold);
-  del_fvec(pv->w);
+  aubio_window_release(pv->w);
   del_aubio_fft(pv->fft);
   AUBIO_FREE(pv);
 }
@@ -156,25 +160,21 @@ void del_aubio_pvoc(aubio_pvoc_t *pv) {
 static void aubio_pvoc_swapbuffers(aubio_pvoc_t *pv, const fvec_t *new)
 {
   /* some convenience pointers */
-  smpl_t * data = pv->data->data;
   smpl_t * dataold = pv->dataold->data;
   smpl_t * datanew = new->data;
+  /* frames left before the end of dataold, then wrap around */
+  uint_t tail = MIN(pv->hop_s, pv->win_s - pv->pos);
 #ifndef HAVE_MEMCPY_HACKS
   uint_t i;
-  for (i = 0; i < pv->end; i++)
-    data[i] = dataold[i];
-  for (i = 0; i < pv->hop_s; i++)
-    data[pv->end + i] = datanew[i];
-  for (i = 0; i < pv->end; i++)
-    dataold[i] = data[i + pv->hop_s];
+  for (i = 0; i < tail; i++)
+    dataold[pv->pos + i] = datanew[i];
+  for (i = tail; i < pv->hop_s; i++)
+    dataold[i - tail] = datanew[i];
 #else
-  memcpy(data, dataold, pv->end_datasize);
-  data += pv->end;
-  memcpy(data, datanew, pv->hop_datasize);
-  data -= pv->end;
-  data += pv->hop_s;
-  memcpy(dataold, data, pv->end_datasize);
+  memcpy(dataold + pv->pos, datanew, tail * sizeof(smpl_t));
+  memcpy(dataold, datanew + tail, (pv->hop_s - tail) * sizeof(smpl_t));
 #endif
+  pv->pos = (pv->pos + pv->hop_s) % pv->win_s;
 }
 
 static void aubio_pvoc_addsynth(aubio_pvoc_t *pv, fvec_t *synth_new)
@@ -25,10 +25,14 @@
 #include "mathutils.h"
 #include "musicutils.h"
 #include "spectral/phasevoc.h"
+#include "spectral/frontend.h"
 #include "temporal/filter.h"
 #include "temporal/c_weighting.h"
 #include "pitch/pitchmcomb.h"
 #include "pitch/pitchyin.h"
+#include "pitch/pitchyinfast.h"
+#include "pitch/pitchyindec.h"
+#include "pitch/pitchgoertzel.h"
 #include "pitch/pitchfcomb.h"
 #include "pitch/pitchschmitt.h"
 #include "pitch/pitchyinfft.h"
@@ -46,6 +50,9 @@ typedef enum
   aubio_pitcht_fcomb,      /**< `fcomb`, Fast comb filter */
   aubio_pitcht_yinfft,     /**< `yinfft`, Spectral YIN */
   aubio_pitcht_specacf,    /**< `specacf`, Spectral autocorrelation */
+  aubio_pitcht_yinfast,    /**< `yinfast`, YIN algorithm, FFT-based difference */
+  aubio_pitcht_yindec,     /**< `yindec`, YIN algorithm on a decimated signal */
+  aubio_pitcht_goertzel,   /**< `goertzel`, Goertzel filters on the notes */
   aubio_pitcht_default
     = aubio_pitcht_yinfft, /**< `default` */
 } aubio_pitch_type;
@@ -60,7 +67,12 @@ typedef enum
   aubio_pitchm_default = aubio_pitchm_freq, /**< the one used when "default" is asked */
 } aubio_pitch_mode;
 
-/** callback to get pitch candidate, defined below */
+/** callback to get pitch candidate, defined below
+
+  Called with the full analysis frame, except for mcomb, which runs its own
+  phase vocoder and takes the new hop.
+
+*/
 typedef void (*aubio_pitch_detect_t) (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
 
 /** callback to convert pitch from one unit to another, defined below */
@@ -86,6 +98,10 @@ struct _aubio_pitch_t
   aubio_pitch_convert_t conv_cb;  /**< callback to convert it to the desired unit */
   aubio_pitch_get_conf_t conf_cb; /**< pointer to the current confidence callback */
   smpl_t silence;                 /**< silence threshold */
+  smpl_t min_freq;                /**< lowest pitch looked for, 0 if none */
+  smpl_t max_freq;                /**< highest pitch looked for, 0 if none */
+  uint_t frontend_only;           /**< no window or spectrum of its own, see
+                                    new_aubio_pitch_frontend() */
 };
 
 /* callback functions for pitch detection */
@@ -95,6 +111,9 @@ static void aubio_pitch_do_schmitt (aubio_pitch_t * p, const fvec_t * ibuf, fvec
 static void aubio_pitch_do_fcomb (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
 static void aubio_pitch_do_yinfft (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
 static void aubio_pitch_do_specacf (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
+static void aubio_pitch_do_yinfast (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
+static void aubio_pitch_do_yindec (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
+static void aubio_pitch_do_goertzel (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf);
 
 /* conversion functions for frequency conversions */
 smpl_t freqconvbin (smpl_t f, uint_t samplerate, uint_t bufsize);
@@ -104,10 +123,14 @@ smpl_t freqconvpass (smpl_t f, uint_t samplerate, uint_t bufsize);
 /* adapter to stack ibuf new samples at the end of buf, and trim `buf` to `bufsize` */
 void aubio_pitch_slideblock (aubio_pitch_t * p, const fvec_t * ibuf);
 
+/* drop the pitches found out of the range, as the methods may interpolate
+ * past its ends or, like schmitt, not search it at all */
+static smpl_t aubio_pitch_check_range (const aubio_pitch_t * p, smpl_t freq);
 
-aubio_pitch_t *
-new_aubio_pitch (const char_t * pitch_mode,
-    uint_t bufsize, uint_t hopsize, uint_t samplerate)
+
+static aubio_pitch_t *
+new_aubio_pitch_with (const char_t * pitch_mode,
+    uint_t bufsize, uint_t hopsize, uint_t samplerate, uint_t frontend_only)
 {
   aubio_pitch_t *p = AUBIO_NEW (aubio_pitch_t);
   aubio_pitch_type pitch_type;
@@ -117,6 +140,12 @@ new_aubio_pitch (const char_t * pitch_mode,
     pitch_type = aubio_pitcht_yinfft;
   else if (strcmp (pitch_mode, "yin") == 0)
     pitch_type = aubio_pitcht_yin;
+  else if (strcmp (pitch_mode, "yinfast") == 0)
+    pitch_type = aubio_pitcht_yinfast;
+  else if (strcmp (pitch_mode, "yindec") == 0)
+    pitch_type = aubio_pitcht_yindec;
+  else if (strcmp (pitch_mode, "goertzel") == 0)
+    pitch_type = aubio_pitcht_goertzel;
   else if (strcmp (pitch_mode, "schmitt") == 0)
     pitch_type = aubio_pitcht_schmitt;
   else if (strcmp (pitch_mode, "fcomb") == 0)
@@ -152,41 +181,79 @@ new_aubio_pitch (const char_t * pitch_mode,
   p->bufsize = bufsize;
   p->silence = DEFAULT_PITCH_SILENCE;
   p->conf_cb = NULL;
+  p->frontend_only = frontend_only;
   switch (p->type) {
     case aubio_pitcht_yin:
-      p->buf = new_fvec (bufsize);
+      if (!frontend_only) p->buf = new_fvec (bufsize);
       p->p_object = new_aubio_pitchyin (bufsize);
+      /* consecutive windows share all but one hop */
+      aubio_pitchyin_set_hopsize (p->p_object, hopsize);
       p->detect_cb = aubio_pitch_do_yin;
       p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchyin_get_confidence;
       aubio_pitchyin_set_tolerance (p->p_object, 0.15);
       break;
+    case aubio_pitcht_yinfast:
+      if (!frontend_only) p->buf = new_fvec (bufsize);
+      p->p_object = new_aubio_pitchyinfast (bufsize);
+      if (!p->p_object) {
+        if (p->buf) del_fvec (p->buf);
+        goto beach;
+      }
+      p->detect_cb = aubio_pitch_do_yinfast;
+      p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchyinfast_get_confidence;
+      aubio_pitchyinfast_set_tolerance (p->p_object, 0.15);
+      break;
+    case aubio_pitcht_yindec:
+      if (!frontend_only) p->buf = new_fvec (bufsize);
+      p->p_object = new_aubio_pitchyindec (bufsize, samplerate);
+      if (!p->p_object) {
+        if (p->buf) del_fvec (p->buf);
+        goto beach;
+      }
+      p->detect_cb = aubio_pitch_do_yindec;
+      p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchyindec_get_confidence;
+      aubio_pitchyindec_set_tolerance (p->p_object, 0.15);
+      break;
+    case aubio_pitcht_goertzel:
+      if (!frontend_only) p->buf = new_fvec (bufsize);
+      p->p_object = new_aubio_pitchgoertzel (bufsize, samplerate);
+      if (!p->p_object) {
+        if (p->buf) del_fvec (p->buf);
+        goto beach;
+      }
+      p->detect_cb = aubio_pitch_do_goertzel;
+      p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchgoertzel_get_confidence;
+      break;
     case aubio_pitcht_mcomb:
-      p->filtered = new_fvec (hopsize);
-      p->pv = new_aubio_pvoc (bufsize, hopsize);
-      p->fftgrain = new_cvec (bufsize);
+      /* the front-end gives the spectrum */
+      if (!frontend_only) {
+        p->filtered = new_fvec (hopsize);
+        p->pv = new_aubio_pvoc (bufsize, hopsize);
+        p->fftgrain = new_cvec (bufsize);
+        p->filter = new_aubio_filter_c_weighting (samplerate);
+      }
       p->p_object = new_aubio_pitchmcomb (bufsize, hopsize);
-      p->filter = new_aubio_filter_c_weighting (samplerate);
       p->detect_cb = aubio_pitch_do_mcomb;
       break;
     case aubio_pitcht_fcomb:
-      p->buf = new_fvec (bufsize);
+      if (!frontend_only) p->buf = new_fvec (bufsize);
       p->p_object = new_aubio_pitchfcomb (bufsize, hopsize);
       p->detect_cb = aubio_pitch_do_fcomb;
       break;
     case aubio_pitcht_schmitt:
-      p->buf = new_fvec (bufsize);
+      if (!frontend_only) p->buf = new_fvec (bufsize);
       p->p_object = new_aubio_pitchschmitt (bufsize);
       p->detect_cb = aubio_pitch_do_schmitt;
       break;
     case aubio_pitcht_yinfft:
-      p->buf = new_fvec (bufsize);
+      if (!frontend_only) p->buf = new_fvec (bufsize);
       p->p_object = new_aubio_pitchyinfft (samplerate, bufsize);
       p->detect_cb = aubio_pitch_do_yinfft;
       p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchyinfft_get_confidence;
       aubio_pitchyinfft_set_tolerance (p->p_object, 0.85);
       break;
     case aubio_pitcht_specacf:
-      p->buf = new_fvec (bufsize);
+      if (!frontend_only) p->buf = new_fvec (bufsize);
       p->p_object = new_aubio_pitchspecacf (bufsize);
       p->detect_cb = aubio_pitch_do_specacf;
       p->conf_cb = (aubio_pitch_get_conf_t)aubio_pitchspecacf_get_tolerance;
@@ -202,35 +269,61 @@ beach:
   return NULL;
 }
 
+aubio_pitch_t *
+new_aubio_pitch (const char_t * pitch_mode,
+    uint_t bufsize, uint_t hopsize, uint_t samplerate)
+{
+  return new_aubio_pitch_with (pitch_mode, bufsize, hopsize, samplerate, 0);
+}
+
+aubio_pitch_t *
+new_aubio_pitch_frontend (const char_t * pitch_mode,
+    uint_t bufsize, uint_t hopsize, uint_t samplerate)
+{
+  return new_aubio_pitch_with (pitch_mode, bufsize, hopsize, samplerate, 1);
+}
+
 void
 del_aubio_pitch (aubio_pitch_t * p)
 {
   switch (p->type) {
     case aubio_pitcht_yin:
-      del_fvec (p->buf);
+      if (p->buf) del_fvec (p->buf);
       del_aubio_pitchyin (p->p_object);
       break;
+    case aubio_pitcht_yinfast:
+      if (p->buf) del_fvec (p->buf);
+      del_aubio_pitchyinfast (p->p_object);
+      break;
+    case aubio_pitcht_yindec:
+      if (p->buf) del_fvec (p->buf);
+      del_aubio_pitchyindec (p->p_object);
+      break;
+    case aubio_pitcht_goertzel:
+      if (p->buf) del_fvec (p->buf);
+      del_aubio_pitchgoertzel (p->p_object);
+      break;
     case aubio_pitcht_mcomb:
-      del_fvec (p->filtered);
-      del_aubio_pvoc (p->pv);
-      del_cvec (p->fftgrain);
-      del_aubio_filter (p->filter);
+      if (p->filtered) del_fvec (p->filtered);
+      if (p->pv) del_aubio_pvoc (p->pv);
+      if (p->fftgrain) del_cvec (p->fftgrain);
+      if (p->filter) del_aubio_filter (p->filter);
       del_aubio_pitchmcomb (p->p_object);
       break;
     case aubio_pitcht_schmitt:
-      del_fvec (p->buf);
+      if (p->buf) del_fvec (p->buf);
       del_aubio_pitchschmitt (p->p_object);
       break;
     case aubio_pitcht_fcomb:
-      del_fvec (p->buf);
+      if (p->buf) del_fvec (p->buf);
       del_aubio_pitchfcomb (p->p_object);
       break;
     case aubio_pitcht_yinfft:
-      del_fvec (p->buf);
+      if (p->buf) del_fvec (p->buf);
       del_aubio_pitchyinfft (p->p_object);
       break;
     case aubio_pitcht_specacf:
-      del_fvec (p->buf);
+      if (p->buf) del_fvec (p->buf);
       del_aubio_pitchspecacf (p->p_object);
       break;
     default:
@@ -243,7 +336,7 @@ void
 aubio_pitch_slideblock (aubio_pitch_t * p, const fvec_t * ibuf)
 {
   uint_t overlap_size = p->buf->length - ibuf->length;
-#if 1 //!HAVE_MEMCPY_HACKS
+#ifndef HAVE_MEMCPY_HACKS
   uint_t j;
   for (j = 0; j < overlap_size; j++) {
     p->buf->data[j] = p->buf->data[j + ibuf->length];
@@ -254,8 +347,8 @@ aubio_pitch_slideblock (aubio_pitch_t * p, const fvec_t * ibuf)
 #else
   smpl_t *data = p->buf->data;
   smpl_t *newdata = ibuf->data;
-  memmove(data, data + ibuf->length, overlap_size);
-  memcpy(data + overlap_size, newdata, ibuf->length);
+  memmove(data, data + ibuf->length, overlap_size * sizeof(smpl_t));
+  memcpy(data + overlap_size, newdata, ibuf->length * sizeof(smpl_t));
 #endif
 }
 
@@ -315,6 +408,12 @@ aubio_pitch_set_tolerance (aubio_pitch_t * p, smpl_t tol)
     case aubio_pitcht_yin:
       aubio_pitchyin_set_tolerance (p->p_object, tol);
       break;
+    case aubio_pitcht_yinfast:
+      aubio_pitchyinfast_set_tolerance (p->p_object, tol);
+      break;
+    case aubio_pitcht_yindec:
+      aubio_pitchyindec_set_tolerance (p->p_object, tol);
+      break;
     case aubio_pitcht_yinfft:
       aubio_pitchyinfft_set_tolerance (p->p_object, tol);
       break;
@@ -342,16 +441,163 @@ aubio_pitch_get_silence (aubio_pitch_t * p)
   return p->silence;
 }
 
+uint_t
+aubio_pitch_set_range (aubio_pitch_t * p, smpl_t min_freq, smpl_t max_freq)
+{
+  smpl_t samplerate = p->samplerate, bufsize = p->bufsize;
+  uint_t min_lag, max_lag, min_bin, max_bin;
+  if (min_freq < 0 || max_freq < 0 || (max_freq > 0 && min_freq >= max_freq)) {
+    AUBIO_ERR ("pitch: could not set range to %.2f - %.2f Hz\n",
+        min_freq, max_freq);
+    return AUBIO_FAIL;
+  }
+  p->min_freq = min_freq;
+  p->max_freq = max_freq;
+  /* periods, in samples, and fundamentals, in bins, each method clamps
+   * them to what it can look for */
+  min_lag = max_freq > 0 ? FLOOR (samplerate / max_freq) : 0;
+  max_lag = min_freq > 0 ? CEIL (MIN (samplerate / min_freq, bufsize))
+    : p->bufsize;
+  min_bin = FLOOR (min_freq * bufsize / samplerate);
+  max_bin = max_freq > 0 ? CEIL (MIN (max_freq, samplerate / 2.)
+      * bufsize / samplerate) : p->bufsize;
+  switch (p->type) {
+    case aubio_pitcht_yin:
+      aubio_pitchyin_set_lag_range (p->p_object, min_lag, max_lag);
+      break;
+    case aubio_pitcht_yinfast:
+      aubio_pitchyinfast_set_lag_range (p->p_object, min_lag, max_lag);
+      break;
+    case aubio_pitcht_yindec:
+      aubio_pitchyindec_set_lag_range (p->p_object, min_lag, max_lag);
+      break;
+    case aubio_pitcht_yinfft:
+      aubio_pitchyinfft_set_lag_range (p->p_object, min_lag, max_lag);
+      break;
+    case aubio_pitcht_specacf:
+      aubio_pitchspecacf_set_lag_range (p->p_object, min_lag, max_lag);
+      break;
+    case aubio_pitcht_mcomb:
+      aubio_pitchmcomb_set_bin_range (p->p_object, min_bin, max_bin);
+      break;
+    case aubio_pitcht_fcomb:
+      aubio_pitchfcomb_set_bin_range (p->p_object, min_bin, max_bin);
+      break;
+    case aubio_pitcht_goertzel:
+      /* the notes nearest to each end */
+      aubio_pitchgoertzel_set_note_range (p->p_object,
+          min_freq > 0 ? FLOOR (aubio_freqtomidi (min_freq) + .5) : 0,
+          max_freq > 0 ? CEIL (aubio_freqtomidi (max_freq) - .5) : 127);
+      break;
+    default:
+      break;
+  }
+  return AUBIO_OK;
+}
+
+static smpl_t
+aubio_pitch_check_range (const aubio_pitch_t * p, smpl_t freq)
+{
+  if ((p->min_freq > 0 && freq < p->min_freq)
+      || (p->max_freq > 0 && freq > p->max_freq)) {
+    return 0.;
+  }
+  return freq;
+}
+
 
 /* do method, calling the detection callback, then the conversion callback */
 void
 aubio_pitch_do (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
 {
-  p->detect_cb (p, ibuf, obuf);
+  if (p->frontend_only) {
+    /* nothing to keep the window in */
+    obuf->data[0] = 0.;
+    return;
+  }
+  if (p->buf) {
+    aubio_pitch_slideblock (p, ibuf);
+    p->detect_cb (p, p->buf, obuf);
+  } else {
+    p->detect_cb (p, ibuf, obuf);
+  }
   if (aubio_silence_detection(ibuf, p->silence) == 1) {
     obuf->data[0] = 0.;
   }
+  obuf->data[0] = aubio_pitch_check_range (p, obuf->data[0]);
+  obuf->data[0] = p->conv_cb (obuf->data[0], p->samplerate, p->bufsize);
+}
+
+/* same as aubio_pitch_do, reading frame and spectrum from a front-end */
+void
+aubio_pitch_do_frontend (aubio_pitch_t * p, aubio_frontend_t * f, fvec_t * obuf)
+{
+  fvec_t hop, frame;
+  const cvec_t *spectrum;
+  smpl_t period;
+  aubio_frontend_get_hop (f, &hop);
+  switch (p->type) {
+    case aubio_pitcht_mcomb:
+    case aubio_pitcht_yinfft:
+      if (!aubio_frontend_has_spectrum (f, p->bufsize)) goto fallback;
+      break;
+    default:
+      if (aubio_frontend_get_frame (f, p->bufsize, &frame) != AUBIO_OK)
+        goto fallback;
+      break;
+  }
+  if (aubio_frontend_get_db_spl (f) < p->silence) {
+    /* silent hops have no pitch, skip the detection */
+    obuf->data[0] = 0.;
+  } else switch (p->type) {
+    case aubio_pitcht_mcomb:
+      spectrum = aubio_frontend_get_spectrum (f, p->bufsize, 1);
+      aubio_pitchmcomb_do (p->p_object, spectrum, obuf);
+      obuf->data[0] = aubio_bintofreq (obuf->data[0], p->samplerate, p->bufsize);
+      break;
+    case aubio_pitcht_yinfft:
+      spectrum = aubio_frontend_get_spectrum (f, p->bufsize, 0);
+      aubio_pitchyinfft_do_spectrum (p->p_object, spectrum, obuf);
+      period = obuf->data[0];
+      obuf->data[0] = period > 0 ? p->samplerate / period : 0.;
+      break;
+    default:
+      p->detect_cb (p, &frame, obuf);
+      break;
+  }
+  obuf->data[0] = aubio_pitch_check_range (p, obuf->data[0]);
   obuf->data[0] = p->conv_cb (obuf->data[0], p->samplerate, p->bufsize);
+  return;
+
+fallback:
+  /* window not available from this front-end */
+  aubio_pitch_do (p, &hop, obuf);
+}
+
+uint_t
+aubio_pitch_do_multi_frontend (aubio_pitch_t * p, aubio_frontend_t * f,
+    fvec_t * obuf)
+{
+  uint_t i, n = 0, found;
+  fvec_zeros (obuf);
+  if (p->type != aubio_pitcht_mcomb
+      || !aubio_frontend_has_spectrum (f, p->bufsize)) {
+    /* one note at most with the other methods */
+    aubio_pitch_do_frontend (p, f, obuf);
+    return obuf->data[0] > 0. ? 1 : 0;
+  }
+  if (aubio_frontend_get_db_spl (f) < p->silence) return 0;
+  found = aubio_pitchmcomb_do_multi (p->p_object,
+      aubio_frontend_get_spectrum (f, p->bufsize, 1), obuf);
+  /* keep the notes in range, strongest first still */
+  for (i = 0; i < found; i++) {
+    smpl_t freq = aubio_bintofreq (obuf->data[i], p->samplerate, p->bufsize);
+    freq = aubio_pitch_check_range (p, freq);
+    obuf->data[i] = 0.;
+    if (freq > 0.)
+      obuf->data[n++] = p->conv_cb (freq, p->samplerate, p->bufsize);
+  }
+  return n;
 }
 
 /* do method for each algorithm */
@@ -368,8 +614,35 @@ void
 aubio_pitch_do_yin (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
 {
   smpl_t pitch = 0.;
-  aubio_pitch_slideblock (p, ibuf);
-  aubio_pitchyin_do (p->p_object, p->buf, obuf);
+  aubio_pitchyin_do (p->p_object, ibuf, obuf);
+  pitch = obuf->data[0];
+  if (pitch > 0) {
+    pitch = p->samplerate / (pitch + 0.);
+  } else {
+    pitch = 0.;
+  }
+  obuf->data[0] = pitch;
+}
+
+void
+aubio_pitch_do_yinfast (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
+{
+  smpl_t pitch = 0.;
+  aubio_pitchyinfast_do (p->p_object, ibuf, obuf);
+  pitch = obuf->data[0];
+  if (pitch > 0) {
+    pitch = p->samplerate / (pitch + 0.);
+  } else {
+    pitch = 0.;
+  }
+  obuf->data[0] = pitch;
+}
+
+void
+aubio_pitch_do_yindec (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
+{
+  smpl_t pitch = 0.;
+  aubio_pitchyindec_do (p->p_object, ibuf, obuf);
   pitch = obuf->data[0];
   if (pitch > 0) {
     pitch = p->samplerate / (pitch + 0.);
@@ -379,13 +652,17 @@ aubio_pitch_do_yin (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
   obuf->data[0] = pitch;
 }
 
+void
+aubio_pitch_do_goertzel (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
+{
+  aubio_pitchgoertzel_do (p->p_object, ibuf, obuf);
+}
 
 void
 aubio_pitch_do_yinfft (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * obuf)
 {
   smpl_t pitch = 0.;
-  aubio_pitch_slideblock (p, ibuf);
-  aubio_pitchyinfft_do (p->p_object, p->buf, obuf);
+  aubio_pitchyinfft_do (p->p_object, ibuf, obuf);
   pitch = obuf->data[0];
   if (pitch > 0) {
     pitch = p->samplerate / (pitch + 0.);
@@ -399,8 +676,7 @@ void
 aubio_pitch_do_specacf (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
 {
   smpl_t pitch = 0., period;
-  aubio_pitch_slideblock (p, ibuf);
-  aubio_pitchspecacf_do (p->p_object, p->buf, out);
+  aubio_pitchspecacf_do (p->p_object, ibuf, out);
   //out->data[0] = aubio_bintofreq (out->data[0], p->samplerate, p->bufsize);
   period = out->data[0];
   if (period > 0) {
@@ -414,8 +690,7 @@ aubio_pitch_do_specacf (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
 void
 aubio_pitch_do_fcomb (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
 {
-  aubio_pitch_slideblock (p, ibuf);
-  aubio_pitchfcomb_do (p->p_object, p->buf, out);
+  aubio_pitchfcomb_do (p->p_object, ibuf, out);
   out->data[0] = aubio_bintofreq (out->data[0], p->samplerate, p->bufsize);
 }
 
@@ -423,8 +698,7 @@ void
 aubio_pitch_do_schmitt (aubio_pitch_t * p, const fvec_t * ibuf, fvec_t * out)
 {
   smpl_t period, pitch = 0.;
-  aubio_pitch_slideblock (p, ibuf);
-  aubio_pitchschmitt_do (p->p_object, p->buf, out);
+  aubio_pitchschmitt_do (p->p_object, ibuf, out);
   period = out->data[0];
   if (period > 0) {
     pitch = p->samplerate / period;
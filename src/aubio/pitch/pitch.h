@@ -81,6 +81,24 @@ extern "C" {
 
   see http://recherche.ircam.fr/equipes/pcm/pub/people/cheveign.html
 
+  \b \p yinfast : YIN algorithm (accelerated)
+
+  Same difference function and period selection as \p yin, with the
+  autocorrelation term computed through an FFT, in O(N log N) instead of
+  O(N^2).
+
+  \b \p yindec : YIN algorithm (decimated)
+
+  The period is looked for with \p yin on the signal decimated by a cascade
+  of half-band filters, then refined on a few lags at the full rate (see
+  pitch/pitchyindec.h). Meant for the long windows of low notes.
+
+  \b \p goertzel : Goertzel filter bank
+
+  The energy is measured at each MIDI note only, by Goertzel resonators on
+  windows of a few periods of the note, and the note whose harmonics hold
+  the most of it is picked (see pitch/pitchgoertzel.h).
+
   \b \p yinfft : Yinfft algorithm
 
   This algorithm was derived from the YIN algorithm. In this implementation, a
@@ -109,6 +127,45 @@ typedef struct _aubio_pitch_t aubio_pitch_t;
 */
 void aubio_pitch_do (aubio_pitch_t * o, const fvec_t * in, fvec_t * out);
 
+/** execute pitch detection on the latest frame of a front-end
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+  \param f front-end, already fed with the current hop by aubio_frontend_do()
+  \param out output pitch candidates of size [1]
+
+  The analysis frame is read from `f` instead of being accumulated by `o`.
+  `mcomb` and `yinfft` also reuse the spectrum of `f` if one was prepared
+  for `buf_size` with aubio_frontend_add_spectrum(). If `f` can not provide
+  a frame of `buf_size` samples, this falls back to aubio_pitch_do() on the
+  latest hop. Calls to aubio_pitch_do() on the same object do not mix with
+  this one, see frontend.h.
+
+  Hops quieter than the silence threshold, see aubio_pitch_set_silence(),
+  give a pitch of 0 without running the detection.
+
+*/
+void aubio_pitch_do_frontend (aubio_pitch_t * o, aubio_frontend_t * f,
+    fvec_t * out);
+
+/** execute polyphonic pitch detection on the latest frame of a front-end
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+  \param f front-end, already fed with the current hop by aubio_frontend_do()
+  \param out output pitches, strongest first, and zeros after them; its
+  length is the largest number of notes looked for
+
+  With `mcomb`, and a spectrum of `buf_size` prepared in `f`, the notes are
+  found one after the other by aubio_pitchmcomb_do_multi(), each costing
+  about one single pitch detection. Other methods find one note at most, as
+  aubio_pitch_do_frontend() would. Notes out of the range set with
+  aubio_pitch_set_range() are left out, and silent hops have none.
+
+  \return number of pitches found
+
+*/
+uint_t aubio_pitch_do_multi_frontend (aubio_pitch_t * o, aubio_frontend_t * f,
+    fvec_t * out);
+
 /** change yin or yinfft tolerance threshold
 
   \param o pitch detection object as returned by new_aubio_pitch()
@@ -137,6 +194,25 @@ void del_aubio_pitch (aubio_pitch_t * o);
 aubio_pitch_t *new_aubio_pitch (const char_t * method,
     uint_t buf_size, uint_t hop_size, uint_t samplerate);
 
+/** creation of a pitch detection object run on a front-end only
+
+  \param method set pitch detection algorithm
+  \param buf_size size of the frames read from the front-end
+  \param hop_size step size between two consecutive analysis instant
+  \param samplerate sampling rate of the signal
+
+  Same as new_aubio_pitch(), without the window the object would otherwise
+  keep, nor, for `mcomb`, its phase vocoder and C-weighting filter. It is
+  meant for aubio_pitch_do_frontend() on a front-end that holds frames of
+  `buf_size` and, for `mcomb` and `yinfft`, their spectrum; otherwise, as
+  with aubio_pitch_do(), it gives no pitch.
+
+  \return newly created ::aubio_pitch_t
+
+*/
+aubio_pitch_t *new_aubio_pitch_frontend (const char_t * method,
+    uint_t buf_size, uint_t hop_size, uint_t samplerate);
+
 /** set the output unit of the pitch detection object
 
   \param o pitch detection object as returned by new_aubio_pitch()
@@ -166,6 +242,24 @@ uint_t aubio_pitch_set_silence (aubio_pitch_t * o, smpl_t silence);
 */
 smpl_t aubio_pitch_get_silence (aubio_pitch_t * o);
 
+/** set the range of pitches looked for
+
+  \param o pitch detection object as returned by new_aubio_pitch()
+  \param min_freq lowest pitch, in Hz, 0 for no lower bound [default 0]
+  \param max_freq highest pitch, in Hz, 0 for no upper bound [default 0]
+
+  The range is turned into the periods searched by `yin`, `yinfast`,
+  `yindec`, `yinfft` and `specacf`, into the fundamental bins searched by
+  `fcomb` and `mcomb`, and into the notes `goertzel` runs filters for: work
+  on the pitches out of the range is skipped, and so are the octave errors
+  they would cause. Pitches found out of the range, with any method, give 0.
+
+  \return 0 if successfull, non-zero otherwise
+
+*/
+uint_t aubio_pitch_set_range (aubio_pitch_t * o, smpl_t min_freq,
+    smpl_t max_freq);
+
 /** get the current confidence
 
   \param o pitch detection object as returned by new_aubio_pitch()
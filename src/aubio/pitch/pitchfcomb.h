@@ -54,6 +54,22 @@ typedef struct _aubio_pitchfcomb_t aubio_pitchfcomb_t;
 void aubio_pitchfcomb_do (aubio_pitchfcomb_t * p, const fvec_t * input,
     fvec_t * output);
 
+/** restrict the fundamentals looked for
+
+  \param p pitch detection object as returned by new_aubio_pitchfcomb
+  \param min_bin lowest fundamental, in bins [default 0]
+  \param max_bin highest fundamental, in bins [default buf_size/2]
+
+  Only the bins up to 5 times max_bin, where the strongest harmonics of
+  those fundamentals are, are converted to norm and phase, and peaks are
+  looked for from min_bin on.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchfcomb_set_bin_range (aubio_pitchfcomb_t * p,
+    uint_t min_bin, uint_t max_bin);
+
 /** creation of the pitch detection object
 
   \param buf_size size of the input buffer to analyse
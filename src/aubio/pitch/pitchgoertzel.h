@@ -0,0 +1,107 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Pitch detection using a bank of Goertzel filters on the MIDI notes
+
+  Instead of a full spectrum, the energy of the input is only measured at
+  the frequency of each MIDI note, with one Goertzel resonator per note. Each
+  note looks at the end of the buffer over a whole number of its periods,
+  up to 17, so that the windows keep about a semitone of resolution: a
+  constant-Q filter bank. The resonators of several notes run side by side
+  in the vector kernels, see aubio_simd_t.
+
+  The note whose first harmonics hold the most energy is picked, and its
+  frequency is refined from the phase its resonator turns by over one
+  period.
+
+  Brown, J. C., Puckette, M. S. (1992) "An efficient algorithm for the
+  calculation of a constant Q transform", J. Acoust. Soc. Am. 92, 2698-2701.
+
+*/
+
+#ifndef AUBIO_PITCHGOERTZEL_H
+#define AUBIO_PITCHGOERTZEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** pitch detection object */
+typedef struct _aubio_pitchgoertzel_t aubio_pitchgoertzel_t;
+
+/** creation of the pitch detection object
+
+  \param buf_size size of the input buffer to analyse
+  \param samplerate samplerate of the input, to place the notes
+
+  Notes with less than two periods in the buffer, or too close to the
+  Nyquist frequency, are left out.
+
+*/
+aubio_pitchgoertzel_t *new_aubio_pitchgoertzel (uint_t buf_size,
+    uint_t samplerate);
+
+/** deletion of the pitch detection object
+
+  \param o pitch detection object as returned by new_aubio_pitchgoertzel()
+
+*/
+void del_aubio_pitchgoertzel (aubio_pitchgoertzel_t * o);
+
+/** execute pitch detection on an input buffer
+
+  \param o pitch detection object as returned by new_aubio_pitchgoertzel()
+  \param samples_in input signal vector (length as specified at creation time)
+  \param cands_out pitch candidate, in Hz, 0 if none was found
+
+*/
+void aubio_pitchgoertzel_do (aubio_pitchgoertzel_t * o,
+    const fvec_t * samples_in, fvec_t * cands_out);
+
+/** restrict the notes looked for
+
+  \param o pitch detection object as returned by new_aubio_pitchgoertzel()
+  \param min_note lowest MIDI note [default 0]
+  \param max_note highest MIDI note [default 127]
+
+  Only the filters of the notes in the range and of their harmonics are
+  run.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchgoertzel_set_note_range (aubio_pitchgoertzel_t * o,
+    uint_t min_note, uint_t max_note);
+
+/** get the current confidence
+
+  \param o pitch detection object as returned by new_aubio_pitchgoertzel()
+  \return share of the energy of the bank in the harmonics of the note found
+
+*/
+smpl_t aubio_pitchgoertzel_get_confidence (aubio_pitchgoertzel_t * o);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_PITCHGOERTZEL_H */
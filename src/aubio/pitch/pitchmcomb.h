@@ -55,6 +55,59 @@ typedef struct _aubio_pitchmcomb_t aubio_pitchmcomb_t;
 void aubio_pitchmcomb_do (aubio_pitchmcomb_t * p, const cvec_t * in_fftgrain,
     fvec_t * out_cands);
 
+/** execute polyphonic pitch detection on an input spectral frame
+
+  \param p pitch detection object as returned by new_aubio_pitchmcomb
+  \param in_fftgrain input signal spectrum as computed by aubio_pvoc_do
+  \param out_cands output vector, filled with the fundamental of each note
+  found, in bins, strongest first, and zeros after them; its length is the
+  largest number of notes looked for
+
+  The strongest comb is picked, much as aubio_pitchmcomb_do() would, then
+  its partials are taken out of the spectrum and the search starts over on
+  what is left, until `out_cands->length` notes have been looked for or the
+  strongest comb left is weaker than the threshold, see
+  aubio_pitchmcomb_set_poly_threshold(). Each pass costs about one run of
+  aubio_pitchmcomb_do(), and there are `out_cands->length` of them at most.
+
+  Klapuri, A. (2003) "Multiple fundamental frequency estimation based on
+  harmonicity and spectral smoothness", IEEE Transactions on Speech and
+  Audio Processing 11(6), 804-816.
+
+  \return number of notes found
+
+*/
+uint_t aubio_pitchmcomb_do_multi (aubio_pitchmcomb_t * p,
+    const cvec_t * in_fftgrain, fvec_t * out_cands);
+
+/** set the threshold of the polyphonic search
+
+  \param p pitch detection object as returned by new_aubio_pitchmcomb
+  \param threshold energy of the weakest comb kept, relative to the first
+  one [default 0.5]
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchmcomb_set_poly_threshold (aubio_pitchmcomb_t * p,
+    smpl_t threshold);
+
+/** restrict the fundamentals looked for
+
+  \param p pitch detection object as returned by new_aubio_pitchmcomb
+  \param min_bin lowest fundamental, in bins [default 0]
+  \param max_bin highest fundamental, in bins [default buf_size/2]
+
+  The spectrum is flattened and its peaks are picked up to 5 times max_bin
+  only, where the combs of those fundamentals end, and the combs of the
+  candidates out of the range are skipped.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchmcomb_set_bin_range (aubio_pitchmcomb_t * p,
+    uint_t min_bin, uint_t max_bin);
+
 /** creation of the pitch detection object
 
   \param buf_size size of the input buffer to analyse
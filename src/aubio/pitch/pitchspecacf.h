@@ -78,6 +78,18 @@ void del_aubio_pitchspecacf (aubio_pitchspecacf_t * o);
 */
 smpl_t aubio_pitchspecacf_get_tolerance (const aubio_pitchspecacf_t * o);
 
+/** restrict the periods looked for
+
+  \param o pitch detection object
+  \param min_lag shortest period, in samples [default 0]
+  \param max_lag longest period, in samples [default buf_size]
+
+  \return `1` on error, `0` on success
+
+*/
+uint_t aubio_pitchspecacf_set_lag_range (aubio_pitchspecacf_t * o,
+    uint_t min_lag, uint_t max_lag);
+
 /** set tolerance parameter for `specacf` pitch detection object
 
   \param o pitch detection object
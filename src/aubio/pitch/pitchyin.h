@@ -69,6 +69,39 @@ void del_aubio_pitchyin (aubio_pitchyin_t * o);
 void aubio_pitchyin_do (aubio_pitchyin_t * o, const fvec_t * samples_in, fvec_t * cands_out);
 
 
+/** compute the difference function incrementally, hop by hop
+
+  \param o YIN pitch detection object
+  \param hopsize samples between the starts of consecutive input buffers, 0
+  to compute each buffer alone [default 0]
+
+  Half of the buffer size must be a multiple of hopsize. The difference
+  function is then kept for each hop of the window, and only the newest hop
+  is computed when an input buffer is the previous one moved by hopsize, in
+  hopsize x buf_size/2 operations instead of (buf_size/2)^2. Other buffers
+  are computed whole.
+
+  \return 0 if successful, non-zero otherwise, in which case each buffer
+  is computed alone
+
+*/
+uint_t aubio_pitchyin_set_hopsize (aubio_pitchyin_t * o, uint_t hopsize);
+
+/** restrict the periods looked for
+
+  \param o YIN pitch detection object
+  \param min_lag shortest period, in samples [default 0]
+  \param max_lag longest period, in samples [default buf_size/2 - 1]
+
+  The difference function is not computed past a few lags after max_lag,
+  and no period under min_lag is taken, even when it has a deeper dip.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchyin_set_lag_range (aubio_pitchyin_t * o, uint_t min_lag,
+    uint_t max_lag);
+
 /** set tolerance parameter for YIN algorithm
 
   \param o YIN pitch detection object
@@ -0,0 +1,129 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Pitch detection using the YIN algorithm on a decimated signal
+
+  The input buffer is low-passed and decimated by a cascade of polyphase
+  half-band filters, down to about 11 kHz at 44.1 kHz. The period is looked
+  for on the decimated signal with the YIN cumulative mean normalised
+  difference function, as in aubio_pitchyin_do(). The difference function is
+  then computed at the full rate, on a few lags around that period only, to
+  get back the resolution lost to the decimation.
+
+  With a decimation by D, the search costs about 1/D^2 of the full rate
+  one, which matters most for the long windows needed by low notes.
+
+  De Cheveigné, A., Kawahara, H. (2002) "YIN, a fundamental frequency
+  estimator for speech and music", J. Acoust. Soc. Am. 111, 1917-1930.
+
+*/
+
+#ifndef AUBIO_PITCHYINDEC_H
+#define AUBIO_PITCHYINDEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** pitch detection object */
+typedef struct _aubio_pitchyindec_t aubio_pitchyindec_t;
+
+/** creation of the pitch detection object
+
+  \param buf_size size of the input buffer to analyse
+  \param samplerate samplerate of the input, to choose the decimation
+
+*/
+aubio_pitchyindec_t *new_aubio_pitchyindec (uint_t buf_size,
+    uint_t samplerate);
+
+/** deletion of the pitch detection object
+
+  \param o pitch detection object as returned by new_aubio_pitchyindec()
+
+*/
+void del_aubio_pitchyindec (aubio_pitchyindec_t * o);
+
+/** execute pitch detection on an input buffer
+
+  \param o pitch detection object as returned by new_aubio_pitchyindec()
+  \param samples_in input signal vector (length as specified at creation time)
+  \param cands_out pitch period candidates, in samples at the full rate
+
+*/
+void aubio_pitchyindec_do (aubio_pitchyindec_t * o, const fvec_t * samples_in,
+    fvec_t * cands_out);
+
+/** get the decimation factor
+
+  \param o pitch detection object as returned by new_aubio_pitchyindec()
+  \return ratio of the input samplerate to the one the period is looked for at
+
+*/
+uint_t aubio_pitchyindec_get_decimation (const aubio_pitchyindec_t * o);
+
+/** restrict the periods looked for
+
+  \param o pitch detection object as returned by new_aubio_pitchyindec()
+  \param min_lag shortest period, in samples at the full rate [default 0]
+  \param max_lag longest period, in samples at the full rate [default
+  buf_size/2]
+
+  The input is not decimated when the whole range is below the periods
+  searched at the full rate, and the decimated difference function is only
+  computed up to max_lag.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchyindec_set_lag_range (aubio_pitchyindec_t * o,
+    uint_t min_lag, uint_t max_lag);
+
+/** set tolerance parameter for YIN algorithm
+
+  \param o YIN pitch detection object
+  \param tol tolerance parameter for minima selection [default 0.15]
+
+*/
+uint_t aubio_pitchyindec_set_tolerance (aubio_pitchyindec_t * o, smpl_t tol);
+
+/** get tolerance parameter for YIN algorithm
+
+  \param o YIN pitch detection object
+  \return tolerance parameter for minima selection [default 0.15]
+
+*/
+smpl_t aubio_pitchyindec_get_tolerance (aubio_pitchyindec_t * o);
+
+/** get current confidence of YIN algorithm
+
+  \param o YIN pitch detection object
+  \return confidence parameter
+
+*/
+smpl_t aubio_pitchyindec_get_confidence (aubio_pitchyindec_t * o);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_PITCHYINDEC_H */
@@ -53,6 +53,16 @@ typedef struct _aubio_pitchyinfft_t aubio_pitchyinfft_t;
 
 */
 void aubio_pitchyinfft_do (aubio_pitchyinfft_t * o, const fvec_t * samples_in, fvec_t * cands_out);
+/** execute pitch detection on a spectrum
+
+  \param o pitch detection object as returned by new_aubio_pitchyinfft
+  \param spectrum norm of the `hanningz` windowed input, as computed by
+  aubio_pvoc_do() or aubio_frontend_get_spectrum(); the phase is not used
+  \param cands_out pitch period candidates, in samples
+
+*/
+void aubio_pitchyinfft_do_spectrum (aubio_pitchyinfft_t * o,
+    const cvec_t * spectrum, fvec_t * cands_out);
 /** creation of the pitch detection object
 
   \param samplerate samplerate of the input signal
@@ -84,6 +94,21 @@ smpl_t aubio_pitchyinfft_get_tolerance (aubio_pitchyinfft_t * o);
 */
 uint_t aubio_pitchyinfft_set_tolerance (aubio_pitchyinfft_t * o, smpl_t tol);
 
+/** restrict the periods looked for
+
+  \param o YIN pitch detection object
+  \param min_lag shortest period, in samples [default 0]
+  \param max_lag longest period, in samples [default buf_size/2]
+
+  The spectrum is weighted and transformed whole, the difference function
+  is only built up to max_lag. The octave check does not go under min_lag.
+
+  \return 0 if successful, non-zero otherwise
+
+*/
+uint_t aubio_pitchyinfft_set_lag_range (aubio_pitchyinfft_t * o,
+    uint_t min_lag, uint_t max_lag);
+
 /** get current confidence of YIN algorithm
 
   \param o YIN pitch detection object
@@ -28,10 +28,13 @@
 #include "pitch/pitchfcomb.h"
 
 #define MAX_PEAKS 8
+/* highest harmonic of the fundamental the strongest peak may be */
+#define MAX_HARMONIC 5
 
 typedef struct
 {
   smpl_t bin;
+  smpl_t mag;
   smpl_t db;
 } aubio_fpeak_t;
 
@@ -41,10 +44,12 @@ struct _aubio_pitchfcomb_t
   uint_t stepSize;
   uint_t rate;
   fvec_t *winput;
-  fvec_t *win;
+  const fvec_t *win;
   cvec_t *fftOut;
   fvec_t *fftLastPhase;
   aubio_fft_t *fft;
+  uint_t min_bin;           /**< lowest fundamental looked for */
+  uint_t max_bin;           /**< highest fundamental looked for */
 };
 
 aubio_pitchfcomb_t *
@@ -57,32 +62,49 @@ new_aubio_pitchfcomb (uint_t bufsize, uint_t hopsize)
   p->fftOut = new_cvec (bufsize);
   p->fftLastPhase = new_fvec (bufsize);
   p->fft = new_aubio_fft (bufsize);
-  p->win = new_aubio_window ("hanning", bufsize);
+  p->win = aubio_window_acquire ("hanning", bufsize);
+  aubio_pitchfcomb_set_bin_range (p, 0, bufsize / 2);
   return p;
 }
 
+uint_t
+aubio_pitchfcomb_set_bin_range (aubio_pitchfcomb_t * p, uint_t min_bin,
+    uint_t max_bin)
+{
+  p->max_bin = MIN (max_bin, p->fftSize / 2);
+  p->min_bin = MIN (min_bin, p->max_bin);
+  return AUBIO_OK;
+}
+
 /* input must be stepsize long */
 void
 aubio_pitchfcomb_do (aubio_pitchfcomb_t * p, const fvec_t * input, fvec_t * output)
 {
   uint_t k, l, maxharm = 0;
+  /* the strongest peak is the fundamental or one of its first harmonics,
+   * other bins are not looked at; their phases are not kept either, which
+   * spoils the first frame after the range is widened */
+  uint_t first = p->min_bin > 0 ? p->min_bin - 1 : 0;
+  uint_t last = MIN (p->fftSize / 2, MAX_HARMONIC * p->max_bin + 1);
   smpl_t phaseDifference = TWO_PI * (smpl_t) p->stepSize / (smpl_t) p->fftSize;
   aubio_fpeak_t peaks[MAX_PEAKS];
 
+  /* peaks are ranked on their linear magnitude, which orders them as their
+   * level in dB would; -200 dB is the smallest level kept */
   for (k = 0; k < MAX_PEAKS; k++) {
     peaks[k].db = -200.;
+    peaks[k].mag = 1.e-10 * (smpl_t) p->fftSize / 2.;
     peaks[k].bin = 0.;
   }
 
   for (k = 0; k < input->length; k++) {
     p->winput->data[k] = p->win->data[k] * input->data[k];
   }
-  aubio_fft_do (p->fft, p->winput, p->fftOut);
+  aubio_fft_do_bins (p->fft, p->winput, p->fftOut, last + 1);
 
-  for (k = 0; k <= p->fftSize / 2; k++) {
+  for (k = first; k <= last; k++) {
     smpl_t
-        magnitude =
-        20. * LOG10 (2. * p->fftOut->norm[k] / (smpl_t) p->fftSize),
+        magnitude = p->fftOut->norm[k],
         phase = p->fftOut->phas[k], tmp, bin;
 
     /* compute phase difference */
@@ -101,17 +123,22 @@ aubio_pitchfcomb_do (aubio_pitchfcomb_t * p, const fvec_t * input, fvec_t * outp
     /* compute the k-th partials' true bin */
     bin = (smpl_t) k + tmp;
 
-    if (bin > 0.0 && magnitude > peaks[0].db) {       // && magnitude < 0) {
+    if (bin > 0.0 && magnitude > peaks[0].mag) {       // && magnitude < 0) {
       memmove (peaks + 1, peaks, sizeof (aubio_fpeak_t) * (MAX_PEAKS - 1));
       peaks[0].bin = bin;
-      peaks[0].db = magnitude;
+      peaks[0].mag = magnitude;
     }
   }
 
+  /* convert the peaks found to dB */
+  for (l = 0; l < MAX_PEAKS && peaks[l].bin > 0.0; l++) {
+    peaks[l].db = 20. * LOG10 (2. * peaks[l].mag / (smpl_t) p->fftSize);
+  }
+
   k = 0;
   for (l = 1; l < MAX_PEAKS && peaks[l].bin > 0.0; l++) {
     sint_t harmonic;
-    for (harmonic = 5; harmonic > 1; harmonic--) {
+    for (harmonic = MAX_HARMONIC; harmonic > 1; harmonic--) {
       if (peaks[0].bin / peaks[l].bin < harmonic + .02 &&
           peaks[0].bin / peaks[l].bin > harmonic - .02) {
         if (harmonic > (sint_t) maxharm && peaks[0].db < peaks[l].db / 2) {
@@ -132,7 +159,7 @@ del_aubio_pitchfcomb (aubio_pitchfcomb_t * p)
 {
   del_cvec (p->fftOut);
   del_fvec (p->fftLastPhase);
-  del_fvec (p->win);
+  aubio_window_release (p->win);
   del_fvec (p->winput);
   del_aubio_fft (p->fft);
   AUBIO_FREE (p);
@@ -0,0 +1,191 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "mathutils.h"
+#include "musicutils.h"
+#include "simd.h"
+#include "pitch/pitchgoertzel.h"
+
+#define AUBIO_GOERTZEL_NOTES 128
+/* a rectangular window of Q periods has its first nulls 1/Q away from the
+ * note, about a semitone for Q = 17; being a whole number of periods, it also
+ * has nulls on all the harmonics of the note */
+#define AUBIO_GOERTZEL_PERIODS 17
+/* notes above this fraction of the samplerate are left out */
+#define AUBIO_GOERTZEL_MAX_FREQ 0.45
+#define AUBIO_GOERTZEL_HARMONICS 6
+
+/* harmonics 1 to 6, in semitones above the fundamental */
+static const uint_t aubio_goertzel_harmonics[AUBIO_GOERTZEL_HARMONICS] = {
+  0, 12, 19, 24, 28, 31
+};
+
+struct _aubio_pitchgoertzel_t
+{
+  uint_t samplerate;
+  uint_t lowest;                              /**< lowest note of the bank */
+  uint_t highest;                             /**< highest note of the bank */
+  uint_t min_note;                            /**< lowest note looked for */
+  uint_t max_note;                            /**< highest note looked for */
+  uint_t first;                               /**< first filter to run */
+  uint_t last;                                /**< last filter to run */
+  smpl_t omega[AUBIO_GOERTZEL_NOTES];         /**< note, in radians/sample */
+  smpl_t coef[AUBIO_GOERTZEL_NOTES];          /**< 2 cos (omega) */
+  uint_t start[AUBIO_GOERTZEL_NOTES];         /**< first sample of the window */
+  uint_t length[AUBIO_GOERTZEL_NOTES];        /**< window length */
+  uint_t delay[AUBIO_GOERTZEL_NOTES];         /**< one period, rounded */
+  smpl_t s1[AUBIO_GOERTZEL_NOTES];            /**< last resonator outputs */
+  smpl_t s2[AUBIO_GOERTZEL_NOTES];
+  smpl_t energy[AUBIO_GOERTZEL_NOTES];        /**< power of each note */
+  smpl_t confidence;
+};
+
+aubio_pitchgoertzel_t *
+new_aubio_pitchgoertzel (uint_t bufsize, uint_t samplerate)
+{
+  aubio_pitchgoertzel_t *o = AUBIO_NEW (aubio_pitchgoertzel_t);
+  uint_t k;
+  if ((sint_t)bufsize < 2) {
+    AUBIO_ERR ("pitchgoertzel: got buffer_size %d, but can not be < 2\n",
+        bufsize);
+    goto beach;
+  }
+  o->samplerate = samplerate;
+  o->lowest = AUBIO_GOERTZEL_NOTES;
+  o->highest = 0;
+  for (k = 0; k < AUBIO_GOERTZEL_NOTES; k++) {
+    smpl_t freq = aubio_miditofreq (k), period = samplerate / freq;
+    smpl_t periods;
+    if (freq >= AUBIO_GOERTZEL_MAX_FREQ * samplerate) break;
+    o->delay[k] = MAX (ROUND (period), 1);
+    if (o->delay[k] >= bufsize) continue;
+    /* the window ends a period before the end of the buffer at most, to
+     * leave room for the one the frequency is refined with */
+    periods = MIN (AUBIO_GOERTZEL_PERIODS, FLOOR ((bufsize - o->delay[k])
+          / period));
+    if (periods < 1) continue;
+    o->lowest = MIN (o->lowest, k);
+    o->highest = k;
+    o->omega[k] = TWO_PI * freq / samplerate;
+    o->coef[k] = 2. * COS (o->omega[k]);
+    o->length[k] = MIN (ROUND (periods * period), bufsize - o->delay[k]);
+    o->start[k] = bufsize - o->length[k];
+  }
+  aubio_pitchgoertzel_set_note_range (o, 0, AUBIO_GOERTZEL_NOTES - 1);
+  return o;
+
+beach:
+  AUBIO_FREE (o);
+  return NULL;
+}
+
+void
+del_aubio_pitchgoertzel (aubio_pitchgoertzel_t * o)
+{
+  AUBIO_FREE (o);
+}
+
+/* frequency of note k from the phase its resonator turns by over one period,
+ * running it again on the window ending a period earlier */
+static smpl_t
+aubio_pitchgoertzel_refine (const aubio_pitchgoertzel_t * o,
+    const fvec_t * input, uint_t k)
+{
+  uint_t i, d = o->delay[k];
+  const smpl_t *x = input->data + o->start[k] - d;
+  smpl_t c = o->coef[k], w = o->omega[k], a = 0., b = 0., s;
+  smpl_t re_a, im_a, re_b, im_b, dphi;
+  for (i = 0; i < o->length[k]; i++) {
+    s = x[i] + c * a - b;
+    b = a;
+    a = s;
+  }
+  /* spectrum of each window, s1 - exp(-jw) s2 */
+  re_a = o->s1[k] - COS (w) * o->s2[k];
+  im_a = SIN (w) * o->s2[k];
+  re_b = a - COS (w) * b;
+  im_b = SIN (w) * b;
+  /* the current window turned by w0 d from the earlier one */
+  dphi = ATAN2 (im_a * re_b - re_a * im_b, re_a * re_b + im_a * im_b);
+  dphi = aubio_unwrap2pi (dphi - w * d);
+  return (w + dphi / d) * o->samplerate / TWO_PI;
+}
+
+void
+aubio_pitchgoertzel_do (aubio_pitchgoertzel_t * o, const fvec_t * input,
+    fvec_t * out)
+{
+  uint_t k, h, best = 0, from, to;
+  smpl_t total = 0., salience, best_salience = 0., harmonics = 0.;
+  out->data[0] = 0.;
+  o->confidence = 0.;
+  if (o->first > o->last) return;
+  aubio_simd->goertzel (input->data, input->length, o->coef + o->first,
+      o->start + o->first, o->s1 + o->first, o->s2 + o->first,
+      o->last + 1 - o->first);
+  for (k = o->first; k <= o->last; k++) {
+    smpl_t s1 = o->s1[k], s2 = o->s2[k];
+    /* |s1 - exp(-jw) s2|^2, per sample of the window */
+    o->energy[k] = MAX (SQR (s1) + SQR (s2) - o->coef[k] * s1 * s2, 0.)
+      / SQR ((smpl_t)o->length[k]);
+    total += o->energy[k];
+  }
+  from = MAX (o->min_note, o->first);
+  to = MIN (o->max_note, o->last);
+  for (k = from; k <= to; k++) {
+    salience = 0.;
+    for (h = 0; h < AUBIO_GOERTZEL_HARMONICS; h++) {
+      if (k + aubio_goertzel_harmonics[h] > o->last) break;
+      salience += o->energy[k + aubio_goertzel_harmonics[h]] / (h + 1);
+    }
+    if (salience > best_salience) {
+      best_salience = salience;
+      best = k;
+    }
+  }
+  if (best_salience <= 0.) return;
+  for (h = 0; h < AUBIO_GOERTZEL_HARMONICS; h++) {
+    if (best + aubio_goertzel_harmonics[h] > o->last) break;
+    harmonics += o->energy[best + aubio_goertzel_harmonics[h]];
+  }
+  o->confidence = harmonics / total;
+  out->data[0] = aubio_pitchgoertzel_refine (o, input, best);
+}
+
+uint_t
+aubio_pitchgoertzel_set_note_range (aubio_pitchgoertzel_t * o,
+    uint_t min_note, uint_t max_note)
+{
+  o->max_note = MIN (max_note, AUBIO_GOERTZEL_NOTES - 1);
+  o->min_note = MIN (min_note, o->max_note);
+  /* the notes looked for, and the harmonics of the highest one */
+  o->first = MAX (o->min_note, o->lowest);
+  o->last = MIN (o->max_note + aubio_goertzel_harmonics
+      [AUBIO_GOERTZEL_HARMONICS - 1], o->highest);
+  return AUBIO_OK;
+}
+
+smpl_t
+aubio_pitchgoertzel_get_confidence (aubio_pitchgoertzel_t * o)
+{
+  return o->confidence;
+}
@@ -25,11 +25,20 @@
 #include "pitch/pitchmcomb.h"
 
 #define CAND_SWAP(a,b) { register aubio_spectralcandidate_t *t=(a);(a)=(b);(b)=t; }
+/* bins taken out of the residual on each side of a partial, the main lobe
+ * of the Hann window */
+#define AUBIO_MCOMB_PARTIAL_WIDTH 2
+/* notes closer than a bin or a quarter tone are taken for the same */
+#define AUBIO_MCOMB_QUARTERTONE_UP 1.0293
+#define AUBIO_MCOMB_QUARTERTONE_DOWN 0.9715
+/* how much stronger than a higher comb a lower one has to be in the
+ * polyphonic search */
+#define AUBIO_MCOMB_LOWER_BIAS 1.3
 
 typedef struct _aubio_spectralpeak_t aubio_spectralpeak_t;
 typedef struct _aubio_spectralcandidate_t aubio_spectralcandidate_t;
 uint_t aubio_pitchmcomb_get_root_peak (aubio_spectralpeak_t * peaks,
-    uint_t length);
+    uint_t length, smpl_t min_bin, smpl_t max_bin);
 uint_t aubio_pitchmcomb_quadpick (aubio_spectralpeak_t * spectral_peaks,
     const fvec_t * X);
 void aubio_pitchmcomb_spectral_pp (aubio_pitchmcomb_t * p, const fvec_t * oldmag);
@@ -74,8 +83,14 @@ struct _aubio_pitchmcomb_t
   fvec_t *scratch;                         /**< vec to store modified mag            */
   fvec_t *scratch2;                        /**< vec to compute moving median         */
   fvec_t *theta;                          /**< vec to store phase                     */
+  fvec_t *residual;                        /**< spectrum left by the notes found     */
+  fvec_t *partials;                        /**< amplitudes of a note's partials      */
+  smpl_t poly_threshold;                   /**< weakest note kept, relative [0.5]    */
   smpl_t phasediff;
   smpl_t phasefreq;
+  uint_t min_bin;                          /**< lowest fundamental looked for        */
+  uint_t max_bin;                          /**< highest fundamental looked for       */
+  uint_t bins;                             /**< bins the combs can reach             */
   /** threshfn: name or handle of fn for computing adaptive threshold [median] */
   /** aubio_thresholdfn_t thresholdfn; */
   /** picker: name or handle of fn for picking event times [quadpick] */
@@ -105,16 +120,18 @@ aubio_pitchmcomb_do (aubio_pitchmcomb_t * p, const cvec_t * fftgrain, fvec_t * o
 {
   uint_t j;
   smpl_t instfreq;
-  fvec_t *newmag = (fvec_t *) p->newmag;
+  fvec_t newmag;
   //smpl_t hfc; //fe=instfreq(theta1,theta,ops); //theta1=theta;
-  /* copy incoming grain to newmag */
-  for (j = 0; j < newmag->length; j++)
-    newmag->data[j] = fftgrain->norm[j];
+  /* copy the bins the combs can reach to newmag */
+  newmag.data = p->newmag->data;
+  newmag.length = p->bins;
+  for (j = 0; j < newmag.length; j++)
+    newmag.data[j] = fftgrain->norm[j];
   /* detect only if local energy > 10. */
   //if (aubio_level_lin (newmag) * newmag->length > 10.) {
   //hfc = fvec_local_hfc(newmag); //not used
-  aubio_pitchmcomb_spectral_pp (p, newmag);
-  aubio_pitchmcomb_combdet (p, newmag);
+  aubio_pitchmcomb_spectral_pp (p, &newmag);
+  aubio_pitchmcomb_combdet (p, &newmag);
   //aubio_pitchmcomb_sort_cand_freq(p->candidates,p->ncand);
   //return p->candidates[p->goodcandidate]->ebin;
   j = (uint_t) FLOOR (p->candidates[p->goodcandidate]->ebin + .5);
@@ -122,7 +139,7 @@ aubio_pitchmcomb_do (aubio_pitchmcomb_t * p, const cvec_t * fftgrain, fvec_t * o
       - p->theta->data[j] - j * p->phasediff);
   instfreq *= p->phasefreq;
   /* store phase for next run */
-  for (j = 0; j < p->theta->length; j++) {
+  for (j = 0; j < newmag.length; j++) {
     p->theta->data[j] = fftgrain->phas[j];
   }
   //return p->candidates[p->goodcandidate]->ebin;
@@ -133,6 +150,101 @@ aubio_pitchmcomb_do (aubio_pitchmcomb_t * p, const cvec_t * fftgrain, fvec_t * o
      } */
 }
 
+/* take the partials of the fundamental f0 out of the residual; each partial
+ * loses no more than the mean of its amplitude and its neighbours', so that
+ * a partial shared with another note keeps some of its energy for it */
+static void
+aubio_pitchmcomb_subtract (aubio_pitchmcomb_t * p, smpl_t f0, fvec_t * residual)
+{
+  smpl_t *amp = p->partials->data;
+  uint_t h, j, n = 0, length = residual->length;
+  if (f0 < 1.) return;
+  for (h = 1; ROUND (h * f0) + 1 < length && n < p->partials->length; h++) {
+    uint_t b = (uint_t) ROUND (h * f0);
+    amp[n++] = MAX (MAX (residual->data[b - 1], residual->data[b]),
+        residual->data[b + 1]);
+  }
+  for (h = 0; h < n; h++) {
+    uint_t b = (uint_t) ROUND ((h + 1) * f0), from, to;
+    smpl_t smooth = amp[h], count = 1., gain;
+    if (amp[h] <= 0.) continue;
+    if (h > 0) {
+      smooth += amp[h - 1];
+      count++;
+    }
+    if (h + 1 < n) {
+      smooth += amp[h + 1];
+      count++;
+    }
+    gain = 1. - MIN (amp[h], smooth / count) / amp[h];
+    from = b > AUBIO_MCOMB_PARTIAL_WIDTH ? b - AUBIO_MCOMB_PARTIAL_WIDTH : 0;
+    to = MIN (b + AUBIO_MCOMB_PARTIAL_WIDTH + 1, length);
+    for (j = from; j < to; j++)
+      residual->data[j] *= gain;
+  }
+}
+
+uint_t
+aubio_pitchmcomb_do_multi (aubio_pitchmcomb_t * p, const cvec_t * fftgrain,
+    fvec_t * output)
+{
+  uint_t j, v, n = 0;
+  smpl_t first = 0.;
+  fvec_t residual;
+  residual.data = p->residual->data;
+  residual.length = p->bins;
+  for (j = 0; j < residual.length; j++)
+    residual.data[j] = fftgrain->norm[j];
+  fvec_zeros (output);
+  /* one note per pass at most, the strongest comb of what the previous
+   * notes left of the spectrum */
+  for (v = 0; v < output->length; v++) {
+    aubio_spectralcandidate_t *best;
+    smpl_t f0, instfreq;
+    uint_t k, known = 0;
+    aubio_pitchmcomb_spectral_pp (p, &residual);
+    if (p->count == 0) break;
+    aubio_pitchmcomb_combdet (p, &residual);
+    /* the combs go down from the root peak: a lower one has to be clearly
+     * stronger to be picked, and past the first note, to have a peak at its
+     * fundamental, or it would gather the partials left by the others */
+    best = NULL;
+    for (k = 0; k < p->ncand; k++) {
+      aubio_spectralcandidate_t *c = p->candidates[k];
+      if (n > 0 && c->ecomb[0] == 0.) continue;
+      if (!best || c->ene > AUBIO_MCOMB_LOWER_BIAS * best->ene) best = c;
+    }
+    if (!best || best->ene <= 0.) break;
+    if (n == 0) first = best->ene;
+    else if (best->ene < p->poly_threshold * first) break;
+    j = (uint_t) FLOOR (best->ebin + .5);
+    instfreq = aubio_unwrap2pi (fftgrain->phas[j]
+        - p->theta->data[j] - j * p->phasediff);
+    f0 = j + instfreq * p->phasefreq;
+    if (f0 < 1.) f0 = best->ebin;
+    /* what the subtraction left of a note found already is taken out
+     * again, but not reported twice */
+    for (k = 0; k < n; k++) {
+      smpl_t ratio = f0 / output->data[k];
+      if (ABS (f0 - output->data[k]) < 1.
+          || (ratio > AUBIO_MCOMB_QUARTERTONE_DOWN
+            && ratio < AUBIO_MCOMB_QUARTERTONE_UP)) known = 1;
+    }
+    if (!known) output->data[n++] = f0;
+    aubio_pitchmcomb_subtract (p, best->ebin, &residual);
+  }
+  for (j = 0; j < residual.length; j++)
+    p->theta->data[j] = fftgrain->phas[j];
+  return n;
+}
+
+uint_t
+aubio_pitchmcomb_set_poly_threshold (aubio_pitchmcomb_t * p, smpl_t threshold)
+{
+  p->poly_threshold = threshold;
+  return AUBIO_OK;
+}
+
 uint_t
 aubio_pitch_cands (aubio_pitchmcomb_t * p, const cvec_t * fftgrain, smpl_t * cands)
 {
@@ -167,10 +279,12 @@ aubio_pitch_cands (aubio_pitchmcomb_t * p, const cvec_t * fftgrain, smpl_t * can
 void
 aubio_pitchmcomb_spectral_pp (aubio_pitchmcomb_t * p, const fvec_t * newmag)
 {
-  fvec_t *mag = (fvec_t *) p->scratch;
+  fvec_t scratch, *mag = &scratch;
   fvec_t *tmp = (fvec_t *) p->scratch2;
   uint_t j;
-  uint_t length = mag->length;
+  uint_t length = newmag->length;
+  scratch.data = p->scratch->data;
+  scratch.length = length;
   /* copy newmag to mag (scracth) */
   for (j = 0; j < length; j++) {
     mag->data[j] = newmag->data[j];
@@ -221,8 +335,10 @@ aubio_pitchmcomb_combdet (aubio_pitchmcomb_t * p, const fvec_t * newmag)
   uint_t tmpl = 0;
   smpl_t tmpene = 0.;
 
-  /* get the biggest peak in the spectrum */
-  root_peak = aubio_pitchmcomb_get_root_peak (peaks, count);
+  /* get the biggest peak in the spectrum, that is one of the first
+   * harmonics of a fundamental looked for */
+  root_peak = aubio_pitchmcomb_get_root_peak (peaks, count,
+      p->min_bin, M * p->max_bin);
   /* not enough partials in highest notes, could be forced */
   //if (peaks[root_peak].ebin >= aubio_miditofreq(85.)/p->tau) N=2;
   //if (peaks[root_peak].ebin >= aubio_miditofreq(90.)/p->tau) N=1;
@@ -232,6 +348,12 @@ aubio_pitchmcomb_combdet (aubio_pitchmcomb_t * p, const fvec_t * newmag)
     candidate[l]->ene = 0.;     /* reset ene and len sums */
     candidate[l]->len = 0.;
     candidate[l]->ebin = scaler * peaks[root_peak].ebin;
+    /* skip the combs of fundamentals out of the range */
+    if (candidate[l]->ebin < p->min_bin || candidate[l]->ebin > p->max_bin) {
+      for (k = 0; k < length; k++)
+        candidate[l]->ecomb[k] = 0.;
+      continue;
+    }
     /* if less than N peaks available, curlen < N */
     if (candidate[l]->ebin != 0.)
       curlen = (uint_t) FLOOR (length / (candidate[l]->ebin));
@@ -301,12 +423,14 @@ aubio_pitchmcomb_quadpick (aubio_spectralpeak_t * spectral_peaks, const fvec_t *
 
 /* get predominant partial */
 uint_t
-aubio_pitchmcomb_get_root_peak (aubio_spectralpeak_t * peaks, uint_t length)
+aubio_pitchmcomb_get_root_peak (aubio_spectralpeak_t * peaks, uint_t length,
+    smpl_t min_bin, smpl_t max_bin)
 {
   uint_t i, pos = 0;
   smpl_t tmp = 0.;
   for (i = 0; i < length; i++)
-    if (tmp <= peaks[i].mag) {
+    if (tmp <= peaks[i].mag && peaks[i].ebin >= min_bin
+        && peaks[i].ebin <= max_bin) {
       pos = i;
       tmp = peaks[i].mag;
     }
@@ -385,6 +509,10 @@ new_aubio_pitchmcomb (uint_t bufsize, uint_t hopsize)
   p->scratch = new_fvec (spec_size);
   /* array for phase */
   p->theta = new_fvec (spec_size);
+  /* arrays for the polyphonic search */
+  p->residual = new_fvec (spec_size);
+  p->partials = new_fvec (spec_size);
+  p->poly_threshold = 0.5;
   /* array for adaptative threshold */
   p->scratch2 = new_fvec (p->win_post + p->win_pre + 1);
   /* array of spectral peaks */
@@ -406,9 +534,23 @@ new_aubio_pitchmcomb (uint_t bufsize, uint_t hopsize)
     p->candidates[i]->ebin = 0.;
     p->candidates[i]->len = 0.;
   }
+  aubio_pitchmcomb_set_bin_range (p, 0, spec_size - 1);
   return p;
 }
 
+uint_t
+aubio_pitchmcomb_set_bin_range (aubio_pitchmcomb_t * p, uint_t min_bin,
+    uint_t max_bin)
+{
+  uint_t spec_size = p->newmag->length;
+  p->max_bin = MIN (max_bin, spec_size - 1);
+  p->min_bin = MIN (min_bin, p->max_bin);
+  /* the root peak is up to ncand times the fundamental, the combs go up to
+   * npartials times it, and the peak picking looks one bin further */
+  p->bins = MIN (spec_size, MAX (p->ncand, p->npartials) * p->max_bin + 2);
+  return AUBIO_OK;
+}
+
 
 void
 del_aubio_pitchmcomb (aubio_pitchmcomb_t * p)
@@ -417,6 +559,8 @@ del_aubio_pitchmcomb (aubio_pitchmcomb_t * p)
   del_fvec (p->newmag);
   del_fvec (p->scratch);
   del_fvec (p->theta);
+  del_fvec (p->residual);
+  del_fvec (p->partials);
   del_fvec (p->scratch2);
   AUBIO_FREE (p->peaks);
   for (i = 0; i < p->ncand; i++) {
@@ -28,7 +28,7 @@
 /** pitch specacf structure */
 struct _aubio_pitchspecacf_t
 {
-  fvec_t *win;        /**< temporal weighting window */
+  const fvec_t *win;  /**< temporal weighting window, shared */
   fvec_t *winput;     /**< windowed spectrum */
   aubio_fft_t *fft;   /**< fft object to compute*/
   fvec_t *fftout;     /**< Fourier transform output */
@@ -36,13 +36,15 @@ struct _aubio_pitchspecacf_t
   fvec_t *acf;        /**< auto correlation function */
   smpl_t tol;         /**< tolerance */
   smpl_t confidence;  /**< confidence */
+  uint_t min_lag;     /**< shortest period looked for, in acf elements */
+  uint_t max_lag;     /**< longest period looked for, in acf elements */
 };
 
 aubio_pitchspecacf_t *
 new_aubio_pitchspecacf (uint_t bufsize)
 {
   aubio_pitchspecacf_t *p = AUBIO_NEW (aubio_pitchspecacf_t);
-  p->win = new_aubio_window ("hanningz", bufsize);
+  p->win = aubio_window_acquire ("hanningz", bufsize);
   p->winput = new_fvec (bufsize);
   p->fft = new_aubio_fft (bufsize);
   p->fftout = new_fvec (bufsize);
@@ -50,14 +52,26 @@ new_aubio_pitchspecacf (uint_t bufsize)
   p->acf = new_fvec (bufsize / 2 + 1);
   p->tol = 1.;
   p->confidence = 0.;
+  aubio_pitchspecacf_set_lag_range (p, 0, bufsize);
   return p;
 }
 
+uint_t
+aubio_pitchspecacf_set_lag_range (aubio_pitchspecacf_t * p, uint_t min_lag,
+    uint_t max_lag)
+{
+  /* each element of the acf stands for two samples */
+  p->max_lag = MIN ((max_lag + 1) / 2, p->acf->length - 1);
+  p->min_lag = MIN (min_lag / 2, p->max_lag);
+  return AUBIO_OK;
+}
+
 void
 aubio_pitchspecacf_do (aubio_pitchspecacf_t * p, const fvec_t * input, fvec_t * output)
 {
   uint_t l, tau;
   fvec_t *fftout = p->fftout;
+  fvec_t range;
   // window the input
   for (l = 0; l < input->length; l++) {
     p->winput->data[l] = p->win->data[l] * input->data[l];
@@ -69,20 +83,22 @@ aubio_pitchspecacf_do (aubio_pitchspecacf_t * p, const fvec_t * input, fvec_t *
   }
   // get the real / imag parts of the fft of the squared magnitude
   aubio_fft_do_complex (p->fft, p->sqrmag, fftout);
-  // copy real part to acf
-  for (l = 0; l < fftout->length / 2 + 1; l++) {
+  // copy real part to acf, up to one past the longest period
+  for (l = 0; l < MIN (p->max_lag + 2, p->acf->length); l++) {
     p->acf->data[l] = fftout->data[l];
   }
-  // get the minimum
-  tau = fvec_min_elem (p->acf);
-  // get the interpolated minimum
-  output->data[0] = fvec_quadratic_peak_pos (p->acf, tau) * 2.;
+  // get the minimum within the periods looked for
+  range.data = p->acf->data + p->min_lag;
+  range.length = p->max_lag + 1 - p->min_lag;
+  tau = fvec_min_elem (&range);
+  // get the interpolated minimum, but at the ends of the range
+  output->data[0] = (p->min_lag + fvec_quadratic_peak_pos (&range, tau)) * 2.;
 }
 
 void
 del_aubio_pitchspecacf (aubio_pitchspecacf_t * p)
 {
-  del_fvec (p->win);
+  aubio_window_release (p->win);
   del_fvec (p->winput);
   del_aubio_fft (p->fft);
   del_fvec (p->sqrmag);
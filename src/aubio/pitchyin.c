@@ -37,6 +37,15 @@ struct _aubio_pitchyin_t
   fvec_t *yin;
   smpl_t tol;
   smpl_t confidence;
+  uint_t hopsize;         /**< hop between frames, 0 to compute each alone */
+  uint_t n_blocks;        /**< hops in half a frame */
+  uint_t newest;          /**< block holding the newest hop */
+  fvec_t *blocks;         /**< difference function of each hop of the window */
+  fvec_t *last;           /**< previous frame */
+  uint_t primed;          /**< whether last and blocks hold a frame */
+  uint_t min_lag;         /**< shortest period looked for */
+  uint_t max_lag;         /**< longest period looked for */
+  uint_t end;             /**< lags of the difference function computed */
 };
 
 /** compute difference function
@@ -67,16 +76,123 @@ new_aubio_pitchyin (uint_t bufsize)
   aubio_pitchyin_t *o = AUBIO_NEW (aubio_pitchyin_t);
   o->yin = new_fvec (bufsize / 2);
   o->tol = 0.15;
+  aubio_pitchyin_set_lag_range (o, 0, bufsize / 2);
   return o;
 }
 
 void
 del_aubio_pitchyin (aubio_pitchyin_t * o)
 {
+  if (o->blocks) del_fvec (o->blocks);
+  if (o->last) del_fvec (o->last);
   del_fvec (o->yin);
   AUBIO_FREE (o);
 }
 
+uint_t
+aubio_pitchyin_set_hopsize (aubio_pitchyin_t * o, uint_t hopsize)
+{
+  uint_t length = o->yin->length;
+  if (o->blocks) del_fvec (o->blocks);
+  if (o->last) del_fvec (o->last);
+  o->blocks = o->last = NULL;
+  o->hopsize = o->n_blocks = o->primed = 0;
+  if (hopsize == 0) return AUBIO_OK;
+  if (hopsize >= length || length % hopsize != 0) {
+    /* the window can not be cut in hops, compute each frame alone */
+    return AUBIO_FAIL;
+  }
+  o->n_blocks = length / hopsize;
+  o->blocks = new_fvec (o->n_blocks * length);
+  o->last = new_fvec (2 * length);
+  if (!o->blocks || !o->last) {
+    aubio_pitchyin_set_hopsize (o, 0);
+    return AUBIO_FAIL;
+  }
+  o->hopsize = hopsize;
+  /* the frames start out silent, and so do the zeroed hops kept for them:
+   * the first frame only adds its newest hop, as the next ones do, instead
+   * of computing all of them on the first call */
+  o->primed = 1;
+  return AUBIO_OK;
+}
+
+uint_t
+aubio_pitchyin_set_lag_range (aubio_pitchyin_t * o, uint_t min_lag,
+    uint_t max_lag)
+{
+  uint_t length = o->yin->length, end;
+  o->max_lag = MIN (max_lag, length - 1);
+  o->min_lag = MIN (min_lag, o->max_lag);
+  /* the first dip is confirmed 3 lags after it */
+  end = MIN (o->max_lag + 4, length);
+  /* hops kept from the previous frames may miss the lags added */
+  if (end > o->end) o->primed = 0;
+  o->end = end;
+  return AUBIO_OK;
+}
+
+/* difference function of the hop of the window starting at start, for its
+ * first length lags; looping on the lags inside lets the compiler vectorise
+ * it */
+static void
+aubio_pitchyin_diff_hop (const fvec_t * input, uint_t start, uint_t hopsize,
+    smpl_t * diff, uint_t length)
+{
+  uint_t j, tau;
+  for (tau = 0; tau < length; tau++) {
+    diff[tau] = 0.;
+  }
+  for (j = start; j < start + hopsize; j++) {
+    const smpl_t x = input->data[j];
+    const smpl_t *y = input->data + j;
+    for (tau = 1; tau < length; tau++) {
+      const smpl_t tmp = x - y[tau];
+      diff[tau] += SQR (tmp);
+    }
+  }
+}
+
+/* difference function of a frame from that of the previous one: when the
+ * frame is the previous one moved by a hop, only the newest hop is computed
+ * and the oldest dropped; otherwise, say after frames were skipped, all of
+ * them are. The function is summed again from its hops every time, and each
+ * hop is recomputed as it comes in, so rounding errors never build up. */
+static void
+aubio_pitchyin_diff_incremental (aubio_pitchyin_t * o, const fvec_t * input)
+{
+  fvec_t *yin = o->yin;
+  uint_t length = yin->length, hopsize = o->hopsize, end = o->end, b, tau;
+  /* only the first 2 * length samples of the frame are looked at */
+  uint_t used = o->last->length;
+  uint_t moved = o->primed && memcmp (input->data,
+      o->last->data + hopsize, (used - hopsize) * sizeof (smpl_t)) == 0;
+  if (moved) {
+    o->newest = (o->newest + 1) % o->n_blocks;
+    aubio_pitchyin_diff_hop (input, length - hopsize, hopsize,
+        o->blocks->data + o->newest * length, end);
+  } else {
+    for (b = 0; b < o->n_blocks; b++) {
+      aubio_pitchyin_diff_hop (input, b * hopsize, hopsize,
+          o->blocks->data + b * length, end);
+    }
+    o->newest = o->n_blocks - 1;
+    o->primed = 1;
+  }
+  for (tau = 0; tau < end; tau++) {
+    yin->data[tau] = 0.;
+  }
+  /* oldest hop first, as the batch computation would add them */
+  for (b = 1; b <= o->n_blocks; b++) {
+    const smpl_t *diff = o->blocks->data
+      + ((o->newest + b) % o->n_blocks) * length;
+    for (tau = 0; tau < end; tau++) {
+      yin->data[tau] += diff[tau];
+    }
+  }
+  memcpy (o->last->data, input->data, used * sizeof (smpl_t));
+}
+
 /* outputs the difference function */
 void
 aubio_pitchyin_diff (fvec_t * input, fvec_t * yin)
@@ -134,15 +250,21 @@ aubio_pitchyin_do (aubio_pitchyin_t * o, const fvec_t * input, fvec_t * out)
 {
   smpl_t tol = o->tol;
   fvec_t *yin = o->yin;
+  fvec_t range;
   uint_t j, tau = 0;
   sint_t period;
   smpl_t tmp = 0., tmp2 = 0.;
+  if (o->hopsize) aubio_pitchyin_diff_incremental (o, input);
   yin->data[0] = 1.;
-  for (tau = 1; tau < yin->length; tau++) {
-    yin->data[tau] = 0.;
-    for (j = 0; j < yin->length; j++) {
-      tmp = input->data[j] - input->data[j + tau];
-      yin->data[tau] += SQR (tmp);
+  /* the lags under min_lag are still needed by the cumulative mean, the
+   * ones past max_lag are not computed at all */
+  for (tau = 1; tau < o->end; tau++) {
+    if (!o->hopsize) {
+      yin->data[tau] = 0.;
+      for (j = 0; j < yin->length; j++) {
+        tmp = input->data[j] - input->data[j + tau];
+        yin->data[tau] += SQR (tmp);
+      }
     }
     tmp2 += yin->data[tau];
     if (tmp2 != 0) {
@@ -151,20 +273,34 @@ aubio_pitchyin_do (aubio_pitchyin_t * o, const fvec_t * input, fvec_t * out)
       yin->data[tau] = 1.;
     }
     period = tau - 3;
-    if (tau > 4 && (yin->data[period] < tol) &&
-        (yin->data[period] < yin->data[period + 1])) {
+    if (tau > 4 && period >= (sint_t)o->min_lag && (yin->data[period] < tol)
+        && (yin->data[period] < yin->data[period + 1])) {
       out->data[0] = fvec_quadratic_peak_pos (yin, period);
+      /* the differences past tau are there already, normalise them too so
+       * that the confidence sees the whole function */
+      for (tau++; o->hopsize && tau < o->end; tau++) {
+        tmp2 += yin->data[tau];
+        yin->data[tau] = tmp2 != 0 ? yin->data[tau] * tau / tmp2 : 1.;
+      }
       goto beach;
     }
   }
-  out->data[0] = fvec_quadratic_peak_pos (yin, fvec_min_elem (yin));
+  /* not interpolated at the ends of the range, where it may not dip */
+  range.data = yin->data + o->min_lag;
+  range.length = o->max_lag + 1 - o->min_lag;
+  out->data[0] = o->min_lag
+    + fvec_quadratic_peak_pos (&range, fvec_min_elem (&range));
 beach:
   return;
 }
 
 smpl_t
 aubio_pitchyin_get_confidence (aubio_pitchyin_t * o) {
-  o->confidence = 1. - fvec_min (o->yin);
+  fvec_t range;
+  range.data = o->yin->data + o->min_lag;
+  range.length = o->max_lag + 1 - o->min_lag;
+  /* the function may stay above 1 over the range, lag 0 no longer in it */
+  o->confidence = MAX (1. - fvec_min (&range), 0.);
   return o->confidence;
 }
 
@@ -0,0 +1,288 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "mathutils.h"
+#include "pitch/pitchyindec.h"
+
+/* non-zero taps on each side of the half-band filters */
+#define AUBIO_HALFBAND_TAPS 4
+/* decimate while the rate stays above this, the pitches sought are below */
+#define AUBIO_YINDEC_MIN_RATE 8000
+/* and while the decimated buffer keeps at least this many samples */
+#define AUBIO_YINDEC_MIN_LENGTH 64
+#define AUBIO_YINDEC_MAX_STAGES 4
+/* periods shorter than this many decimated samples are looked for at the
+ * full rate, there are few of them and the decimated function is too coarse
+ * for them */
+#define AUBIO_YINDEC_MIN_LAG 8
+
+struct _aubio_pitchyindec_t
+{
+  uint_t n_stages;                          /**< half-band stages */
+  uint_t decimation;                        /**< 2^n_stages */
+  smpl_t taps[AUBIO_HALFBAND_TAPS];         /**< odd taps, the centre is .5 */
+  fvec_t *stages[AUBIO_YINDEC_MAX_STAGES];  /**< output of each stage */
+  fvec_t *high;                             /**< full rate YIN, short lags */
+  fvec_t *yin;                              /**< decimated YIN function */
+  fvec_t *fine;                             /**< full rate difference */
+  smpl_t tol;
+  smpl_t confidence;
+  uint_t min_lag;                           /**< shortest period looked for */
+  uint_t max_lag;                           /**< longest period looked for */
+};
+
+/* windowed-sinc half-band low-pass: every other tap is zero but the centre
+ * one, and the odd ones are symmetric, so only those are kept */
+static void
+aubio_pitchyindec_halfband (smpl_t * taps)
+{
+  uint_t k;
+  smpl_t sum = 0.;
+  for (k = 0; k < AUBIO_HALFBAND_TAPS; k++) {
+    smpl_t n = 2. * k + 1., half = 2. * AUBIO_HALFBAND_TAPS;
+    smpl_t w = 0.42 + 0.5 * COS (PI * n / half) + 0.08 * COS (TWO_PI * n / half);
+    taps[k] = SIN (PI * n / 2.) / (PI * n) * w;
+    sum += taps[k];
+  }
+  /* unit gain at DC: .5 + 2 * sum */
+  for (k = 0; k < AUBIO_HALFBAND_TAPS; k++) {
+    taps[k] *= .25 / sum;
+  }
+}
+
+/* output length of a stage, keeping the samples the filter fully covers */
+static uint_t
+aubio_pitchyindec_stage_length (uint_t length)
+{
+  uint_t span = 4 * AUBIO_HALFBAND_TAPS - 2;
+  return length > span + 1 ? (length - span + 1) / 2 : 0;
+}
+
+aubio_pitchyindec_t *
+new_aubio_pitchyindec (uint_t bufsize, uint_t samplerate)
+{
+  aubio_pitchyindec_t *o = AUBIO_NEW (aubio_pitchyindec_t);
+  uint_t i, length = bufsize, rate = samplerate;
+  if ((sint_t)bufsize < 1) {
+    AUBIO_ERR ("pitchyindec: got buffer_size %d, but can not be < 1\n",
+        bufsize);
+    goto beach;
+  }
+  while (o->n_stages < AUBIO_YINDEC_MAX_STAGES
+      && rate / 2 >= AUBIO_YINDEC_MIN_RATE
+      && aubio_pitchyindec_stage_length (length) >= AUBIO_YINDEC_MIN_LENGTH) {
+    length = aubio_pitchyindec_stage_length (length);
+    rate /= 2;
+    o->stages[o->n_stages++] = new_fvec (length);
+  }
+  o->decimation = 1 << o->n_stages;
+  o->high = new_fvec (MIN (AUBIO_YINDEC_MIN_LAG * o->decimation, bufsize / 2));
+  o->yin = new_fvec (length / 2);
+  /* one decimated lag on each side, and one more for the interpolation */
+  o->fine = new_fvec (2 * o->decimation + 3);
+  if (!o->high || !o->yin || !o->fine) goto beach;
+  for (i = 0; i < o->n_stages; i++) {
+    if (!o->stages[i]) goto beach;
+  }
+  aubio_pitchyindec_halfband (o->taps);
+  o->tol = 0.15;
+  aubio_pitchyindec_set_lag_range (o, 0, bufsize / 2);
+  return o;
+
+beach:
+  del_aubio_pitchyindec (o);
+  return NULL;
+}
+
+void
+del_aubio_pitchyindec (aubio_pitchyindec_t * o)
+{
+  uint_t i;
+  for (i = 0; i < o->n_stages; i++) {
+    if (o->stages[i]) del_fvec (o->stages[i]);
+  }
+  if (o->high) del_fvec (o->high);
+  if (o->yin) del_fvec (o->yin);
+  if (o->fine) del_fvec (o->fine);
+  AUBIO_FREE (o);
+}
+
+/* low-pass and keep every other sample, computing only the outputs kept */
+static void
+aubio_pitchyindec_decimate (const smpl_t * taps, const fvec_t * in,
+    fvec_t * out)
+{
+  uint_t i, k;
+  const smpl_t *x = in->data + 2 * AUBIO_HALFBAND_TAPS - 1;
+  for (i = 0; i < out->length; i++, x += 2) {
+    smpl_t acc = .5 * x[0];
+    for (k = 0; k < AUBIO_HALFBAND_TAPS; k++) {
+      acc += taps[k] * (x[-(sint_t)(2 * k + 1)] + x[2 * k + 1]);
+    }
+    out->data[i] = acc;
+  }
+}
+
+/* squared difference of the first half of the buffer with itself at tau */
+static smpl_t
+aubio_pitchyindec_diff (const fvec_t * input, uint_t tau)
+{
+  uint_t j, length = input->length / 2;
+  smpl_t sum = 0.;
+  for (j = 0; j < length; j++) {
+    smpl_t tmp = input->data[j] - input->data[j + tau];
+    sum += SQR (tmp);
+  }
+  return sum;
+}
+
+/* YIN as in aubio_pitchyin_do, on the lags yin holds, taking periods from
+ * min_period on; returns 0 when none is below the tolerance and the
+ * function is not complete, else its minimum from first on */
+static smpl_t
+aubio_pitchyindec_search (aubio_pitchyindec_t * o, fvec_t * yin,
+    const fvec_t * input, uint_t first, sint_t min_period, uint_t complete)
+{
+  fvec_t range;
+  uint_t tau;
+  sint_t period;
+  smpl_t tmp2 = 0.;
+  yin->data[0] = 1.;
+  for (tau = 1; tau < yin->length; tau++) {
+    yin->data[tau] = aubio_pitchyindec_diff (input, tau);
+    tmp2 += yin->data[tau];
+    if (tmp2 != 0) {
+      yin->data[tau] *= tau / tmp2;
+    } else {
+      yin->data[tau] = 1.;
+    }
+    period = tau - 3;
+    if (tau > 4 && period >= min_period && (yin->data[period] < o->tol) &&
+        (yin->data[period] < yin->data[period + 1])) {
+      /* the rest is not computed, it should not count in the confidence */
+      for (tau++; tau < yin->length; tau++) yin->data[tau] = 1.;
+      return fvec_quadratic_peak_pos (yin, period);
+    }
+  }
+  if (!complete) return 0.;
+  range.data = yin->data + first;
+  range.length = yin->length - first;
+  return first + fvec_quadratic_peak_pos (&range, fvec_min_elem (&range));
+}
+
+void
+aubio_pitchyindec_do (aubio_pitchyindec_t * o, const fvec_t * input,
+    fvec_t * out)
+{
+  const fvec_t *dec = input;
+  fvec_t *fine = o->fine;
+  fvec_t high, yin;
+  uint_t i, max_tau = input->length / 2 - 1, d = o->decimation;
+  sint_t first;
+  smpl_t coarse;
+  /* lags past the range are not computed, one is kept for the
+   * interpolation */
+  high.data = o->high->data;
+  high.length = MIN (o->high->length, o->max_lag + 2);
+  yin.data = o->yin->data;
+  yin.length = MIN (o->yin->length, o->max_lag / d + 3);
+  fvec_set_all (o->high, 1.);
+  fvec_set_all (o->yin, 1.);
+  /* short periods first, at the full rate, as aubio_pitchyin_do would */
+  if (o->min_lag < high.length) {
+    /* the search stops there when the range does not go further */
+    uint_t last = o->max_lag < o->high->length;
+    out->data[0] = aubio_pitchyindec_search (o, &high, input, o->min_lag,
+        o->min_lag, last);
+    if (out->data[0] > 0. || last) return;
+  }
+  for (i = 0; i < o->n_stages; i++) {
+    aubio_pitchyindec_decimate (o->taps, dec, o->stages[i]);
+    dec = o->stages[i];
+  }
+  coarse = aubio_pitchyindec_search (o, &yin, dec, MIN (o->min_lag / d,
+        yin.length - 1), MAX (AUBIO_YINDEC_MIN_LAG - 1, o->min_lag / d), 1);
+  if (coarse <= 0.) {
+    out->data[0] = 0.;
+    return;
+  }
+  /* full rate lags around the decimated period, within the buffer */
+  first = (sint_t)ROUND (coarse * o->decimation) - (sint_t)fine->length / 2;
+  first = MAX (first, 1);
+  first = MIN (first, (sint_t)max_tau - (sint_t)fine->length + 1);
+  if (first < 1) {
+    out->data[0] = coarse * o->decimation;
+    return;
+  }
+  for (i = 0; i < fine->length; i++) {
+    fine->data[i] = aubio_pitchyindec_diff (input, first + i);
+  }
+  out->data[0] = first + fvec_quadratic_peak_pos (fine, fvec_min_elem (fine));
+}
+
+uint_t
+aubio_pitchyindec_get_decimation (const aubio_pitchyindec_t * o)
+{
+  return o->decimation;
+}
+
+uint_t
+aubio_pitchyindec_set_lag_range (aubio_pitchyindec_t * o, uint_t min_lag,
+    uint_t max_lag)
+{
+  /* the longest lag of the decimated function, at the full rate */
+  o->max_lag = MIN (max_lag, (o->yin->length - 1) * o->decimation);
+  o->min_lag = MIN (min_lag, o->max_lag);
+  return AUBIO_OK;
+}
+
+/* smallest value of a function from the lag first on, 1 if there is none */
+static smpl_t
+aubio_pitchyindec_min_from (const fvec_t * f, uint_t first)
+{
+  fvec_t range;
+  if (first >= f->length) return 1.;
+  range.data = f->data + first;
+  range.length = f->length - first;
+  return fvec_min (&range);
+}
+
+smpl_t
+aubio_pitchyindec_get_confidence (aubio_pitchyindec_t * o) {
+  o->confidence = 1. - MIN (aubio_pitchyindec_min_from (o->high, o->min_lag),
+      aubio_pitchyindec_min_from (o->yin, o->min_lag / o->decimation));
+  o->confidence = MAX (o->confidence, 0.);
+  return o->confidence;
+}
+
+uint_t
+aubio_pitchyindec_set_tolerance (aubio_pitchyindec_t * o, smpl_t tol)
+{
+  o->tol = tol;
+  return 0;
+}
+
+smpl_t
+aubio_pitchyindec_get_tolerance (aubio_pitchyindec_t * o)
+{
+  return o->tol;
+}
@@ -22,22 +22,26 @@
 #include "fvec.h"
 #include "cvec.h"
 #include "mathutils.h"
+#include "musicutils.h"
+#include "utils/tables.h"
 #include "spectral/fft.h"
 #include "pitch/pitchyinfft.h"
 
 /** pitch yinfft structure */
 struct _aubio_pitchyinfft_t
 {
-  fvec_t *win;        /**< temporal weighting window */
+  const fvec_t *win;  /**< temporal weighting window, shared */
   fvec_t *winput;     /**< windowed spectrum */
   fvec_t *sqrmag;     /**< square difference function */
-  fvec_t *weight;     /**< spectral weighting window (psychoacoustic model) */
+  const fvec_t *weight; /**< spectral weighting (psychoacoustic model), shared */
   fvec_t *fftout;     /**< Fourier transform output */
   aubio_fft_t *fft;   /**< fft object to compute square difference function */
   fvec_t *yinfft;     /**< Yin function */
   smpl_t tol;         /**< Yin tolerance */
   smpl_t confidence;  /**< confidence */
   uint_t short_period; /** shortest period under which to check for octave error */
+  uint_t min_lag;     /**< shortest period looked for */
+  uint_t max_lag;     /**< longest period looked for */
 };
 
 static const smpl_t freqs[] = {
@@ -54,21 +58,18 @@ static const smpl_t weight[] = {
   -7.40,  -17.8,  -17.8,  -17.8
 };
 
-aubio_pitchyinfft_t *
-new_aubio_pitchyinfft (uint_t samplerate, uint_t bufsize)
+/* interpolate the weighting curve at each bin, as a vector followed by its
+ * elements */
+static uint_t
+aubio_pitchyinfft_weight_init (void * data, const char_t * kind,
+    uint_t bufsize, uint_t samplerate)
 {
   uint_t i = 0, j = 1;
   smpl_t freq = 0, a0 = 0, a1 = 0, f0 = 0, f1 = 0;
-  aubio_pitchyinfft_t *p = AUBIO_NEW (aubio_pitchyinfft_t);
-  p->winput = new_fvec (bufsize);
-  p->fft = new_aubio_fft (bufsize);
-  p->fftout = new_fvec (bufsize);
-  p->sqrmag = new_fvec (bufsize);
-  p->yinfft = new_fvec (bufsize / 2 + 1);
-  p->tol = 0.85;
-  p->win = new_aubio_window ("hanningz", bufsize);
-  p->weight = new_fvec (bufsize / 2 + 1);
-  for (i = 0; i < p->weight->length; i++) {
+  fvec_t *w = (fvec_t *)data;
+  w->length = bufsize / 2 + 1;
+  w->data = (smpl_t *)(w + 1);
+  for (i = 0; i < w->length; i++) {
     freq = (smpl_t) i / (smpl_t) bufsize *(smpl_t) samplerate;
     while (freq > freqs[j]) {
       j += 1;
@@ -78,34 +79,61 @@ new_aubio_pitchyinfft (uint_t samplerate, uint_t bufsize)
     a1 = weight[j];
     f1 = freqs[j];
     if (f0 == f1) {           // just in case
-      p->weight->data[i] = a0;
+      w->data[i] = a0;
     } else if (f0 == 0) {     // y = ax+b
-      p->weight->data[i] = (a1 - a0) / f1 * freq + a0;
+      w->data[i] = (a1 - a0) / f1 * freq + a0;
     } else {
-      p->weight->data[i] = (a1 - a0) / (f1 - f0) * freq +
+      w->data[i] = (a1 - a0) / (f1 - f0) * freq +
           (a0 - (a1 - a0) / (f1 / f0 - 1.));
     }
     while (freq > freqs[j]) {
       j += 1;
     }
-    //AUBIO_DBG("%f\n",p->weight->data[i]);
-    p->weight->data[i] = DB2LIN (p->weight->data[i]);
-    //p->weight->data[i] = SQRT(DB2LIN(p->weight->data[i]));
+    //AUBIO_DBG("%f\n",w->data[i]);
+    w->data[i] = DB2LIN (w->data[i]);
+    //w->data[i] = SQRT(DB2LIN(w->data[i]));
   }
+  return AUBIO_OK;
+}
+
+aubio_pitchyinfft_t *
+new_aubio_pitchyinfft (uint_t samplerate, uint_t bufsize)
+{
+  aubio_pitchyinfft_t *p = AUBIO_NEW (aubio_pitchyinfft_t);
+  p->winput = new_fvec (bufsize);
+  p->fft = new_aubio_fft (bufsize);
+  p->fftout = new_fvec (bufsize);
+  p->sqrmag = new_fvec (bufsize);
+  p->yinfft = new_fvec (bufsize / 2 + 1);
+  p->tol = 0.85;
+  p->win = aubio_window_acquire ("hanningz", bufsize);
+  p->weight = (const fvec_t *)aubio_table_acquire ("yinfft_weight", bufsize,
+      samplerate, sizeof (fvec_t) + (bufsize / 2 + 1) * sizeof (smpl_t),
+      aubio_pitchyinfft_weight_init);
   // check for octave errors above 1300 Hz
   p->short_period = (uint_t)ROUND(samplerate / 1300.);
+  aubio_pitchyinfft_set_lag_range (p, 0, bufsize / 2);
   return p;
 }
 
+uint_t
+aubio_pitchyinfft_set_lag_range (aubio_pitchyinfft_t * p, uint_t min_lag,
+    uint_t max_lag)
+{
+  p->max_lag = MIN (max_lag, p->yinfft->length - 1);
+  p->min_lag = MIN (min_lag, p->max_lag);
+  return AUBIO_OK;
+}
+
+static void aubio_pitchyinfft_do_sqrmag (aubio_pitchyinfft_t * p,
+    fvec_t * output);
+
 void
 aubio_pitchyinfft_do (aubio_pitchyinfft_t * p, const fvec_t * input, fvec_t * output)
 {
-  uint_t tau, l;
+  uint_t l;
   uint_t length = p->fftout->length;
-  uint_t halfperiod;
   fvec_t *fftout = p->fftout;
-  fvec_t *yin = p->yinfft;
-  smpl_t tmp = 0., sum = 0.;
   // window the input
   fvec_weighted_copy(input, p->win, p->winput);
   // get the real / imag parts of its fft
@@ -120,6 +148,38 @@ aubio_pitchyinfft_do (aubio_pitchyinfft_t * p, const fvec_t * input, fvec_t * ou
   }
   p->sqrmag->data[length / 2] = SQR(fftout->data[length / 2]);
   p->sqrmag->data[length / 2] *= p->weight->data[length / 2];
+  aubio_pitchyinfft_do_sqrmag (p, output);
+}
+
+void
+aubio_pitchyinfft_do_spectrum (aubio_pitchyinfft_t * p, const cvec_t * spectrum,
+    fvec_t * output)
+{
+  uint_t l;
+  uint_t length = p->fftout->length;
+  // the squared norm does not depend on the window being shifted or not
+  for (l = 0; l < length / 2 + 1; l++) {
+    p->sqrmag->data[l] = SQR(spectrum->norm[l]) * p->weight->data[l];
+  }
+  for (l = 1; l < length / 2; l++) {
+    p->sqrmag->data[length - l] = p->sqrmag->data[l];
+  }
+  aubio_pitchyinfft_do_sqrmag (p, output);
+}
+
+/* yin function from the weighted squared magnitude spectrum in p->sqrmag */
+static void
+aubio_pitchyinfft_do_sqrmag (aubio_pitchyinfft_t * p, fvec_t * output)
+{
+  uint_t tau, l;
+  uint_t length = p->fftout->length;
+  uint_t halfperiod;
+  fvec_t *fftout = p->fftout;
+  fvec_t *yin = p->yinfft;
+  /* one lag past max_lag for the interpolation, none further */
+  uint_t end = MIN (p->max_lag + 2, yin->length);
+  fvec_t range;
+  smpl_t tmp = 0., sum = 0.;
   // get sum of weighted squared mags
   for (l = 0; l < length / 2 + 1; l++) {
     sum += p->sqrmag->data[l];
@@ -128,7 +188,7 @@ aubio_pitchyinfft_do (aubio_pitchyinfft_t * p, const fvec_t * input, fvec_t * ou
   // get the real / imag parts of the fft of the squared magnitude
   aubio_fft_do_complex (p->fft, p->sqrmag, fftout);
   yin->data[0] = 1.;
-  for (tau = 1; tau < yin->length; tau++) {
+  for (tau = 1; tau < end; tau++) {
     // compute the square differences
     yin->data[tau] = sum - fftout->data[tau];
     // and the cumulative mean normalized difference function
@@ -139,25 +199,30 @@ aubio_pitchyinfft_do (aubio_pitchyinfft_t * p, const fvec_t * input, fvec_t * ou
       yin->data[tau] = 1.;
     }
   }
-  // find best candidates
-  tau = fvec_min_elem (yin);
+  // find best candidates, within the periods looked for
+  range.data = yin->data + p->min_lag;
+  range.length = p->max_lag + 1 - p->min_lag;
+  tau = p->min_lag + fvec_min_elem (&range);
   if (yin->data[tau] < p->tol) {
     // no interpolation, directly return the period as an integer
     //output->data[0] = tau;
     //return;
 
-    // 3 point quadratic interpolation
+    // 3 point quadratic interpolation, but at the ends of the range
     //return fvec_quadratic_peak_pos (yin,tau,1);
     /* additional check for (unlikely) octave doubling in higher frequencies */
     if (tau > p->short_period) {
-      output->data[0] = fvec_quadratic_peak_pos (yin, tau);
+      output->data[0] = p->min_lag
+        + fvec_quadratic_peak_pos (&range, tau - p->min_lag);
     } else {
       /* should compare the minimum value of each interpolated peaks */
       halfperiod = FLOOR (tau / 2 + .5);
-      if (yin->data[halfperiod] < p->tol)
-        output->data[0] = fvec_quadratic_peak_pos (yin, halfperiod);
+      if (halfperiod >= p->min_lag && yin->data[halfperiod] < p->tol)
+        output->data[0] = p->min_lag
+          + fvec_quadratic_peak_pos (&range, halfperiod - p->min_lag);
       else
-        output->data[0] = fvec_quadratic_peak_pos (yin, tau);
+        output->data[0] = p->min_lag
+          + fvec_quadratic_peak_pos (&range, tau - p->min_lag);
     }
   } else {
     output->data[0] = 0.;
@@ -167,19 +232,23 @@ aubio_pitchyinfft_do (aubio_pitchyinfft_t * p, const fvec_t * input, fvec_t * ou
 void
 del_aubio_pitchyinfft (aubio_pitchyinfft_t * p)
 {
-  del_fvec (p->win);
+  aubio_window_release (p->win);
   del_aubio_fft (p->fft);
   del_fvec (p->yinfft);
   del_fvec (p->sqrmag);
   del_fvec (p->fftout);
   del_fvec (p->winput);
-  del_fvec (p->weight);
+  aubio_table_release (p->weight);
   AUBIO_FREE (p);
 }
 
 smpl_t
 aubio_pitchyinfft_get_confidence (aubio_pitchyinfft_t * o) {
-  o->confidence = 1. - fvec_min (o->yinfft);
+  fvec_t range;
+  range.data = o->yinfft->data + o->min_lag;
+  range.length = o->max_lag + 1 - o->min_lag;
+  /* without yinfft[0] = 1, the minimum may be above 1 */
+  o->confidence = MAX (1. - fvec_min (&range), 0.);
   return o->confidence;
 }
 
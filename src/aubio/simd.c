@@ -0,0 +1,915 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "simd.h"
+#include <float.h>
+
+#if defined(HAVE_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_SIMD_AVX2 1
+#define AVX2_TARGET __attribute__ ((target ("avx2,fma")))
+#endif
+#endif
+
+#if defined(HAVE_SIMD) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+/* coefficients of the atan approximation on [0, 1] used by the vectorized
+ * spec_phas kernels, from Abramowitz and Stegun 4.4.49; max error 1e-5 rad */
+#define ATAN_C1  0.99997726f
+#define ATAN_C3 -0.33262347f
+#define ATAN_C5  0.19354346f
+#define ATAN_C7 -0.11643287f
+#define ATAN_C9  0.05265332f
+#define ATAN_C11 -0.01172120f
+
+/* vectors of notes the Goertzel kernels run side by side, so that their
+ * recurrences overlap in the pipeline */
+#define GOERTZEL_VECTORS 4
+#define GOERTZEL_MAX_BLOCK (8 * GOERTZEL_VECTORS)
+
+/* plain C kernels */
+
+static void
+scalar_weight (smpl_t * s, const smpl_t * w, uint_t n)
+{
+  uint_t j;
+  for (j = 0; j < n; j++) {
+    s[j] *= w[j];
+  }
+}
+
+static void
+scalar_weighted_copy (const smpl_t * in, const smpl_t * w, smpl_t * out,
+    uint_t n)
+{
+  uint_t j;
+  for (j = 0; j < n; j++) {
+    out[j] = in[j] * w[j];
+  }
+}
+
+static smpl_t
+scalar_sum (const smpl_t * s, uint_t n)
+{
+  uint_t j;
+  smpl_t tmp = 0.;
+  for (j = 0; j < n; j++) {
+    tmp += s[j];
+  }
+  return tmp;
+}
+
+static smpl_t
+scalar_sum_sq (const smpl_t * s, uint_t n)
+{
+  uint_t j;
+  smpl_t tmp = 0.;
+  for (j = 0; j < n; j++) {
+    tmp += SQR (s[j]);
+  }
+  return tmp;
+}
+
+static smpl_t
+scalar_min (const smpl_t * s, uint_t n)
+{
+  uint_t j;
+  smpl_t tmp = s[0];
+  for (j = 0; j < n; j++) {
+    tmp = (tmp < s[j]) ? tmp : s[j];
+  }
+  return tmp;
+}
+
+static void
+scalar_add (smpl_t * s, smpl_t c, uint_t n)
+{
+  uint_t j;
+  for (j = 0; j < n; j++) {
+    s[j] += c;
+  }
+}
+
+static void
+scalar_spec_norm (const smpl_t * c, uint_t length, smpl_t * norm, uint_t n)
+{
+  uint_t i;
+  for (i = 1; i < n; i++) {
+    norm[i] = SQRT (SQR (c[i]) + SQR (c[length - i]));
+  }
+}
+
+static void
+scalar_spec_phas (const smpl_t * c, uint_t length, smpl_t * phas, uint_t n)
+{
+  uint_t i;
+  for (i = 1; i < n; i++) {
+    phas[i] = ATAN2 (c[length - i], c[i]);
+  }
+}
+
+/* the range over which some of the notes have not started yet */
+static void
+goertzel_starts (const uint_t * start, uint_t block, uint_t n, uint_t * first,
+    uint_t * last)
+{
+  uint_t j;
+  *first = n;
+  *last = 0;
+  for (j = 0; j < block; j++) {
+    *first = MIN (*first, start[j]);
+    *last = MAX (*last, start[j]);
+  }
+}
+
+/* four notes at a time, so that their recurrences overlap; each one starts
+ * when the loop reaches its window */
+static void
+scalar_goertzel (const smpl_t * x, uint_t n, const smpl_t * coef,
+    const uint_t * start, smpl_t * s1, smpl_t * s2, uint_t notes)
+{
+  uint_t i, j, k;
+  for (k = 0; k + 4 <= notes; k += 4) {
+    smpl_t a[4] = { 0. }, b[4] = { 0. }, s;
+    uint_t first, last;
+    goertzel_starts (start + k, 4, n, &first, &last);
+    for (i = first; i < last; i++) {
+      for (j = 0; j < 4; j++) {
+        s = (i >= start[k + j] ? x[i] : 0.) + coef[k + j] * a[j] - b[j];
+        b[j] = a[j];
+        a[j] = s;
+      }
+    }
+    for (; i < n; i++) {
+      for (j = 0; j < 4; j++) {
+        s = x[i] + coef[k + j] * a[j] - b[j];
+        b[j] = a[j];
+        a[j] = s;
+      }
+    }
+    for (j = 0; j < 4; j++) {
+      s1[k + j] = a[j];
+      s2[k + j] = b[j];
+    }
+  }
+  for (; k < notes; k++) {
+    smpl_t a = 0., b = 0., s;
+    for (i = start[k]; i < n; i++) {
+      s = x[i] + coef[k] * a - b;
+      b = a;
+      a = s;
+    }
+    s1[k] = a;
+    s2[k] = b;
+  }
+}
+
+#if defined(HAVE_SIMD) && (defined(__SSE2__) || defined(__ARM_NEON))
+
+/* kernel running the resonators of block notes at once */
+typedef void (*goertzel_block_t) (const smpl_t * x, uint_t n,
+    const smpl_t * coef, const uint_t * start, smpl_t * s1, smpl_t * s2);
+
+/* run the notes by blocks, the last one padded with notes that never start */
+static void
+goertzel_blocks (goertzel_block_t block_do, uint_t block, const smpl_t * x,
+    uint_t n, const smpl_t * coef, const uint_t * start, smpl_t * s1,
+    smpl_t * s2, uint_t notes)
+{
+  smpl_t c[GOERTZEL_MAX_BLOCK], t1[GOERTZEL_MAX_BLOCK], t2[GOERTZEL_MAX_BLOCK];
+  uint_t from[GOERTZEL_MAX_BLOCK];
+  uint_t j, k = 0;
+  for (; k + block <= notes; k += block) {
+    block_do (x, n, coef + k, start + k, s1 + k, s2 + k);
+  }
+  if (k == notes) return;
+  for (j = 0; j < block; j++) {
+    c[j] = k + j < notes ? coef[k + j] : 0.;
+    from[j] = k + j < notes ? start[k + j] : n;
+  }
+  block_do (x, n, c, from, t1, t2);
+  for (j = 0; k + j < notes; j++) {
+    s1[k + j] = t1[j];
+    s2[k + j] = t2[j];
+  }
+}
+
+#endif /* HAVE_SIMD && (__SSE2__ || __ARM_NEON) */
+
+static const aubio_simd_t simd_scalar = {
+  "scalar",
+  scalar_weight,
+  scalar_weighted_copy,
+  scalar_sum,
+  scalar_sum_sq,
+  scalar_min,
+  scalar_add,
+  scalar_spec_norm,
+  scalar_spec_phas,
+  scalar_goertzel
+};
+
+#if defined(HAVE_SIMD) && defined(__SSE2__)
+
+/* SSE2 kernels, 4 floats wide; part of the x86_64 baseline, and enabled by
+ * -msse2 in the Makefile on i386 */
+
+static inline smpl_t
+sse2_hsum (__m128 v)
+{
+  v = _mm_add_ps (v, _mm_movehl_ps (v, v));
+  v = _mm_add_ss (v, _mm_shuffle_ps (v, v, 1));
+  return _mm_cvtss_f32 (v);
+}
+
+static inline smpl_t
+sse2_hmin (__m128 v)
+{
+  v = _mm_min_ps (v, _mm_movehl_ps (v, v));
+  v = _mm_min_ss (v, _mm_shuffle_ps (v, v, 1));
+  return _mm_cvtss_f32 (v);
+}
+
+/* load s[0..3] in reverse order */
+static inline __m128
+sse2_loadr (const smpl_t * s)
+{
+  __m128 v = _mm_loadu_ps (s);
+  return _mm_shuffle_ps (v, v, _MM_SHUFFLE (0, 1, 2, 3));
+}
+
+static inline __m128
+sse2_select (__m128 mask, __m128 a, __m128 b)
+{
+  return _mm_or_ps (_mm_and_ps (mask, a), _mm_andnot_ps (mask, b));
+}
+
+static inline __m128
+sse2_atan2 (__m128 y, __m128 x)
+{
+  const __m128 sign = _mm_set1_ps (-0.f);
+  __m128 ax = _mm_andnot_ps (sign, x);
+  __m128 ay = _mm_andnot_ps (sign, y);
+  __m128 mx = _mm_max_ps (ax, ay);
+  __m128 mn = _mm_min_ps (ax, ay);
+  __m128 a = _mm_div_ps (mn, _mm_add_ps (mx, _mm_set1_ps (FLT_MIN)));
+  __m128 s = _mm_mul_ps (a, a);
+  __m128 r = _mm_set1_ps (ATAN_C11);
+  r = _mm_add_ps (_mm_mul_ps (r, s), _mm_set1_ps (ATAN_C9));
+  r = _mm_add_ps (_mm_mul_ps (r, s), _mm_set1_ps (ATAN_C7));
+  r = _mm_add_ps (_mm_mul_ps (r, s), _mm_set1_ps (ATAN_C5));
+  r = _mm_add_ps (_mm_mul_ps (r, s), _mm_set1_ps (ATAN_C3));
+  r = _mm_add_ps (_mm_mul_ps (r, s), _mm_set1_ps (ATAN_C1));
+  r = _mm_mul_ps (r, a);
+  r = sse2_select (_mm_cmpgt_ps (ay, ax),
+      _mm_sub_ps (_mm_set1_ps (PI / 2.), r), r);
+  r = sse2_select (_mm_cmplt_ps (x, _mm_setzero_ps ()),
+      _mm_sub_ps (_mm_set1_ps (PI), r), r);
+  return _mm_or_ps (r, _mm_and_ps (sign, y));
+}
+
+static void
+sse2_weight (smpl_t * s, const smpl_t * w, uint_t n)
+{
+  uint_t j = 0;
+  for (; j + 4 <= n; j += 4) {
+    _mm_storeu_ps (s + j, _mm_mul_ps (_mm_loadu_ps (s + j),
+          _mm_loadu_ps (w + j)));
+  }
+  scalar_weight (s + j, w + j, n - j);
+}
+
+static void
+sse2_weighted_copy (const smpl_t * in, const smpl_t * w, smpl_t * out,
+    uint_t n)
+{
+  uint_t j = 0;
+  for (; j + 4 <= n; j += 4) {
+    _mm_storeu_ps (out + j, _mm_mul_ps (_mm_loadu_ps (in + j),
+          _mm_loadu_ps (w + j)));
+  }
+  scalar_weighted_copy (in + j, w + j, out + j, n - j);
+}
+
+static smpl_t
+sse2_sum (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  __m128 acc0 = _mm_setzero_ps (), acc1 = _mm_setzero_ps ();
+  for (; j + 8 <= n; j += 8) {
+    acc0 = _mm_add_ps (acc0, _mm_loadu_ps (s + j));
+    acc1 = _mm_add_ps (acc1, _mm_loadu_ps (s + j + 4));
+  }
+  return sse2_hsum (_mm_add_ps (acc0, acc1)) + scalar_sum (s + j, n - j);
+}
+
+static smpl_t
+sse2_sum_sq (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  __m128 acc0 = _mm_setzero_ps (), acc1 = _mm_setzero_ps ();
+  for (; j + 8 <= n; j += 8) {
+    __m128 v0 = _mm_loadu_ps (s + j), v1 = _mm_loadu_ps (s + j + 4);
+    acc0 = _mm_add_ps (acc0, _mm_mul_ps (v0, v0));
+    acc1 = _mm_add_ps (acc1, _mm_mul_ps (v1, v1));
+  }
+  return sse2_hsum (_mm_add_ps (acc0, acc1)) + scalar_sum_sq (s + j, n - j);
+}
+
+static smpl_t
+sse2_min (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  smpl_t tmp;
+  if (n < 4) return scalar_min (s, n);
+  __m128 acc = _mm_loadu_ps (s);
+  for (j = 4; j + 4 <= n; j += 4) {
+    acc = _mm_min_ps (acc, _mm_loadu_ps (s + j));
+  }
+  tmp = sse2_hmin (acc);
+  for (; j < n; j++) {
+    tmp = (tmp < s[j]) ? tmp : s[j];
+  }
+  return tmp;
+}
+
+static void
+sse2_add (smpl_t * s, smpl_t c, uint_t n)
+{
+  uint_t j = 0;
+  __m128 vc = _mm_set1_ps (c);
+  for (; j + 4 <= n; j += 4) {
+    _mm_storeu_ps (s + j, _mm_add_ps (_mm_loadu_ps (s + j), vc));
+  }
+  scalar_add (s + j, c, n - j);
+}
+
+static void
+sse2_spec_norm (const smpl_t * c, uint_t length, smpl_t * norm, uint_t n)
+{
+  uint_t i = 1;
+  for (; i + 4 <= n; i += 4) {
+    __m128 re = _mm_loadu_ps (c + i);
+    __m128 im = sse2_loadr (c + length - i - 3);
+    _mm_storeu_ps (norm + i, _mm_sqrt_ps (_mm_add_ps (_mm_mul_ps (re, re),
+            _mm_mul_ps (im, im))));
+  }
+  for (; i < n; i++) {
+    norm[i] = SQRT (SQR (c[i]) + SQR (c[length - i]));
+  }
+}
+
+static void
+sse2_spec_phas (const smpl_t * c, uint_t length, smpl_t * phas, uint_t n)
+{
+  uint_t i = 1;
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps (phas + i, sse2_atan2 (sse2_loadr (c + length - i - 3),
+          _mm_loadu_ps (c + i)));
+  }
+  for (; i < n; i++) {
+    phas[i] = ATAN2 (c[length - i], c[i]);
+  }
+}
+
+/* the notes that have not started yet are fed zeros */
+static void
+sse2_goertzel_block (const smpl_t * x, uint_t n, const smpl_t * coef,
+    const uint_t * start, smpl_t * s1, smpl_t * s2)
+{
+  __m128 c[GOERTZEL_VECTORS], a[GOERTZEL_VECTORS], b[GOERTZEL_VECTORS];
+  __m128 from[GOERTZEL_VECTORS];
+  uint_t i, k, first, last;
+  goertzel_starts (start, 4 * GOERTZEL_VECTORS, n, &first, &last);
+  for (k = 0; k < GOERTZEL_VECTORS; k++) {
+    c[k] = _mm_loadu_ps (coef + 4 * k);
+    from[k] = _mm_cvtepi32_ps (_mm_loadu_si128 ((const __m128i *)
+          (start + 4 * k)));
+    a[k] = b[k] = _mm_setzero_ps ();
+  }
+  for (i = first; i < last; i++) {
+    __m128 vx = _mm_set1_ps (x[i]), vi = _mm_set1_ps ((smpl_t)i);
+    for (k = 0; k < GOERTZEL_VECTORS; k++) {
+      __m128 in = _mm_and_ps (vx, _mm_cmple_ps (from[k], vi));
+      __m128 s = _mm_add_ps (_mm_sub_ps (in, b[k]), _mm_mul_ps (c[k], a[k]));
+      b[k] = a[k];
+      a[k] = s;
+    }
+  }
+  for (; i < n; i++) {
+    __m128 vx = _mm_set1_ps (x[i]);
+    for (k = 0; k < GOERTZEL_VECTORS; k++) {
+      __m128 s = _mm_add_ps (_mm_sub_ps (vx, b[k]), _mm_mul_ps (c[k], a[k]));
+      b[k] = a[k];
+      a[k] = s;
+    }
+  }
+  for (k = 0; k < GOERTZEL_VECTORS; k++) {
+    _mm_storeu_ps (s1 + 4 * k, a[k]);
+    _mm_storeu_ps (s2 + 4 * k, b[k]);
+  }
+}
+
+static void
+sse2_goertzel (const smpl_t * x, uint_t n, const smpl_t * coef,
+    const uint_t * start, smpl_t * s1, smpl_t * s2, uint_t notes)
+{
+  goertzel_blocks (sse2_goertzel_block, 4 * GOERTZEL_VECTORS, x, n, coef,
+      start, s1, s2, notes);
+}
+
+static const aubio_simd_t simd_sse2 = {
+  "sse2",
+  sse2_weight,
+  sse2_weighted_copy,
+  sse2_sum,
+  sse2_sum_sq,
+  sse2_min,
+  sse2_add,
+  sse2_spec_norm,
+  sse2_spec_phas,
+  sse2_goertzel
+};
+
+#ifdef HAVE_SIMD_AVX2
+
+/* AVX2 kernels, 8 floats wide, compiled for avx2 and fma whatever the
+ * global flags and only selected when CPUID reports both */
+
+static inline AVX2_TARGET smpl_t
+avx2_hsum (__m256 v)
+{
+  return sse2_hsum (_mm_add_ps (_mm256_castps256_ps128 (v),
+        _mm256_extractf128_ps (v, 1)));
+}
+
+static inline AVX2_TARGET __m256
+avx2_loadr (const smpl_t * s)
+{
+  return _mm256_permutevar8x32_ps (_mm256_loadu_ps (s),
+      _mm256_set_epi32 (0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+static inline AVX2_TARGET __m256
+avx2_atan2 (__m256 y, __m256 x)
+{
+  const __m256 sign = _mm256_set1_ps (-0.f);
+  __m256 ax = _mm256_andnot_ps (sign, x);
+  __m256 ay = _mm256_andnot_ps (sign, y);
+  __m256 mx = _mm256_max_ps (ax, ay);
+  __m256 mn = _mm256_min_ps (ax, ay);
+  __m256 a = _mm256_div_ps (mn, _mm256_add_ps (mx, _mm256_set1_ps (FLT_MIN)));
+  __m256 s = _mm256_mul_ps (a, a);
+  __m256 r = _mm256_set1_ps (ATAN_C11);
+  r = _mm256_fmadd_ps (r, s, _mm256_set1_ps (ATAN_C9));
+  r = _mm256_fmadd_ps (r, s, _mm256_set1_ps (ATAN_C7));
+  r = _mm256_fmadd_ps (r, s, _mm256_set1_ps (ATAN_C5));
+  r = _mm256_fmadd_ps (r, s, _mm256_set1_ps (ATAN_C3));
+  r = _mm256_fmadd_ps (r, s, _mm256_set1_ps (ATAN_C1));
+  r = _mm256_mul_ps (r, a);
+  r = _mm256_blendv_ps (r, _mm256_sub_ps (_mm256_set1_ps (PI / 2.), r),
+      _mm256_cmp_ps (ay, ax, _CMP_GT_OQ));
+  r = _mm256_blendv_ps (r, _mm256_sub_ps (_mm256_set1_ps (PI), r),
+      _mm256_cmp_ps (x, _mm256_setzero_ps (), _CMP_LT_OQ));
+  return _mm256_or_ps (r, _mm256_and_ps (sign, y));
+}
+
+static AVX2_TARGET void
+avx2_weight (smpl_t * s, const smpl_t * w, uint_t n)
+{
+  uint_t j = 0;
+  for (; j + 8 <= n; j += 8) {
+    _mm256_storeu_ps (s + j, _mm256_mul_ps (_mm256_loadu_ps (s + j),
+          _mm256_loadu_ps (w + j)));
+  }
+  sse2_weight (s + j, w + j, n - j);
+}
+
+static AVX2_TARGET void
+avx2_weighted_copy (const smpl_t * in, const smpl_t * w, smpl_t * out,
+    uint_t n)
+{
+  uint_t j = 0;
+  for (; j + 8 <= n; j += 8) {
+    _mm256_storeu_ps (out + j, _mm256_mul_ps (_mm256_loadu_ps (in + j),
+          _mm256_loadu_ps (w + j)));
+  }
+  sse2_weighted_copy (in + j, w + j, out + j, n - j);
+}
+
+static AVX2_TARGET smpl_t
+avx2_sum (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  __m256 acc0 = _mm256_setzero_ps (), acc1 = _mm256_setzero_ps ();
+  for (; j + 16 <= n; j += 16) {
+    acc0 = _mm256_add_ps (acc0, _mm256_loadu_ps (s + j));
+    acc1 = _mm256_add_ps (acc1, _mm256_loadu_ps (s + j + 8));
+  }
+  return avx2_hsum (_mm256_add_ps (acc0, acc1)) + sse2_sum (s + j, n - j);
+}
+
+static AVX2_TARGET smpl_t
+avx2_sum_sq (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  __m256 acc0 = _mm256_setzero_ps (), acc1 = _mm256_setzero_ps ();
+  for (; j + 16 <= n; j += 16) {
+    __m256 v0 = _mm256_loadu_ps (s + j), v1 = _mm256_loadu_ps (s + j + 8);
+    acc0 = _mm256_fmadd_ps (v0, v0, acc0);
+    acc1 = _mm256_fmadd_ps (v1, v1, acc1);
+  }
+  return avx2_hsum (_mm256_add_ps (acc0, acc1)) + sse2_sum_sq (s + j, n - j);
+}
+
+static AVX2_TARGET smpl_t
+avx2_min (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  smpl_t tmp;
+  if (n < 8) return sse2_min (s, n);
+  __m256 acc = _mm256_loadu_ps (s);
+  for (j = 8; j + 8 <= n; j += 8) {
+    acc = _mm256_min_ps (acc, _mm256_loadu_ps (s + j));
+  }
+  tmp = sse2_hmin (_mm_min_ps (_mm256_castps256_ps128 (acc),
+        _mm256_extractf128_ps (acc, 1)));
+  for (; j < n; j++) {
+    tmp = (tmp < s[j]) ? tmp : s[j];
+  }
+  return tmp;
+}
+
+static AVX2_TARGET void
+avx2_add (smpl_t * s, smpl_t c, uint_t n)
+{
+  uint_t j = 0;
+  __m256 vc = _mm256_set1_ps (c);
+  for (; j + 8 <= n; j += 8) {
+    _mm256_storeu_ps (s + j, _mm256_add_ps (_mm256_loadu_ps (s + j), vc));
+  }
+  sse2_add (s + j, c, n - j);
+}
+
+static AVX2_TARGET void
+avx2_spec_norm (const smpl_t * c, uint_t length, smpl_t * norm, uint_t n)
+{
+  uint_t i = 1;
+  for (; i + 8 <= n; i += 8) {
+    __m256 re = _mm256_loadu_ps (c + i);
+    __m256 im = avx2_loadr (c + length - i - 7);
+    _mm256_storeu_ps (norm + i, _mm256_sqrt_ps (_mm256_fmadd_ps (re, re,
+            _mm256_mul_ps (im, im))));
+  }
+  for (; i < n; i++) {
+    norm[i] = SQRT (SQR (c[i]) + SQR (c[length - i]));
+  }
+}
+
+static AVX2_TARGET void
+avx2_spec_phas (const smpl_t * c, uint_t length, smpl_t * phas, uint_t n)
+{
+  uint_t i = 1;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps (phas + i, avx2_atan2 (avx2_loadr (c + length - i - 7),
+          _mm256_loadu_ps (c + i)));
+  }
+  for (; i < n; i++) {
+    phas[i] = ATAN2 (c[length - i], c[i]);
+  }
+}
+
+static AVX2_TARGET void
+avx2_goertzel_block (const smpl_t * x, uint_t n, const smpl_t * coef,
+    const uint_t * start, smpl_t * s1, smpl_t * s2)
+{
+  __m256 c[GOERTZEL_VECTORS], a[GOERTZEL_VECTORS], b[GOERTZEL_VECTORS];
+  __m256 from[GOERTZEL_VECTORS];
+  uint_t i, k, first, last;
+  goertzel_starts (start, 8 * GOERTZEL_VECTORS, n, &first, &last);
+  for (k = 0; k < GOERTZEL_VECTORS; k++) {
+    c[k] = _mm256_loadu_ps (coef + 8 * k);
+    from[k] = _mm256_cvtepi32_ps (_mm256_loadu_si256 ((const __m256i *)
+          (start + 8 * k)));
+    a[k] = b[k] = _mm256_setzero_ps ();
+  }
+  for (i = first; i < last; i++) {
+    __m256 vx = _mm256_set1_ps (x[i]), vi = _mm256_set1_ps ((smpl_t)i);
+    for (k = 0; k < GOERTZEL_VECTORS; k++) {
+      __m256 in = _mm256_and_ps (vx, _mm256_cmp_ps (from[k], vi, _CMP_LE_OQ));
+      __m256 s = _mm256_fmadd_ps (c[k], a[k], _mm256_sub_ps (in, b[k]));
+      b[k] = a[k];
+      a[k] = s;
+    }
+  }
+  for (; i < n; i++) {
+    __m256 vx = _mm256_set1_ps (x[i]);
+    for (k = 0; k < GOERTZEL_VECTORS; k++) {
+      __m256 s = _mm256_fmadd_ps (c[k], a[k], _mm256_sub_ps (vx, b[k]));
+      b[k] = a[k];
+      a[k] = s;
+    }
+  }
+  for (k = 0; k < GOERTZEL_VECTORS; k++) {
+    _mm256_storeu_ps (s1 + 8 * k, a[k]);
+    _mm256_storeu_ps (s2 + 8 * k, b[k]);
+  }
+}
+
+static void
+avx2_goertzel (const smpl_t * x, uint_t n, const smpl_t * coef,
+    const uint_t * start, smpl_t * s1, smpl_t * s2, uint_t notes)
+{
+  goertzel_blocks (avx2_goertzel_block, 8 * GOERTZEL_VECTORS, x, n, coef,
+      start, s1, s2, notes);
+}
+
+static const aubio_simd_t simd_avx2 = {
+  "avx2",
+  avx2_weight,
+  avx2_weighted_copy,
+  avx2_sum,
+  avx2_sum_sq,
+  avx2_min,
+  avx2_add,
+  avx2_spec_norm,
+  avx2_spec_phas,
+  avx2_goertzel
+};
+
+#endif /* HAVE_SIMD_AVX2 */
+#endif /* HAVE_SIMD && __SSE2__ */
+
+#if defined(HAVE_SIMD) && defined(__ARM_NEON)
+
+/* NEON kernels, 4 floats wide; aarch64 only, where NEON is always there and
+ * has vector divide, square root and across-lanes reductions */
+
+static inline float32x4_t
+neon_loadr (const smpl_t * s)
+{
+  float32x4_t v = vrev64q_f32 (vld1q_f32 (s));
+  return vcombine_f32 (vget_high_f32 (v), vget_low_f32 (v));
+}
+
+static inline float32x4_t
+neon_atan2 (float32x4_t y, float32x4_t x)
+{
+  float32x4_t ax = vabsq_f32 (x);
+  float32x4_t ay = vabsq_f32 (y);
+  float32x4_t mx = vmaxq_f32 (ax, ay);
+  float32x4_t mn = vminq_f32 (ax, ay);
+  float32x4_t a = vdivq_f32 (mn, vaddq_f32 (mx, vdupq_n_f32 (FLT_MIN)));
+  float32x4_t s = vmulq_f32 (a, a);
+  float32x4_t r = vdupq_n_f32 (ATAN_C11);
+  r = vfmaq_f32 (vdupq_n_f32 (ATAN_C9), r, s);
+  r = vfmaq_f32 (vdupq_n_f32 (ATAN_C7), r, s);
+  r = vfmaq_f32 (vdupq_n_f32 (ATAN_C5), r, s);
+  r = vfmaq_f32 (vdupq_n_f32 (ATAN_C3), r, s);
+  r = vfmaq_f32 (vdupq_n_f32 (ATAN_C1), r, s);
+  r = vmulq_f32 (r, a);
+  r = vbslq_f32 (vcgtq_f32 (ay, ax),
+      vsubq_f32 (vdupq_n_f32 (PI / 2.), r), r);
+  r = vbslq_f32 (vcltq_f32 (x, vdupq_n_f32 (0.)),
+      vsubq_f32 (vdupq_n_f32 (PI), r), r);
+  return vbslq_f32 (vcltq_f32 (y, vdupq_n_f32 (0.)), vnegq_f32 (r), r);
+}
+
+static void
+neon_weight (smpl_t * s, const smpl_t * w, uint_t n)
+{
+  uint_t j = 0;
+  for (; j + 4 <= n; j += 4) {
+    vst1q_f32 (s + j, vmulq_f32 (vld1q_f32 (s + j), vld1q_f32 (w + j)));
+  }
+  scalar_weight (s + j, w + j, n - j);
+}
+
+static void
+neon_weighted_copy (const smpl_t * in, const smpl_t * w, smpl_t * out,
+    uint_t n)
+{
+  uint_t j = 0;
+  for (; j + 4 <= n; j += 4) {
+    vst1q_f32 (out + j, vmulq_f32 (vld1q_f32 (in + j), vld1q_f32 (w + j)));
+  }
+  scalar_weighted_copy (in + j, w + j, out + j, n - j);
+}
+
+static smpl_t
+neon_sum (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  float32x4_t acc0 = vdupq_n_f32 (0.), acc1 = vdupq_n_f32 (0.);
+  for (; j + 8 <= n; j += 8) {
+    acc0 = vaddq_f32 (acc0, vld1q_f32 (s + j));
+    acc1 = vaddq_f32 (acc1, vld1q_f32 (s + j + 4));
+  }
+  return vaddvq_f32 (vaddq_f32 (acc0, acc1)) + scalar_sum (s + j, n - j);
+}
+
+static smpl_t
+neon_sum_sq (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  float32x4_t acc0 = vdupq_n_f32 (0.), acc1 = vdupq_n_f32 (0.);
+  for (; j + 8 <= n; j += 8) {
+    float32x4_t v0 = vld1q_f32 (s + j), v1 = vld1q_f32 (s + j + 4);
+    acc0 = vfmaq_f32 (acc0, v0, v0);
+    acc1 = vfmaq_f32 (acc1, v1, v1);
+  }
+  return vaddvq_f32 (vaddq_f32 (acc0, acc1)) + scalar_sum_sq (s + j, n - j);
+}
+
+static smpl_t
+neon_min (const smpl_t * s, uint_t n)
+{
+  uint_t j = 0;
+  smpl_t tmp;
+  if (n < 4) return scalar_min (s, n);
+  float32x4_t acc = vld1q_f32 (s);
+  for (j = 4; j + 4 <= n; j += 4) {
+    acc = vminq_f32 (acc, vld1q_f32 (s + j));
+  }
+  tmp = vminvq_f32 (acc);
+  for (; j < n; j++) {
+    tmp = (tmp < s[j]) ? tmp : s[j];
+  }
+  return tmp;
+}
+
+static void
+neon_add (smpl_t * s, smpl_t c, uint_t n)
+{
+  uint_t j = 0;
+  float32x4_t vc = vdupq_n_f32 (c);
+  for (; j + 4 <= n; j += 4) {
+    vst1q_f32 (s + j, vaddq_f32 (vld1q_f32 (s + j), vc));
+  }
+  scalar_add (s + j, c, n - j);
+}
+
+static void
+neon_spec_norm (const smpl_t * c, uint_t length, smpl_t * norm, uint_t n)
+{
+  uint_t i = 1;
+  for (; i + 4 <= n; i += 4) {
+    float32x4_t re = vld1q_f32 (c + i);
+    float32x4_t im = neon_loadr (c + length - i - 3);
+    vst1q_f32 (norm + i, vsqrtq_f32 (vfmaq_f32 (vmulq_f32 (im, im), re, re)));
+  }
+  for (; i < n; i++) {
+    norm[i] = SQRT (SQR (c[i]) + SQR (c[length - i]));
+  }
+}
+
+static void
+neon_spec_phas (const smpl_t * c, uint_t length, smpl_t * phas, uint_t n)
+{
+  uint_t i = 1;
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32 (phas + i, neon_atan2 (neon_loadr (c + length - i - 3),
+          vld1q_f32 (c + i)));
+  }
+  for (; i < n; i++) {
+    phas[i] = ATAN2 (c[length - i], c[i]);
+  }
+}
+
+static void
+neon_goertzel_block (const smpl_t * x, uint_t n, const smpl_t * coef,
+    const uint_t * start, smpl_t * s1, smpl_t * s2)
+{
+  float32x4_t c[GOERTZEL_VECTORS], a[GOERTZEL_VECTORS], b[GOERTZEL_VECTORS];
+  float32x4_t from[GOERTZEL_VECTORS];
+  uint_t i, k, first, last;
+  goertzel_starts (start, 4 * GOERTZEL_VECTORS, n, &first, &last);
+  for (k = 0; k < GOERTZEL_VECTORS; k++) {
+    c[k] = vld1q_f32 (coef + 4 * k);
+    from[k] = vcvtq_f32_u32 (vld1q_u32 (start + 4 * k));
+    a[k] = b[k] = vdupq_n_f32 (0.);
+  }
+  for (i = first; i < last; i++) {
+    float32x4_t vx = vdupq_n_f32 (x[i]), vi = vdupq_n_f32 ((smpl_t)i);
+    for (k = 0; k < GOERTZEL_VECTORS; k++) {
+      float32x4_t in = vreinterpretq_f32_u32 (vandq_u32
+          (vreinterpretq_u32_f32 (vx), vcleq_f32 (from[k], vi)));
+      float32x4_t s = vfmaq_f32 (vsubq_f32 (in, b[k]), c[k], a[k]);
+      b[k] = a[k];
+      a[k] = s;
+    }
+  }
+  for (; i < n; i++) {
+    float32x4_t vx = vdupq_n_f32 (x[i]);
+    for (k = 0; k < GOERTZEL_VECTORS; k++) {
+      float32x4_t s = vfmaq_f32 (vsubq_f32 (vx, b[k]), c[k], a[k]);
+      b[k] = a[k];
+      a[k] = s;
+    }
+  }
+  for (k = 0; k < GOERTZEL_VECTORS; k++) {
+    vst1q_f32 (s1 + 4 * k, a[k]);
+    vst1q_f32 (s2 + 4 * k, b[k]);
+  }
+}
+
+static void
+neon_goertzel (const smpl_t * x, uint_t n, const smpl_t * coef,
+    const uint_t * start, smpl_t * s1, smpl_t * s2, uint_t notes)
+{
+  goertzel_blocks (neon_goertzel_block, 4 * GOERTZEL_VECTORS, x, n, coef,
+      start, s1, s2, notes);
+}
+
+static const aubio_simd_t simd_neon = {
+  "neon",
+  neon_weight,
+  neon_weighted_copy,
+  neon_sum,
+  neon_sum_sq,
+  neon_min,
+  neon_add,
+  neon_spec_norm,
+  neon_spec_phas,
+  neon_goertzel
+};
+
+#endif /* HAVE_SIMD && __ARM_NEON */
+
+const aubio_simd_t *aubio_simd = &simd_scalar;
+
+static uint_t aubio_simd_chosen = 0;
+
+static const aubio_simd_t *
+aubio_simd_best (void)
+{
+#if defined(HAVE_SIMD) && defined(__SSE2__)
+#ifdef HAVE_SIMD_AVX2
+  __builtin_cpu_init ();
+  if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma")) {
+    return &simd_avx2;
+  }
+#endif /* HAVE_SIMD_AVX2 */
+  return &simd_sse2;
+#elif defined(HAVE_SIMD) && defined(__ARM_NEON)
+  return &simd_neon;
+#else
+  return &simd_scalar;
+#endif
+}
+
+uint_t
+aubio_simd_init (const char_t * name)
+{
+  const aubio_simd_t *best = aubio_simd_best ();
+  if (!name) {
+    if (!aubio_simd_chosen) {
+      aubio_simd = best;
+      aubio_simd_chosen = 1;
+    }
+    return AUBIO_OK;
+  }
+  if (strcmp (name, "scalar") == 0) {
+    aubio_simd = &simd_scalar;
+#if defined(HAVE_SIMD) && defined(__SSE2__)
+  } else if (strcmp (name, "sse2") == 0) {
+    aubio_simd = &simd_sse2;
+#endif
+  } else if (strcmp (name, best->name) == 0) {
+    aubio_simd = best;
+  } else {
+    AUBIO_ERR ("simd: %s kernels are not available, using %s\n", name,
+        aubio_simd->name);
+    return AUBIO_FAIL;
+  }
+  aubio_simd_chosen = 1;
+  return AUBIO_OK;
+}
+
+const char_t *
+aubio_simd_get_name (void)
+{
+  return aubio_simd->name;
+}
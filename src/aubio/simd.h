@@ -0,0 +1,87 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Vectorized kernels for the hot ::fvec_t and spectrum loops
+
+  The kernels are gathered in a table of function pointers. Until
+  aubio_simd_init() is called, the table points to plain C versions; after
+  it, to the widest instruction set the CPU supports (SSE2 or AVX2 with FMA
+  on x86, checked with CPUID; NEON on aarch64).
+
+ */
+
+#ifndef AUBIO_SIMD_H
+#define AUBIO_SIMD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** kernel table */
+typedef struct {
+  const char_t *name;
+  /** s[i] *= w[i] */
+  void (*weight) (smpl_t * s, const smpl_t * w, uint_t n);
+  /** out[i] = in[i] * w[i] */
+  void (*weighted_copy) (const smpl_t * in, const smpl_t * w, smpl_t * out,
+      uint_t n);
+  /** sum of s[i] */
+  smpl_t (*sum) (const smpl_t * s, uint_t n);
+  /** sum of s[i]^2 */
+  smpl_t (*sum_sq) (const smpl_t * s, uint_t n);
+  /** smallest s[i] */
+  smpl_t (*min) (const smpl_t * s, uint_t n);
+  /** s[i] += c */
+  void (*add) (smpl_t * s, smpl_t c, uint_t n);
+  /** norm[i] = |compspec bin i| for 0 < i < n, see aubio_fft_get_norm() */
+  void (*spec_norm) (const smpl_t * compspec, uint_t length, smpl_t * norm,
+      uint_t n);
+  /** phas[i] = arg(compspec bin i) for 0 < i < n, see aubio_fft_get_phas() */
+  void (*spec_phas) (const smpl_t * compspec, uint_t length, smpl_t * phas,
+      uint_t n);
+  /** Goertzel resonator of each note k: s = x[i] + coef[k] * s1 - s2 for
+   * start[k] <= i < n, leaving the last two values of s in s1[k], s2[k] */
+  void (*goertzel) (const smpl_t * x, uint_t n, const smpl_t * coef,
+      const uint_t * start, smpl_t * s1, smpl_t * s2, uint_t notes);
+} aubio_simd_t;
+
+/** current kernel table */
+extern const aubio_simd_t *aubio_simd;
+
+/** select the kernel table
+
+  \param name one of `scalar`, `sse2`, `avx2`, `neon`, or NULL to pick the
+  widest one the CPU supports; NULL leaves an earlier choice untouched
+
+  \return 0 on success, non-zero if the requested kernels are not available
+
+*/
+uint_t aubio_simd_init (const char_t * name);
+
+/** name of the kernel table in use */
+const char_t *aubio_simd_get_name (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_SIMD_H */
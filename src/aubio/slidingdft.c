@@ -0,0 +1,157 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "mathutils.h"
+#include "musicutils.h"
+#include "spectral/slidingdft.h"
+
+/* damping of the resonators, per sample */
+#define AUBIO_SLIDINGDFT_DAMPING 0.9999
+
+struct _aubio_slidingdft_t
+{
+  uint_t win_s;
+  uint_t n_bins;
+  uint_t pos;           /**< oldest sample of the window */
+  fvec_t *window;       /**< last win_s samples, circular */
+  uint_t *bins;         /**< cycles per window of each bin */
+  smpl_t *rot_re;       /**< r exp(j 2 pi k / N) */
+  smpl_t *rot_im;
+  smpl_t *re;           /**< current value of each bin */
+  smpl_t *im;
+  smpl_t comb;          /**< r^N, applied to the sample leaving */
+  smpl_t scale;         /**< from a bin to the amplitude of its sinusoid */
+};
+
+aubio_slidingdft_t *
+new_aubio_slidingdft (uint_t win_s, uint_t n_bins)
+{
+  aubio_slidingdft_t *o = AUBIO_NEW (aubio_slidingdft_t);
+  uint_t k, last = win_s / 2 - 1;
+  smpl_t r = AUBIO_SLIDINGDFT_DAMPING, gain = 0.;
+  if ((sint_t)win_s < 4) {
+    AUBIO_ERR ("slidingdft: got win_s %d, but can not be < 4\n", win_s);
+    goto beach;
+  }
+  if ((sint_t)n_bins < 1 || n_bins > last) {
+    AUBIO_ERR ("slidingdft: got %d bins, but can not be < 1 or > %d\n",
+        n_bins, last);
+    goto beach;
+  }
+  o->win_s = win_s;
+  o->n_bins = n_bins;
+  o->window = new_fvec (win_s);
+  o->bins = AUBIO_ARRAY (uint_t, n_bins);
+  o->rot_re = AUBIO_ARRAY (smpl_t, n_bins);
+  o->rot_im = AUBIO_ARRAY (smpl_t, n_bins);
+  o->re = AUBIO_ARRAY (smpl_t, n_bins);
+  o->im = AUBIO_ARRAY (smpl_t, n_bins);
+  if (!o->window || !o->bins || !o->rot_re || !o->rot_im || !o->re || !o->im)
+    goto beach;
+  for (k = 0; k < n_bins; k++) {
+    /* from 1 to last cycles, geometrically, one apart at least and leaving
+     * room for the bins still to come */
+    smpl_t x = n_bins > 1 ? (smpl_t)k / (n_bins - 1) : 0.;
+    uint_t bin = (uint_t)ROUND (EXP (x * LOG ((smpl_t)last)));
+    if (k > 0) bin = MAX (bin, o->bins[k - 1] + 1);
+    o->bins[k] = MIN (bin, last - (n_bins - 1 - k));
+    o->rot_re[k] = r * COS (TWO_PI * o->bins[k] / win_s);
+    o->rot_im[k] = r * SIN (TWO_PI * o->bins[k] / win_s);
+  }
+  o->comb = POW (r, win_s);
+  /* a sinusoid at a bin adds up to half the sum of the window weights */
+  for (k = 0; k < win_s; k++) gain += POW (r, k);
+  o->scale = 2. / gain;
+  aubio_slidingdft_reset (o);
+  return o;
+
+beach:
+  del_aubio_slidingdft (o);
+  return NULL;
+}
+
+void
+del_aubio_slidingdft (aubio_slidingdft_t * o)
+{
+  if (o->window) del_fvec (o->window);
+  if (o->bins) AUBIO_FREE (o->bins);
+  if (o->rot_re) AUBIO_FREE (o->rot_re);
+  if (o->rot_im) AUBIO_FREE (o->rot_im);
+  if (o->re) AUBIO_FREE (o->re);
+  if (o->im) AUBIO_FREE (o->im);
+  AUBIO_FREE (o);
+}
+
+void
+aubio_slidingdft_do (aubio_slidingdft_t * o, const fvec_t * input)
+{
+  uint_t j, k, pos = o->pos, n_bins = o->n_bins;
+  smpl_t *window = o->window->data;
+  const smpl_t *rot_re = o->rot_re, *rot_im = o->rot_im;
+  smpl_t *re = o->re, *im = o->im;
+  for (j = 0; j < input->length; j++) {
+    smpl_t x = input->data[j];
+    smpl_t d = x - o->comb * window[pos];
+    window[pos] = x;
+    pos = pos + 1 == o->win_s ? 0 : pos + 1;
+    /* the bins do not depend on each other, this loop is vectorised */
+    for (k = 0; k < n_bins; k++) {
+      smpl_t a = re[k], b = im[k];
+      re[k] = rot_re[k] * a - rot_im[k] * b + d;
+      im[k] = rot_im[k] * a + rot_re[k] * b;
+    }
+  }
+  o->pos = pos;
+}
+
+void
+aubio_slidingdft_get_norm (const aubio_slidingdft_t * o, fvec_t * norm)
+{
+  uint_t k;
+  for (k = 0; k < o->n_bins; k++) {
+    norm->data[k] = o->scale * SQRT (SQR (o->re[k]) + SQR (o->im[k]));
+  }
+}
+
+uint_t
+aubio_slidingdft_get_bin (const aubio_slidingdft_t * o, uint_t bin)
+{
+  return o->bins[bin];
+}
+
+smpl_t
+aubio_slidingdft_get_db_spl (const aubio_slidingdft_t * o)
+{
+  return aubio_db_spl (o->window);
+}
+
+void
+aubio_slidingdft_reset (aubio_slidingdft_t * o)
+{
+  uint_t k;
+  fvec_zeros (o->window);
+  for (k = 0; k < o->n_bins; k++) {
+    o->re[k] = 0.;
+    o->im[k] = 0.;
+  }
+  o->pos = 0;
+}
@@ -24,8 +24,12 @@
 #include "spectral/fft.h"
 #include "spectral/specdesc.h"
 #include "mathutils.h"
+#include "musicutils.h"
 #include "utils/hist.h"
 
+/* pre-emphasis coefficient of the time-domain HFC */
+#define AUBIO_TDHFC_PREEMPHASIS 0.97
+
 void aubio_specdesc_energy(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset);
 void aubio_specdesc_hfc(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset);
 void aubio_specdesc_complex(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset);
@@ -34,6 +38,8 @@ void aubio_specdesc_specdiff(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_
 void aubio_specdesc_kl(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset);
 void aubio_specdesc_mkl(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset);
 void aubio_specdesc_specflux(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset);
+void aubio_specdesc_tdhfc(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset);
+void aubio_specdesc_all(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset);
 
 extern void aubio_specdesc_centroid (aubio_specdesc_t * o, const cvec_t * spec,
     fvec_t * desc);
@@ -60,6 +66,8 @@ typedef enum {
         aubio_onset_kl,             /**< Kullback Liebler */
         aubio_onset_mkl,            /**< modified Kullback Liebler */
         aubio_onset_specflux,       /**< spectral flux */
+        aubio_onset_tdhfc,          /**< time-domain high frequency content */
+        aubio_onset_all,            /**< all of the above, in one pass */
         aubio_specmethod_centroid,  /**< spectral centroid */
         aubio_specmethod_spread,    /**< spectral spread */
         aubio_specmethod_skewness,  /**< spectral skewness */
@@ -79,9 +87,18 @@ struct _aubio_specdesc_t {
   smpl_t threshold;      /**< minimum norm threshold for phase and specdiff */
   fvec_t *oldmag;        /**< previous norm vector */
   fvec_t *dev1 ;         /**< current onset detection measure vector */
+  fvec_t *dev2 ;         /**< second measure vector, specdiff in `all` mode */
   fvec_t *theta1;        /**< previous phase vector, one frame behind */
   fvec_t *theta2;        /**< previous phase vector, two frames behind */
   aubio_hist_t * histog; /**< histogram */
+  aubio_hist_t * histog2; /**< second histogram, specdiff in `all` mode */
+  fvec_t *rect;          /**< current frame, real then imaginary parts */
+  fvec_t *phasor1;       /**< previous frame as unit phasors, one behind */
+  fvec_t *phasor2;       /**< previous frame as unit phasors, two behind */
+  fvec_t *packed;        /**< phase deviations as a packed spectrum */
+  cvec_t *deviation;     /**< phase of packed */
+  const fvec_t *window;  /**< analysis window, for time-domain descriptors */
+  fvec_t *weights;       /**< squared pre-emphasis response, for tdhfc */
 };
 
 
@@ -105,6 +122,61 @@ void aubio_specdesc_hfc(aubio_specdesc_t *o UNUSED,
   }
 }
 
+/* Energy of the frame after a pre-emphasis 1 - a z^-1. The filter is applied
+ * circularly to the windowed frame, so that the spectrum of the result is
+ * exactly the spectrum of the frame times 1 - a e^(-iw): the spectral and
+ * time-domain versions compute the same value. */
+void aubio_specdesc_tdhfc (aubio_specdesc_t *o,
+    const cvec_t * fftgrain, fvec_t * onset) {
+  uint_t j;
+  onset->data[0] = 0.;
+  for (j=0;j<fftgrain->length;j++) {
+    onset->data[0] += o->weights->data[j] * SQR(fftgrain->norm[j]);
+  }
+}
+
+/* Time-domain versions of energy and tdhfc. With z the windowed frame, of
+ * length N, Parseval gives the sum over the N/2+1 bins of the half spectrum:
+ *
+ *   sum |Z_j|^2 = (N sum z^2 + Z_0^2 + Z_N/2^2) / 2
+ *
+ * where Z_0 = sum z and Z_N/2 = sum (-1)^n z, the last term only for even N.
+ * For tdhfc, the pre-emphasised frame has energy
+ * (1 + a^2) sum z^2 - 2 a sum z[n] z[n-1], and its first and middle bins are
+ * (1 - a) Z_0 and (1 + a) Z_N/2. */
+static void
+aubio_specdesc_do_window (aubio_specdesc_t *o, const fvec_t * frame,
+    fvec_t * desc)
+{
+  const smpl_t *x = frame->data, *w = o->window->data;
+  uint_t n, length = frame->length;
+  smpl_t energy = 0., lag1 = 0., even = 0., odd = 0.;
+  smpl_t first, middle, a = AUBIO_TDHFC_PREEMPHASIS;
+  for (n = 0; n + 1 < length; n += 2) {
+    smpl_t z0 = w[n] * x[n], z1 = w[n + 1] * x[n + 1];
+    energy += z0 * z0 + z1 * z1;
+    even += z0;
+    odd += z1;
+  }
+  if (n < length) {
+    smpl_t z0 = w[n] * x[n];
+    energy += z0 * z0;
+    even += z0;
+  }
+  first = even + odd;
+  middle = (length & 1) ? 0. : even - odd;
+  if (o->onset_type == aubio_onset_energy) {
+    desc->data[0] = (length * energy + SQR(first) + SQR(middle)) / 2.;
+    return;
+  }
+  /* circular lag, the first sample following the last one */
+  lag1 = w[0] * x[0] * w[length - 1] * x[length - 1];
+  for (n = 1; n < length; n++) {
+    lag1 += w[n] * x[n] * w[n - 1] * x[n - 1];
+  }
+  desc->data[0] = (length * ((1. + a * a) * energy - 2. * a * lag1)
+      + SQR((1. - a) * first) + SQR((1. + a) * middle)) / 2.;
+}
 
 /* Complex Domain Method onset detection function */
 void aubio_specdesc_complex (aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_t * onset) {
@@ -159,6 +231,103 @@ void aubio_specdesc_phase(aubio_specdesc_t *o,
   //onset->data[0] = fvec_mean(o->dev1);
 }
 
+/* Rectangular versions of complex and phase, reading the packed spectrum
+ * of aubio_fft_do_complex(). The previous frames are kept as unit phasors
+ * u = X / |X|, or 1 where |X| = 0 as ATAN2(0, 0) = 0. The phase predicted
+ * from them, 2 phi1 - phi2, is the phase of u1^2 conj(u2): its conjugate
+ * conj(u1)^2 u2 turns the phase of X into the deviation from it, and the
+ * real part of the product is |X| cos(deviation), as the polar versions
+ * compute, without any trigonometric function. */
+
+/* unpack compspec into o->rect, real parts then imaginary parts */
+static void
+aubio_specdesc_unpack (aubio_specdesc_t *o, const fvec_t * compspec)
+{
+  uint_t j, length = compspec->length, nbins = length / 2 + 1;
+  smpl_t *re = o->rect->data, *im = re + nbins;
+  for (j = 0; j < nbins; j++) {
+    re[j] = compspec->data[j];
+  }
+  im[0] = 0.;
+  for (j = 1; j < (length + 1) / 2; j++) {
+    im[j] = compspec->data[length - j];
+  }
+  if (!(length & 1)) im[nbins - 1] = 0.;
+}
+
+/* shift the phasors by one frame, returns |X| */
+static inline smpl_t
+aubio_specdesc_push_phasor (smpl_t re, smpl_t im, smpl_t * p1r,
+    smpl_t * p1i, smpl_t * p2r, smpl_t * p2i)
+{
+  smpl_t r = SQRT (SQR (re) + SQR (im));
+  smpl_t inv = r > 0. ? 1. / r : 0.;
+  *p2r = *p1r;
+  *p2i = *p1i;
+  *p1r = r > 0. ? re * inv : 1.;
+  *p1i = im * inv;
+  return r;
+}
+
+static void
+aubio_specdesc_complex_rect (aubio_specdesc_t *o, const fvec_t * compspec,
+    fvec_t * onset)
+{
+  uint_t j, nbins = compspec->length / 2 + 1;
+  smpl_t *re = o->rect->data, *im = re + nbins, *oldmag = o->oldmag->data;
+  smpl_t *p1r = o->phasor1->data, *p1i = p1r + nbins;
+  smpl_t *p2r = o->phasor2->data, *p2i = p2r + nbins;
+  smpl_t sum = 0.;
+  aubio_specdesc_unpack (o, compspec);
+  for (j = 0; j < nbins; j++) {
+    /* conj(u1)^2 u2 */
+    smpl_t ar = SQR (p1r[j]) - SQR (p1i[j]), ai = -2. * p1r[j] * p1i[j];
+    smpl_t zr = ar * p2r[j] - ai * p2i[j], zi = ar * p2i[j] + ai * p2r[j];
+    smpl_t dot = re[j] * zr - im[j] * zi;
+    smpl_t r = aubio_specdesc_push_phasor (re[j], im[j], &p1r[j], &p1i[j],
+        &p2r[j], &p2i[j]);
+    sum += SQRT (ABS (SQR (oldmag[j]) + SQR (r) - 2. * oldmag[j] * dot));
+    oldmag[j] = r;
+  }
+  onset->data[0] = sum;
+}
+
+static void
+aubio_specdesc_phase_rect (aubio_specdesc_t *o, const fvec_t * compspec,
+    fvec_t * onset)
+{
+  uint_t j, length = compspec->length, nbins = length / 2 + 1;
+  smpl_t *re = o->rect->data, *im = re + nbins;
+  smpl_t *p1r = o->phasor1->data, *p1i = p1r + nbins;
+  smpl_t *p2r = o->phasor2->data, *p2i = p2r + nbins;
+  smpl_t threshold = o->threshold;
+  aubio_specdesc_unpack (o, compspec);
+  for (j = 0; j < nbins; j++) {
+    smpl_t ar = SQR (p1r[j]) - SQR (p1i[j]), ai = -2. * p1r[j] * p1i[j];
+    smpl_t zr = ar * p2r[j] - ai * p2i[j], zi = ar * p2i[j] + ai * p2r[j];
+    smpl_t yr = re[j] * zr - im[j] * zi, yi = re[j] * zi + im[j] * zr;
+    smpl_t r = aubio_specdesc_push_phasor (re[j], im[j], &p1r[j], &p1i[j],
+        &p2r[j], &p2i[j]);
+    /* bins below the threshold get a deviation of 0 */
+    re[j] = threshold < r ? yr : 1.;
+    im[j] = threshold < r ? yi : 0.;
+  }
+  /* pack the products to take their phase with the fft helpers */
+  for (j = 0; j < nbins; j++) {
+    o->packed->data[j] = re[j];
+  }
+  for (j = 1; j < (length + 1) / 2; j++) {
+    o->packed->data[length - j] = im[j];
+  }
+  aubio_fft_get_phas (o->packed, o->deviation);
+  for (j = 0; j < nbins; j++) {
+    o->dev1->data[j] = ABS (o->deviation->phas[j]);
+  }
+  aubio_hist_dyn_notnull(o->histog,o->dev1);
+  aubio_hist_weight(o->histog);
+  onset->data[0] = aubio_hist_mean(o->histog);
+}
+
 /* Spectral difference method onset detection function */
 void aubio_specdesc_specdiff(aubio_specdesc_t *o,
     const cvec_t * fftgrain, fvec_t * onset){
@@ -223,6 +392,58 @@ void aubio_specdesc_specflux(aubio_specdesc_t *o, const cvec_t * fftgrain, fvec_
   }
 }
 
+/* All onset detection functions at once. The terms that only need the
+ * norms are computed in a first loop, which the compiler can vectorise;
+ * the ones calling COS, LOG or aubio_unwrap2pi() follow in a second loop,
+ * which also keeps track of the past frames for everyone. Gives the same
+ * values as the separate functions, up to rounding, in the order of
+ * aubio_specdesc_onset_index. */
+void aubio_specdesc_all(aubio_specdesc_t *o, const cvec_t * fftgrain,
+    fvec_t * onset){
+  uint_t j;
+  uint_t nbins = fftgrain->length;
+  smpl_t energy = 0., hfc = 0., cplx = 0., kl = 0., mkl = 0., flux = 0.;
+  smpl_t threshold = o->threshold, bin = 0., zero = 0.;
+  const smpl_t *norm = fftgrain->norm, *phas = fftgrain->phas;
+  smpl_t *oldmag = o->oldmag->data, *dev1 = o->dev1->data,
+         *dev2 = o->dev2->data, *theta1 = o->theta1->data,
+         *theta2 = o->theta2->data;
+  for (j = 0; j < nbins; j++) {
+    smpl_t n = norm[j], old = oldmag[j], diff = n - old;
+    energy += SQR(n);
+    bin += 1.;
+    hfc += bin * n;
+    flux += diff > zero ? diff : zero;
+    dev2[j] = threshold < n ? SQRT(ABS(SQR(n) - SQR(old))) : zero;
+  }
+  for (j = 0; j < nbins; j++) {
+    smpl_t n = norm[j], old = oldmag[j];
+    smpl_t pred = 2. * theta1[j] - theta2[j];
+    smpl_t ratio = LOG(1. + n / (old + 1.e-1));
+    cplx += SQRT (ABS (SQR (old) + SQR (n)
+          - 2 * old * n * COS (pred - phas[j])));
+    dev1[j] = threshold < n ?
+      ABS(aubio_unwrap2pi(phas[j] - 2.0 * theta1[j] + theta2[j])) : 0.;
+    kl += n * ratio;
+    mkl += ratio;
+    theta2[j] = theta1[j];
+    theta1[j] = phas[j];
+    oldmag[j] = n;
+  }
+  onset->data[aubio_specdesc_onset_energy] = energy;
+  onset->data[aubio_specdesc_onset_hfc] = hfc;
+  onset->data[aubio_specdesc_onset_complex] = cplx;
+  aubio_hist_dyn_notnull(o->histog, o->dev1);
+  aubio_hist_weight(o->histog);
+  onset->data[aubio_specdesc_onset_phase] = aubio_hist_mean(o->histog);
+  aubio_hist_dyn_notnull(o->histog2, o->dev2);
+  aubio_hist_weight(o->histog2);
+  onset->data[aubio_specdesc_onset_specdiff] = aubio_hist_mean(o->histog2);
+  onset->data[aubio_specdesc_onset_kl] = isnan(kl) ? 0. : kl;
+  onset->data[aubio_specdesc_onset_mkl] = isnan(mkl) ? 0. : mkl;
+  onset->data[aubio_specdesc_onset_specflux] = flux;
+}
+
 /* Generic function pointing to the choosen one */
 void 
 aubio_specdesc_do (aubio_specdesc_t *o, const cvec_t * fftgrain, 
@@ -236,7 +457,7 @@ aubio_specdesc_do (aubio_specdesc_t *o, const cvec_t * fftgrain,
 aubio_specdesc_t * 
 new_aubio_specdesc (const char_t * onset_mode, uint_t size){
   aubio_specdesc_t * o = AUBIO_NEW(aubio_specdesc_t);
-  uint_t rsize = size/2+1;
+  uint_t rsize = size/2+1, j;
   aubio_specdesc_type onset_type;
   if (strcmp (onset_mode, "energy") == 0)
       onset_type = aubio_onset_energy;
@@ -244,6 +465,8 @@ new_aubio_specdesc (const char_t * onset_mode, uint_t size){
       onset_type = aubio_onset_specdiff;
   else if (strcmp (onset_mode, "hfc") == 0)
       onset_type = aubio_onset_hfc;
+  else if (strcmp (onset_mode, "tdhfc") == 0)
+      onset_type = aubio_onset_tdhfc;
   else if (strcmp (onset_mode, "complexdomain") == 0)
       onset_type = aubio_onset_complex;
   else if (strcmp (onset_mode, "complex") == 0)
@@ -256,6 +479,8 @@ new_aubio_specdesc (const char_t * onset_mode, uint_t size){
       onset_type = aubio_onset_kl;
   else if (strcmp (onset_mode, "specflux") == 0)
       onset_type = aubio_onset_specflux;
+  else if (strcmp (onset_mode, "all") == 0)
+      onset_type = aubio_onset_all;
   else if (strcmp (onset_mode, "centroid") == 0)
       onset_type = aubio_specmethod_centroid;
   else if (strcmp (onset_mode, "spread") == 0)
@@ -279,15 +504,27 @@ new_aubio_specdesc (const char_t * onset_mode, uint_t size){
   switch(onset_type) {
     /* for both energy and hfc, only fftgrain->norm is required */
     case aubio_onset_energy: 
+      o->window = aubio_window_acquire ("hanningz", size);
       break;
     case aubio_onset_hfc:
       break;
+    case aubio_onset_tdhfc:
+      o->window = aubio_window_acquire ("hanningz", size);
+      o->weights = new_fvec(rsize);
+      for (j = 0; j < rsize; j++) {
+        smpl_t a = AUBIO_TDHFC_PREEMPHASIS;
+        o->weights->data[j] = 1. + a * a - 2. * a * COS(TWO_PI * j / size);
+      }
+      break;
       /* the other approaches will need some more memory spaces */
     case aubio_onset_complex:
       o->oldmag = new_fvec(rsize);
       o->dev1   = new_fvec(rsize);
       o->theta1 = new_fvec(rsize);
       o->theta2 = new_fvec(rsize);
+      o->rect = new_fvec(2 * rsize);
+      o->phasor1 = new_fvec(2 * rsize);
+      o->phasor2 = new_fvec(2 * rsize);
       break;
     case aubio_onset_phase:
       o->dev1   = new_fvec(rsize);
@@ -295,6 +532,11 @@ new_aubio_specdesc (const char_t * onset_mode, uint_t size){
       o->theta2 = new_fvec(rsize);
       o->histog = new_aubio_hist(0.0, PI, 10);
       o->threshold = 0.1;
+      o->rect = new_fvec(2 * rsize);
+      o->phasor1 = new_fvec(2 * rsize);
+      o->phasor2 = new_fvec(2 * rsize);
+      o->packed = new_fvec(size);
+      o->deviation = new_cvec(size);
       break;
     case aubio_onset_specdiff:
       o->oldmag = new_fvec(rsize);
@@ -307,6 +549,16 @@ new_aubio_specdesc (const char_t * onset_mode, uint_t size){
     case aubio_onset_specflux:
       o->oldmag = new_fvec(rsize);
       break;
+    case aubio_onset_all:
+      o->oldmag = new_fvec(rsize);
+      o->dev1   = new_fvec(rsize);
+      o->dev2   = new_fvec(rsize);
+      o->theta1 = new_fvec(rsize);
+      o->theta2 = new_fvec(rsize);
+      o->histog = new_aubio_hist(0.0, PI, 10);
+      o->histog2 = new_aubio_hist(0.0, PI, 10);
+      o->threshold = 0.1;
+      break;
     default:
       break;
   }
@@ -336,6 +588,12 @@ new_aubio_specdesc (const char_t * onset_mode, uint_t size){
     case aubio_onset_specflux:
       o->funcpointer = aubio_specdesc_specflux;
       break;
+    case aubio_onset_tdhfc:
+      o->funcpointer = aubio_specdesc_tdhfc;
+      break;
+    case aubio_onset_all:
+      o->funcpointer = aubio_specdesc_all;
+      break;
     case aubio_specmethod_centroid:
       o->funcpointer = aubio_specdesc_centroid;
       break;
@@ -361,10 +619,71 @@ new_aubio_specdesc (const char_t * onset_mode, uint_t size){
       break;
   }
   o->onset_type = onset_type;
+  aubio_specdesc_reset(o);
   return o;
 }
 
+uint_t aubio_specdesc_is_time_domain (const aubio_specdesc_t *o) {
+  return o->window != NULL;
+}
+
+void aubio_specdesc_do_frame (aubio_specdesc_t *o, const fvec_t * frame,
+    fvec_t * desc) {
+  if (o->window && frame->length == o->window->length) {
+    aubio_specdesc_do_window (o, frame, desc);
+  } else {
+    desc->data[0] = 0.;
+  }
+}
+
+uint_t aubio_specdesc_needs_phase (const aubio_specdesc_t *o) {
+  switch(o->onset_type) {
+    case aubio_onset_complex:
+    case aubio_onset_phase:
+    case aubio_onset_all:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+uint_t aubio_specdesc_takes_compspec (const aubio_specdesc_t *o) {
+  return o->phasor1 != NULL;
+}
+
+void aubio_specdesc_do_compspec (aubio_specdesc_t *o, const fvec_t * compspec,
+    fvec_t * desc) {
+  if (!o->phasor1 || compspec->length / 2 + 1 != o->dev1->length) {
+    desc->data[0] = 0.;
+  } else if (o->onset_type == aubio_onset_complex) {
+    aubio_specdesc_complex_rect (o, compspec, desc);
+  } else {
+    aubio_specdesc_phase_rect (o, compspec, desc);
+  }
+}
+
+void aubio_specdesc_reset (aubio_specdesc_t *o) {
+  if (o->oldmag) fvec_zeros(o->oldmag);
+  if (o->theta1) fvec_zeros(o->theta1);
+  if (o->theta2) fvec_zeros(o->theta2);
+  if (o->phasor1) {
+    uint_t nbins = o->phasor1->length / 2;
+    /* phase 0 */
+    fvec_set_all(o->phasor1, 1.);
+    fvec_set_all(o->phasor2, 1.);
+    memset(o->phasor1->data + nbins, 0, nbins * sizeof(smpl_t));
+    memset(o->phasor2->data + nbins, 0, nbins * sizeof(smpl_t));
+  }
+}
+
 void del_aubio_specdesc (aubio_specdesc_t *o){
+  if (o->rect) del_fvec(o->rect);
+  if (o->phasor1) del_fvec(o->phasor1);
+  if (o->phasor2) del_fvec(o->phasor2);
+  if (o->packed) del_fvec(o->packed);
+  if (o->deviation) del_cvec(o->deviation);
+  if (o->window) aubio_window_release(o->window);
+  if (o->weights) del_fvec(o->weights);
   switch(o->onset_type) {
     case aubio_onset_energy: 
       break;
@@ -392,6 +711,15 @@ void del_aubio_specdesc (aubio_specdesc_t *o){
     case aubio_onset_specflux:
       del_fvec(o->oldmag);
       break;
+    case aubio_onset_all:
+      del_fvec(o->oldmag);
+      del_fvec(o->dev1);
+      del_fvec(o->dev2);
+      del_fvec(o->theta1);
+      del_fvec(o->theta2);
+      del_aubio_hist(o->histog);
+      del_aubio_hist(o->histog2);
+      break;
     default:
       break;
   }
@@ -22,10 +22,23 @@
 
   Fast Fourier Transform
 
-  Depending on how aubio was compiled, FFT are computed using one of:
-    - [Ooura](http://www.kurims.kyoto-u.ac.jp/~ooura/fft.html)
-    - [FFTW3](http://www.fftw.org)
-    - [vDSP](https://developer.apple.com/library/mac/#documentation/Accelerate/Reference/vDSPRef/Reference/reference.html)
+  FFT are computed by one of the following backends:
+    - `ooura`, [Ooura](http://www.kurims.kyoto-u.ac.jp/~ooura/fft.html),
+      power of two sizes only
+    - `mixfft`, the built-in mixed-radix FFT (see spectral/mixfft.h), any size
+    - `pffft`, [PFFFT](https://bitbucket.org/jpommier/pffft), SSE or NEON
+      (see spectral/pffft.h), single precision only, multiples of 32 made of
+      factors 2, 3 and 5
+    - `fftw3f` (or `fftw3` in double precision), [FFTW3](http://www.fftw.org),
+      when compiled with `HAVE_FFTW3`, for instance with `make FFTW=yes`
+    - `accelerate`, [vDSP](https://developer.apple.com/library/mac/#documentation/Accelerate/Reference/vDSPRef/Reference/reference.html),
+      when compiled with `HAVE_ACCELERATE`, power of two sizes only
+
+  new_aubio_fft() uses FFTW3 or vDSP when available; otherwise `pffft` for
+  the sizes it takes when built with SSE or NEON, then `ooura` for powers of
+  two and `mixfft` for other sizes. All plans and twiddle tables
+  are computed at creation time, so that the first transform costs no more
+  than the next ones.
 
   \example src/spectral/test-fft.c
 
@@ -51,6 +64,34 @@ typedef struct _aubio_fft_t aubio_fft_t;
 
 */
 aubio_fft_t * new_aubio_fft (uint_t size);
+/** create new FFT computation object with a given backend
+
+  \param size length of the FFT
+  \param backend name of the backend, as listed above, or `default`
+
+  \return new FFT object, or NULL if `backend` is unknown, was not compiled
+  in, or does not support `size`
+
+*/
+aubio_fft_t * new_aubio_fft_with_backend (uint_t size, const char_t * backend);
+
+/** get the name of the backend used by an FFT object
+
+  \param s fft object as returned by new_aubio_fft
+
+*/
+const char_t * aubio_fft_get_backend (const aubio_fft_t * s);
+
+/** list the backends compiled in
+
+  \param i index of the backend, from 0
+
+  \return name of the `i`-th backend compiled in, as accepted by
+  new_aubio_fft_with_backend(), or NULL past the last one
+
+*/
+const char_t * aubio_fft_get_backend_name (uint_t i);
+
 /** delete FFT object
 
   \param s fft object as returned by new_aubio_fft
@@ -66,6 +107,31 @@ void del_aubio_fft(aubio_fft_t * s);
 
 */
 void aubio_fft_do (aubio_fft_t *s, const fvec_t * input, cvec_t * spectrum);
+/** compute forward FFT, magnitudes only
+
+  Same as aubio_fft_do(), without the `atan2` per bin; `spectrum->phas` is
+  left untouched.
+
+  \param s fft object as returned by new_aubio_fft
+  \param input input signal
+  \param spectrum output spectrum, only the norm is written
+
+*/
+void aubio_fft_do_norm (aubio_fft_t *s, const fvec_t * input, cvec_t * spectrum);
+/** compute forward FFT, norm and phase of the lowest bins only
+
+  Same as aubio_fft_do(), for detectors that look at part of the spectrum:
+  the bins from `bins` on are left untouched.
+
+  \param s fft object as returned by new_aubio_fft
+  \param input input signal
+  \param spectrum output spectrum
+  \param bins number of bins to write, all of them if larger than
+  `spectrum->length`
+
+*/
+void aubio_fft_do_bins (aubio_fft_t *s, const fvec_t * input,
+    cvec_t * spectrum, uint_t bins);
 /** compute backward (inverse) FFT
 
   \param s fft object as returned by new_aubio_fft
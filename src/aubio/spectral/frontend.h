@@ -0,0 +1,172 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Shared analysis front-end
+
+  A front-end keeps one sliding buffer holding the last `max_win_s` samples
+  of the signal, fed one hop at a time with aubio_frontend_do(). Detectors
+  running on the same signal read their analysis frame from it, at any
+  window size up to `max_win_s`, instead of each sliding its own copy.
+
+  Spectra are computed on demand, at most once per hop and window size, with
+  the same `hanningz` window and fftshift as ::aubio_pvoc_t, so that an onset
+  detector and a pitch detector using the same window size share one FFT.
+  The phase of a spectrum is only computed if one of its readers asks for it.
+
+  The level of each hop is also computed once and shared: detectors reading
+  from a front-end skip their spectra on hops quieter than their silence
+  threshold, where they could not report anything anyway.
+
+  See aubio_onset_do_frontend() and aubio_pitch_do_frontend(). A detector
+  keeps its own history between calls, the previous frames of a spectral
+  descriptor or the input buffer of a pitch method, and its front-end and
+  plain variants do not update the same one: stick to one of the two
+  functions for a given object. The same goes for aubio_specdesc_do() and
+  aubio_specdesc_do_compspec().
+
+*/
+
+#ifndef AUBIO_FRONTEND_H
+#define AUBIO_FRONTEND_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** front-end object */
+typedef struct _aubio_frontend_t aubio_frontend_t;
+
+/** create a front-end
+
+  \param max_win_s longest analysis window that will be read from it
+  \param hop_s number of new samples passed to each aubio_frontend_do()
+
+*/
+aubio_frontend_t *new_aubio_frontend (uint_t max_win_s, uint_t hop_s);
+
+/** delete a front-end
+
+  \param f front-end as returned by new_aubio_frontend()
+
+*/
+void del_aubio_frontend (aubio_frontend_t * f);
+
+/** prepare spectra of a given window size
+
+  Allocates what aubio_frontend_get_spectrum() needs for this window size.
+  Call it once per size before processing; asking twice for the same size is
+  harmless.
+
+  \param f front-end as returned by new_aubio_frontend()
+  \param win_s window size, not larger than `max_win_s`
+
+  \return 0 on success, non-zero otherwise
+
+*/
+uint_t aubio_frontend_add_spectrum (aubio_frontend_t * f, uint_t win_s);
+
+/** push a new hop of samples
+
+  \param f front-end as returned by new_aubio_frontend()
+  \param hop new samples, `hop_s` long
+
+*/
+void aubio_frontend_do (aubio_frontend_t * f, const fvec_t * hop);
+
+/** get a view of the latest hop
+
+  \param f front-end as returned by new_aubio_frontend()
+  \param hop vector set to point to the last `hop_s` samples
+
+*/
+void aubio_frontend_get_hop (aubio_frontend_t * f, fvec_t * hop);
+
+/** get a view of the latest analysis frame
+
+  \param f front-end as returned by new_aubio_frontend()
+  \param win_s frame length, not larger than `max_win_s`
+  \param frame vector set to point to the last `win_s` samples
+
+  \return 0 on success, non-zero if `win_s` is too long
+
+*/
+uint_t aubio_frontend_get_frame (aubio_frontend_t * f, uint_t win_s,
+    fvec_t * frame);
+
+/** check whether spectra of a given window size were prepared
+
+  \param f front-end as returned by new_aubio_frontend()
+  \param win_s window size
+
+  \return 1 if aubio_frontend_add_spectrum() was called for `win_s`, 0
+  otherwise
+
+*/
+uint_t aubio_frontend_has_spectrum (aubio_frontend_t * f, uint_t win_s);
+
+/** get the level of the latest hop
+
+  \param f front-end as returned by new_aubio_frontend()
+
+  \return level in dB SPL, as aubio_db_spl() would compute it on the hop
+
+*/
+smpl_t aubio_frontend_get_db_spl (aubio_frontend_t * f);
+
+/** get the spectrum of the latest analysis frame
+
+  \param f front-end as returned by new_aubio_frontend()
+  \param win_s window size, prepared with aubio_frontend_add_spectrum()
+  \param phase 1 if the phase is needed, 0 if the norm is enough
+
+  \return spectrum, valid until the next aubio_frontend_do(), or NULL if no
+  spectrum was prepared for `win_s`
+
+*/
+const cvec_t *aubio_frontend_get_spectrum (aubio_frontend_t * f,
+    uint_t win_s, uint_t phase);
+
+/** get the packed spectrum of the latest analysis frame
+
+  \param f front-end as returned by new_aubio_frontend()
+  \param win_s window size, prepared with aubio_frontend_add_spectrum()
+
+  \return real and imaginary parts, laid out as by aubio_fft_do_complex(),
+  valid until the next aubio_frontend_do(), or NULL if no spectrum was
+  prepared for `win_s`
+
+*/
+const fvec_t *aubio_frontend_get_compspec (aubio_frontend_t * f,
+    uint_t win_s);
+
+/** get the number of FFTs computed so far
+
+  \param f front-end as returned by new_aubio_frontend()
+
+*/
+uint_t aubio_frontend_get_ffts (const aubio_frontend_t * f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_FRONTEND_H */
@@ -0,0 +1,95 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Mixed-radix real FFT
+
+  Self-contained real FFT used as one of the ::aubio_fft_t backends. It
+  accepts any length of at least 2: the length is factored into radix 4, 2
+  and 3 stages, other prime factors being handled by a generic (slower)
+  butterfly.
+
+  The complex transforms are Stockham autosort passes over split real and
+  imaginary arrays, so that each butterfly loop runs over contiguous data
+  and is vectorised by the compiler; all twiddle factors are computed when
+  the object is created. Even lengths are computed as a complex FFT of half
+  the length.
+
+  Spectra use the same packed layout as aubio_fft_do_complex():
+
+    [ r0, r1, ..., r(N/2), i((N+1)/2 - 1), ..., i2, i1 ]
+
+  This header is internal to aubio; use ::aubio_fft_t instead.
+
+*/
+
+#ifndef AUBIO_MIXFFT_H
+#define AUBIO_MIXFFT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** mixed-radix FFT object */
+typedef struct _aubio_mixfft_t aubio_mixfft_t;
+
+/** create a mixed-radix FFT
+
+  \param size length of the transform, at least 2
+
+*/
+aubio_mixfft_t * new_aubio_mixfft (uint_t size);
+
+/** delete a mixed-radix FFT
+
+  \param m object as returned by new_aubio_mixfft()
+
+*/
+void del_aubio_mixfft (aubio_mixfft_t * m);
+
+/** compute the forward transform of a real signal
+
+  \param m object as returned by new_aubio_mixfft()
+  \param in `size` input samples
+  \param compspec `size` output values, packed as described above
+
+  The transform is not normalised.
+
+*/
+void aubio_mixfft_do (aubio_mixfft_t * m, const smpl_t * in, smpl_t * compspec);
+
+/** compute the backward transform of a packed spectrum
+
+  \param m object as returned by new_aubio_mixfft()
+  \param compspec `size` input values, packed as described above
+  \param out `size` output samples
+
+  The output is scaled by `1/size`, so that it is the inverse of
+  aubio_mixfft_do().
+
+*/
+void aubio_mixfft_rdo (aubio_mixfft_t * m, const smpl_t * compspec, smpl_t * out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_MIXFFT_H */
@@ -82,6 +82,18 @@ void aubio_pvoc_do(aubio_pvoc_t *pv, const fvec_t *in, cvec_t * fftgrain);
 */
 void aubio_pvoc_rdo(aubio_pvoc_t *pv, cvec_t * fftgrain, fvec_t *out);
 
+/** choose whether aubio_pvoc_do() computes the phase of each bin
+
+  The phase costs one `atan2` per bin. When the caller only reads
+  `fftgrain->norm`, it can be turned off and `fftgrain->phas` is then left
+  untouched. Enabled by default.
+
+  \param pv phase vocoder object as returned by new_aubio_pvoc
+  \param phase 1 to compute norm and phase, 0 for the norm only
+
+*/
+uint_t aubio_pvoc_set_phase(aubio_pvoc_t *pv, uint_t phase);
+
 /** get window size
 
   \param pv phase vocoder to get the window size from
@@ -0,0 +1,119 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Sliding discrete Fourier transform
+
+  A few bins of the DFT of the last `win_s` samples, updated with every new
+  sample instead of once per hop. Each bin is a complex resonator fed with
+  the difference between the new sample and the one leaving the window:
+
+  \f$ X_k(n) = r e^{j 2 \pi k / N} X_k(n-1) + x(n) - r^N x(n-N) \f$
+
+  The damping \f$ r \f$, just below 1, keeps rounding errors from piling up
+  in single precision; it weights the window by \f$ r^m \f$ for a sample
+  \f$ m \f$ samples old.
+
+  The bins are spread logarithmically over the spectrum, at whole numbers
+  of cycles per window, so that a small set covers it from the lowest to the
+  highest octave. A bin costs a complex multiply per sample, whatever
+  `win_s`.
+
+  Jacobsen, E., Lyons, R. (2003) "The sliding DFT", IEEE Signal Processing
+  Magazine 20(2), 74-80.
+
+*/
+
+#ifndef AUBIO_SLIDINGDFT_H
+#define AUBIO_SLIDINGDFT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** sliding DFT object */
+typedef struct _aubio_slidingdft_t aubio_slidingdft_t;
+
+/** create a sliding DFT
+
+  \param win_s number of samples in the window, at least 4
+  \param n_bins number of bins, at most `win_s / 2 - 1`
+
+  The window starts filled with zeros.
+
+*/
+aubio_slidingdft_t *new_aubio_slidingdft (uint_t win_s, uint_t n_bins);
+
+/** delete a sliding DFT
+
+  \param o object as returned by new_aubio_slidingdft()
+
+*/
+void del_aubio_slidingdft (aubio_slidingdft_t * o);
+
+/** slide the window over new samples
+
+  \param o object as returned by new_aubio_slidingdft()
+  \param input new samples, of any length
+
+*/
+void aubio_slidingdft_do (aubio_slidingdft_t * o, const fvec_t * input);
+
+/** get the magnitude of each bin
+
+  \param o object as returned by new_aubio_slidingdft()
+  \param norm output vector of length `n_bins`, filled with the magnitudes
+  scaled so that a sinusoid of amplitude 1 at the centre of a bin reads 1
+
+*/
+void aubio_slidingdft_get_norm (const aubio_slidingdft_t * o, fvec_t * norm);
+
+/** get the frequency of a bin
+
+  \param o object as returned by new_aubio_slidingdft()
+  \param bin bin number, from 0 to `n_bins - 1`
+
+  \return number of cycles per window at the centre of the bin
+
+*/
+uint_t aubio_slidingdft_get_bin (const aubio_slidingdft_t * o, uint_t bin);
+
+/** get the level of the window
+
+  \param o object as returned by new_aubio_slidingdft()
+
+  \return level of the last `win_s` samples, in dB SPL, see aubio_db_spl()
+
+*/
+smpl_t aubio_slidingdft_get_db_spl (const aubio_slidingdft_t * o);
+
+/** reset the window and the bins to zeros
+
+  \param o object as returned by new_aubio_slidingdft()
+
+*/
+void aubio_slidingdft_reset (aubio_slidingdft_t * o);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_SLIDINGDFT_H */
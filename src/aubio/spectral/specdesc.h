@@ -37,6 +37,8 @@
   \b \p energy : Energy based onset detection function
 
   This function calculates the local energy of the input spectral frame.
+  It can also be computed from the signal frame, see
+  aubio_specdesc_do_frame().
 
   \b \p hfc : High Frequency Content onset detection function
 
@@ -46,6 +48,13 @@
   Paul Masri. Computer modeling of Sound for Transformation and Synthesis of
   Musical Signal. PhD dissertation, University of Bristol, UK, 1996.
 
+  \b \p tdhfc : Time-domain High Frequency Content
+
+  Energy of the frame after a pre-emphasis filter `1 - 0.97 z^-1`, which
+  weights each bin by the squared response of the filter, close to the
+  square of its frequency. Like `energy`, it is meant to be computed from
+  the signal frame with aubio_specdesc_do_frame(), without any FFT.
+
   \b \p complex : Complex Domain Method onset detection function
 
   Christopher Duxbury, Mike E. Davies, and Mark B. Sandler. Complex domain
@@ -83,6 +92,14 @@
   International Conference on Digital Audio Effects'' (DAFx-06), Montreal,
   Canada, 2006.
 
+  \b \p all : All of the above
+
+  Computes the eight onset detection functions above in a single pass over
+  the spectrum, sharing the previous frames between them. The output vector
+  must be at least ::aubio_specdesc_n_onsets long; each value is stored at
+  its ::aubio_specdesc_onset_index and equals, up to rounding, the one the
+  corresponding method computes on its own.
+
   \subsection shapedesc Spectral shape descriptors
 
   The following descriptors are described in:
@@ -155,6 +172,19 @@ extern "C" {
 /** spectral description structure */
 typedef struct _aubio_specdesc_t aubio_specdesc_t;
 
+/** position of each onset detection function in the output of `all` */
+typedef enum {
+  aubio_specdesc_onset_energy,    /**< `energy` */
+  aubio_specdesc_onset_hfc,       /**< `hfc` */
+  aubio_specdesc_onset_complex,   /**< `complex` */
+  aubio_specdesc_onset_phase,     /**< `phase` */
+  aubio_specdesc_onset_specdiff,  /**< `specdiff` */
+  aubio_specdesc_onset_kl,        /**< `kl` */
+  aubio_specdesc_onset_mkl,       /**< `mkl` */
+  aubio_specdesc_onset_specflux,  /**< `specflux` */
+  aubio_specdesc_n_onsets         /**< number of onset detection functions */
+} aubio_specdesc_onset_index;
+
 /** execute spectral description function on a spectral frame
 
   Generic function to compute spectral description.
@@ -175,6 +205,7 @@ void aubio_specdesc_do (aubio_specdesc_t * o, const cvec_t * fftgrain,
   The parameter \p method is a string that can be any of:
 
     - `energy`, `hfc`, `complex`, `phase`, `specdiff`, `kl`, `mkl`, `specflux`
+    - `tdhfc`
     - `centroid`, `spread`, `skewness`, `kurtosis`, `slope`, `decrease`, `rolloff`
 
 */
@@ -187,6 +218,90 @@ aubio_specdesc_t *new_aubio_specdesc (const char_t * method, uint_t buf_size);
 */
 void del_aubio_specdesc (aubio_specdesc_t * o);
 
+/** check whether a spectral descriptor reads the phase of its input
+
+  Only `complex` and `phase` do; all the others read `fftgrain->norm` only,
+  so the phase vocoder feeding them can skip the phase computation, see
+  aubio_pvoc_set_phase().
+
+  \param o spectral descriptor object as returned by new_aubio_specdesc()
+
+  \return 1 if the descriptor needs `fftgrain->phas`, 0 otherwise
+
+*/
+uint_t aubio_specdesc_needs_phase (const aubio_specdesc_t * o);
+
+/** check whether a spectral descriptor can be computed from the signal
+
+  Only `energy` and `tdhfc` can: see aubio_specdesc_do_frame().
+
+  \param o spectral descriptor object as returned by new_aubio_specdesc()
+
+  \return 1 if aubio_specdesc_do_frame() can be used, 0 otherwise
+
+*/
+uint_t aubio_specdesc_is_time_domain (const aubio_specdesc_t * o);
+
+/** compute a spectral description from the signal frame
+
+  Applies the same `hanningz` window as ::aubio_pvoc_t and computes, by
+  Parseval's theorem, the value aubio_specdesc_do() would give on the
+  spectrum of the frame, up to rounding. This takes O(N) operations
+  instead of an FFT.
+
+  \param o spectral descriptor object as returned by new_aubio_specdesc(), for
+  which aubio_specdesc_is_time_domain() is 1
+  \param frame last `buf_size` samples of the signal, oldest first
+  \param desc output vector, one sample long; set to 0 if `o` can not be
+  computed from the signal
+
+*/
+void aubio_specdesc_do_frame (aubio_specdesc_t * o, const fvec_t * frame,
+    fvec_t * desc);
+
+/** check whether a spectral descriptor can read a packed spectrum
+
+  Only `complex` and `phase` can: see aubio_specdesc_do_compspec().
+
+  \param o spectral descriptor object as returned by new_aubio_specdesc()
+
+  \return 1 if aubio_specdesc_do_compspec() can be used, 0 otherwise
+
+*/
+uint_t aubio_specdesc_takes_compspec (const aubio_specdesc_t * o);
+
+/** compute a spectral description from a packed spectrum
+
+  Same as aubio_specdesc_do(), but reads the real and imaginary parts output
+  by aubio_fft_do_complex() instead of a norm and a phase. The previous
+  frames are kept as unit phasors, so that the phase prediction needs
+  complex products instead of `cos` and `atan2`: `complex` runs without any
+  trigonometric function, and `phase` takes only the phase of the
+  deviations, with aubio_fft_get_phas(). The results match aubio_specdesc_do()
+  up to rounding, but an object should only be fed through one of the two,
+  see frontend.h.
+
+  \param o spectral descriptor object as returned by new_aubio_specdesc(), for
+  which aubio_specdesc_takes_compspec() is 1
+  \param compspec packed spectrum of `buf_size` values, as computed by
+  aubio_fft_do_complex()
+  \param desc output vector, one sample long; set to 0 if `o` can not read
+  a packed spectrum
+
+*/
+void aubio_specdesc_do_compspec (aubio_specdesc_t * o,
+    const fvec_t * compspec, fvec_t * desc);
+
+/** forget the previous frames
+
+  Clears the norm and phase history, as if the last frames had been silent,
+  so that the next description compares its frame to silence.
+
+  \param o spectral descriptor object as returned by new_aubio_specdesc()
+
+*/
+void aubio_specdesc_reset (aubio_specdesc_t * o);
+
 #ifdef __cplusplus
 }
 #endif
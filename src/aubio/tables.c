@@ -0,0 +1,117 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "utils/tables.h"
+
+#include <pthread.h>
+
+#define AUBIO_TABLE_KIND_LENGTH 32
+
+typedef struct _aubio_table_t aubio_table_t;
+
+struct _aubio_table_t {
+  aubio_table_t *next;                   /**< next table in the cache */
+  char_t kind[AUBIO_TABLE_KIND_LENGTH];  /**< kind of table */
+  uint_t size;                           /**< size of the table */
+  uint_t samplerate;                     /**< samplerate of the table */
+  uint_t refs;                           /**< objects holding the table */
+  void *data;                            /**< the table itself */
+};
+
+static pthread_mutex_t aubio_tables_mutex = PTHREAD_MUTEX_INITIALIZER;
+static aubio_table_t *aubio_tables = NULL;
+static uint_t aubio_tables_count = 0;
+
+const void *
+aubio_table_acquire (const char_t * kind, uint_t size, uint_t samplerate,
+    uint_t bytes, aubio_table_init_t init)
+{
+  aubio_table_t *t;
+  void *data = NULL;
+  if (strlen (kind) >= AUBIO_TABLE_KIND_LENGTH) {
+    AUBIO_ERR ("tables: kind %s is too long\n", kind);
+    return NULL;
+  }
+  pthread_mutex_lock (&aubio_tables_mutex);
+  for (t = aubio_tables; t; t = t->next) {
+    if (t->size == size && t->samplerate == samplerate
+        && strcmp (t->kind, kind) == 0) {
+      t->refs++;
+      data = t->data;
+      goto done;
+    }
+  }
+  /* shared between objects, so allocated with calloc rather than in the
+   * arena the caller may have entered */
+  t = (aubio_table_t *)calloc (1, sizeof (aubio_table_t));
+  if (!t) goto done;
+  t->data = calloc (bytes ? bytes : 1, 1);
+  if (!t->data) {
+    free (t);
+    goto done;
+  }
+  /* a table only half built must not be found by the next caller */
+  if (init (t->data, kind, size, samplerate) != AUBIO_OK) {
+    free (t->data);
+    free (t);
+    goto done;
+  }
+  strcpy (t->kind, kind);
+  t->size = size;
+  t->samplerate = samplerate;
+  t->refs = 1;
+  t->next = aubio_tables;
+  aubio_tables = t;
+  aubio_tables_count++;
+  data = t->data;
+done:
+  pthread_mutex_unlock (&aubio_tables_mutex);
+  return data;
+}
+
+void
+aubio_table_release (const void * data)
+{
+  aubio_table_t **p;
+  pthread_mutex_lock (&aubio_tables_mutex);
+  for (p = &aubio_tables; *p; p = &(*p)->next) {
+    aubio_table_t *t = *p;
+    if (t->data != data) continue;
+    if (--t->refs == 0) {
+      *p = t->next;
+      free (t->data);
+      free (t);
+      aubio_tables_count--;
+    }
+    break;
+  }
+  pthread_mutex_unlock (&aubio_tables_mutex);
+}
+
+uint_t
+aubio_table_get_count (void)
+{
+  uint_t count;
+  pthread_mutex_lock (&aubio_tables_mutex);
+  count = aubio_tables_count;
+  pthread_mutex_unlock (&aubio_tables_mutex);
+  return count;
+}
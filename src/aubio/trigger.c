@@ -0,0 +1,200 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "aubio_priv.h"
+#include "fvec.h"
+#include "mathutils.h"
+#include "spectral/slidingdft.h"
+#include "utils/median.h"
+#include "onset/trigger.h"
+
+#define AUBIO_TRIGGER_BINS 16
+/* magnitudes are floored there, -60 dB, so that the tails of the hits do
+ * not flicker above their envelope once they reach the noise floor */
+#define AUBIO_TRIGGER_FLOOR 1e-3
+/* the median covers this many windows of the past flux */
+#define AUBIO_TRIGGER_HISTORY 2
+/* the peak envelope of each bin holds its peaks that long, in seconds: the
+ * window is shorter than the period of low notes, their magnitudes swing
+ * at that period */
+#define AUBIO_TRIGGER_HOLD 0.02
+/* and then falls at this rate, in nepers per second: 400 dB/s, faster
+ * than most drums ring */
+#define AUBIO_TRIGGER_RELEASE 46.
+
+struct _aubio_trigger_t
+{
+  aubio_slidingdft_t *sdft;
+  aubio_median_t *median;       /**< median of the recent flux */
+  fvec_t *mag;                  /**< log magnitudes of the bins */
+  fvec_t *peak;                 /**< their peak envelope, before this block */
+  uint_t *age;                  /**< blocks since each peak */
+  uint_t hold;                  /**< blocks a peak is held */
+  smpl_t release;               /**< fall of the envelope, per block */
+  smpl_t threshold;
+  smpl_t silence;
+  smpl_t level;                 /**< level at the last onset, in dB */
+  uint_t block_s;
+  uint_t fill;                  /**< samples of the current block seen */
+  uint_t samplerate;
+  uint_t minioi;                /**< minimum inter onset interval, samples */
+  uint_t total_frames;          /**< samples seen since the beginning */
+  uint_t last_onset;            /**< frame of the last onset */
+  uint_t n_onsets;
+};
+
+aubio_trigger_t *
+new_aubio_trigger (uint_t win_s, uint_t block_s, uint_t samplerate)
+{
+  aubio_trigger_t *o = AUBIO_NEW (aubio_trigger_t);
+  uint_t n_bins = MIN (AUBIO_TRIGGER_BINS, win_s / 2 - 1);
+  if ((sint_t)block_s < 1 || block_s > win_s) {
+    AUBIO_ERR ("trigger: got block_s %d, but can not be < 1 or > %d\n",
+        block_s, win_s);
+    goto beach;
+  }
+  if ((sint_t)samplerate < 1) {
+    AUBIO_ERR ("trigger: got samplerate %d, but can not be < 1\n",
+        samplerate);
+    goto beach;
+  }
+  o->sdft = new_aubio_slidingdft (win_s, n_bins);
+  if (!o->sdft) goto beach;
+  o->median = new_aubio_median (AUBIO_TRIGGER_HISTORY * win_s / block_s);
+  o->mag = new_fvec (n_bins);
+  o->peak = new_fvec (n_bins);
+  o->age = AUBIO_ARRAY (uint_t, n_bins);
+  if (!o->median || !o->mag || !o->peak || !o->age) goto beach;
+  o->block_s = block_s;
+  o->samplerate = samplerate;
+  o->hold = (uint_t)ROUND (AUBIO_TRIGGER_HOLD * samplerate / block_s);
+  o->release = AUBIO_TRIGGER_RELEASE * block_s / samplerate;
+  aubio_trigger_set_threshold (o, 0.3);
+  aubio_trigger_set_silence (o, -70.);
+  aubio_trigger_set_minioi_ms (o, 20.);
+  fvec_set_all (o->peak, LOG (AUBIO_TRIGGER_FLOOR));
+  return o;
+
+beach:
+  del_aubio_trigger (o);
+  return NULL;
+}
+
+void
+del_aubio_trigger (aubio_trigger_t * o)
+{
+  if (o->sdft) del_aubio_slidingdft (o->sdft);
+  if (o->median) del_aubio_median (o->median);
+  if (o->mag) del_fvec (o->mag);
+  if (o->peak) del_fvec (o->peak);
+  if (o->age) AUBIO_FREE (o->age);
+  AUBIO_FREE (o);
+}
+
+/* read the bins at the end of a block, and tell whether an onset is there */
+static uint_t
+aubio_trigger_detect (aubio_trigger_t * o)
+{
+  uint_t k, onset = 0;
+  smpl_t flux = 0.;
+  aubio_slidingdft_get_norm (o->sdft, o->mag);
+  /* rise of each bin over its recent peak rather than over the last block:
+   * the magnitudes of noisy sounds flicker from one block to the next, but
+   * seldom above their peaks */
+  for (k = 0; k < o->mag->length; k++) {
+    smpl_t mag = LOG (MAX (o->mag->data[k], AUBIO_TRIGGER_FLOOR));
+    flux += MAX (mag - o->peak->data[k], 0.);
+    if (mag >= o->peak->data[k]) {
+      o->peak->data[k] = mag;
+      o->age[k] = 0;
+    } else if (o->age[k] < o->hold) {
+      o->age[k]++;
+    } else {
+      o->peak->data[k] = MAX (mag, o->peak->data[k] - o->release);
+    }
+  }
+  flux /= o->mag->length;
+  /* no look-ahead: the block is compared to the ones before it only */
+  if (flux - aubio_median_get (o->median) > o->threshold
+      && (o->n_onsets == 0 || o->total_frames - o->last_onset > o->minioi)) {
+    smpl_t level = aubio_slidingdft_get_db_spl (o->sdft);
+    if (level >= o->silence) {
+      o->level = level;
+      o->last_onset = o->total_frames;
+      o->n_onsets++;
+      onset = 1;
+    }
+  }
+  aubio_median_push (o->median, flux);
+  return onset;
+}
+
+void
+aubio_trigger_do (aubio_trigger_t * o, const fvec_t * input, fvec_t * onset)
+{
+  uint_t i = 0;
+  fvec_t block;
+  onset->data[0] = 0.;
+  while (i < input->length) {
+    block.data = input->data + i;
+    block.length = MIN (o->block_s - o->fill, input->length - i);
+    aubio_slidingdft_do (o->sdft, &block);
+    o->fill += block.length;
+    o->total_frames += block.length;
+    i += block.length;
+    if (o->fill == o->block_s) {
+      o->fill = 0;
+      if (aubio_trigger_detect (o)) onset->data[0] = i;
+    }
+  }
+}
+
+uint_t
+aubio_trigger_set_threshold (aubio_trigger_t * o, smpl_t threshold)
+{
+  o->threshold = threshold;
+  return AUBIO_OK;
+}
+
+uint_t
+aubio_trigger_set_silence (aubio_trigger_t * o, smpl_t silence)
+{
+  o->silence = silence;
+  return AUBIO_OK;
+}
+
+uint_t
+aubio_trigger_set_minioi_ms (aubio_trigger_t * o, smpl_t minioi)
+{
+  o->minioi = (uint_t)ROUND (minioi * o->samplerate / 1000.);
+  return AUBIO_OK;
+}
+
+smpl_t
+aubio_trigger_get_level (const aubio_trigger_t * o)
+{
+  return o->level;
+}
+
+uint_t
+aubio_trigger_get_delay (const aubio_trigger_t * o)
+{
+  return o->block_s;
+}
@@ -0,0 +1,103 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Memory arena
+
+  An arena hands out zeroed, 64-byte aligned blocks from a few large chunks
+  of memory, one after the other, so that the buffers of an object end up
+  next to each other in the order they were created. Chunks are touched
+  when they are allocated, and optionally locked in memory, so that using
+  the objects later never page faults.
+
+  While an arena is entered, every object the calling thread creates with
+  the new_aubio_ functions takes its memory from the arena. Deleting such an
+  object while the arena is entered releases whatever it holds outside of it,
+  such as FFTW plans, and leaves the arena memory alone: all of it is given
+  back at once by del_aubio_arena().
+
+*/
+
+#ifndef AUBIO_ARENA_H
+#define AUBIO_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** memory arena object */
+typedef struct _aubio_arena_t aubio_arena_t;
+
+/** create a memory arena
+
+  \param size size of each chunk, in bytes; blocks larger than a quarter of
+  it that do not fit in the current chunk get a chunk of their own
+  \param lock if non-zero, try to lock the chunks in memory
+
+*/
+aubio_arena_t * new_aubio_arena (uint_t size, uint_t lock);
+
+/** delete a memory arena and all the memory taken from it
+
+  \param a object as returned by new_aubio_arena()
+
+*/
+void del_aubio_arena (aubio_arena_t * a);
+
+/** take the memory of the objects the calling thread creates from an arena
+
+  \param a object as returned by new_aubio_arena()
+
+  Arenas can be nested, each aubio_arena_enter() must be followed by an
+  aubio_arena_leave() on the same thread.
+
+*/
+void aubio_arena_enter (aubio_arena_t * a);
+
+/** go back to the arena entered before, or to the heap
+
+  \param a the arena last entered by the calling thread
+
+*/
+void aubio_arena_leave (aubio_arena_t * a);
+
+/** take a zeroed, 64-byte aligned block from an arena
+
+  \param a object as returned by new_aubio_arena()
+  \param size size of the block, in bytes
+
+  \return the block, or NULL if no memory was left
+
+*/
+void * aubio_arena_alloc (aubio_arena_t * a, uint_t size);
+
+/** get the number of bytes taken from an arena so far
+
+  \param a object as returned by new_aubio_arena()
+
+*/
+uint_t aubio_arena_get_used (const aubio_arena_t * a);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_ARENA_H */
@@ -0,0 +1,98 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Moving median
+
+  Median of the last `win_s` values of a stream, updated in O(log win_s)
+  for each new value. The values are kept in a circular buffer and indexed
+  by two heaps placed on each side of the median: a max-heap of the values
+  below it and a min-heap of the values above it. Pushing a value replaces
+  the oldest one in place and sifts it through the heaps.
+
+  The window starts filled with zeros and all memory is allocated when the
+  object is created, so that aubio_median_push() and aubio_median_get() are
+  real-time safe.
+
+*/
+
+#ifndef AUBIO_MEDIAN_H
+#define AUBIO_MEDIAN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** moving median object */
+typedef struct _aubio_median_t aubio_median_t;
+
+/** create a moving median
+
+  \param win_s number of values in the window, at least 1
+
+*/
+aubio_median_t * new_aubio_median (uint_t win_s);
+
+/** delete a moving median
+
+  \param m object as returned by new_aubio_median()
+
+*/
+void del_aubio_median (aubio_median_t * m);
+
+/** push a new value, evicting the oldest one
+
+  \param m object as returned by new_aubio_median()
+  \param input new value
+
+*/
+void aubio_median_push (aubio_median_t * m, smpl_t input);
+
+/** get the median of the current window
+
+  \param m object as returned by new_aubio_median()
+
+  \return the value of rank `(win_s - 1) / 2` in the window, the same value
+  fvec_median() would return on a copy of it
+
+*/
+smpl_t aubio_median_get (const aubio_median_t * m);
+
+/** copy the current window, oldest value first
+
+  \param m object as returned by new_aubio_median()
+  \param out output vector of length `win_s`
+
+*/
+void aubio_median_get_window (const aubio_median_t * m, fvec_t * out);
+
+/** reset the window to zeros
+
+  \param m object as returned by new_aubio_median()
+
+*/
+void aubio_median_reset (aubio_median_t * m);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_MEDIAN_H */
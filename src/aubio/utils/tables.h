@@ -0,0 +1,90 @@
+/*
+  Copyright (C) 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  This file is part of aubio.
+
+  aubio is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  aubio is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with aubio.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/** \file
+
+  Shared tables
+
+  Process-wide cache of read-only tables, such as windows, weightings or FFT
+  twiddles, keyed by their kind, size and samplerate. The first object to
+  ask for a table builds it, the next ones get the same copy, and the table
+  is freed when the last of them releases it.
+
+  Tables live outside of any arena (see utils/arena.h), since they outlive
+  the object that built them. Getting and releasing tables takes a lock: do
+  it when creating and deleting objects, not while processing.
+
+*/
+
+#ifndef AUBIO_TABLES_H
+#define AUBIO_TABLES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** function filling a new table
+
+  \param data zeroed memory of the size given to aubio_table_acquire()
+  \param kind kind of table
+  \param size size of the table
+  \param samplerate samplerate of the table
+
+  \return 0 if the table was filled, non-zero if not, in which case
+  aubio_table_acquire() does not keep it
+
+*/
+typedef uint_t (*aubio_table_init_t) (void * data, const char_t * kind,
+    uint_t size, uint_t samplerate);
+
+/** get a shared table, building it if it does not exist yet
+
+  \param kind kind of table, at most 31 characters
+  \param size size of the table, in elements
+  \param samplerate samplerate the table was computed for, 0 if none
+  \param bytes memory the table takes
+  \param init function building the table the first time
+
+  \return the table, to be released with aubio_table_release(), or NULL if
+  it could not be allocated or built
+
+*/
+const void * aubio_table_acquire (const char_t * kind, uint_t size,
+    uint_t samplerate, uint_t bytes, aubio_table_init_t init);
+
+/** release a shared table
+
+  \param data table as returned by aubio_table_acquire()
+
+*/
+void aubio_table_release (const void * data);
+
+/** get the number of shared tables in use
+
+  \return tables currently held by at least one object
+
+*/
+uint_t aubio_table_get_count (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUBIO_TABLES_H */
@@ -22,15 +22,22 @@
 #include <stdarg.h>
 #include <algorithm>
 #include "RingBuffer.h"
+#include "harmonizer.h"
 #include "types.h"
 #include "fvec.h"
 #include "cvec.h"
 #include "lvec.h"
 #include "musicutils.h"
 #include "vecutils.h"
+#include "utils/median.h"
+#include "utils/arena.h"
+#include "spectral/frontend.h"
+#include "spectral/specdesc.h"
 #include "pitch/pitch.h"
 #include "onset/onset.h"
+#include "onset/trigger.h"
 #include "mathutils.h"
+#include "simd.h"
 
 #include "lv2/lv2plug.in/ns/ext/atom/atom.h"
 #include <lv2/lv2plug.in/ns/ext/urid/urid.h>
@@ -38,12 +45,35 @@
 #include "lv2/lv2plug.in/ns/ext/atom/util.h"
 #include "lv2/lv2plug.in/ns/ext/midi/midi.h"
 #include "lv2/lv2plug.in/ns/ext/log/logger.h"
+#include "lv2/lv2plug.in/ns/ext/worker/worker.h"
 #include "lv2/lv2plug.in/ns/lv2core/lv2.h"
 
-#define HARMONIZER_URI "http://dsheeler.org/plugins/harmonizer"
 #define RB_SIZE 16384
-#define NUM_ONSET_METHODS 9
-#define NUM_PITCH_METHODS 6
+/* arena chunks hold this many pitch windows: the buffers of a window size
+ * are then packed together, the few longer ones get chunks of their own */
+#define ARENA_SIZE_FACTOR 4
+/* drum trigger: a 2.9 ms sliding DFT, read every 0.36 ms, at 44.1 kHz */
+#define TRIGGER_WIN_SIZE 128
+#define TRIGGER_BLOCK_SIZE 16
+/* attacks are looked for in blocks of a quarter hop, within these bounds */
+#define ATTACK_MIN_BLOCK 16
+#define ATTACK_MAX_BLOCK 64
+#define ATTACK_MAX_BLOCKS 256
+#define ATTACK_RISE_DB 20.f
+#define ATTACK_QUIET_MS 10.f
+/* most notes the polyphonic mode plays at once, and looks for per hop */
+#define MAX_POLYPHONY 8
+#define NUM_MIDI_NOTES 128
+/* events are stamped at most a tier latency after the hop that finds them,
+ * 4.3 hops of onset delay and 6 of median for the high accuracy tier, and
+ * written out once their frame is read: the queue holds those of the last
+ * 12 hops at most. A hop strikes its sounding chord notes again, an off and
+ * an on each, or ends them, and starts at most as many; a mode switch then
+ * ends up to a chord more */
+#define MAX_QUEUED_HOPS 12
+#define MAX_PENDING_EVENTS \
+  (MAX_POLYPHONY * 2 * MAX_QUEUED_HOPS + MAX_POLYPHONY * MAX_QUEUED_HOPS \
+   + MAX_POLYPHONY)
 
 typedef struct {
   LV2_URID atom_Blank;
@@ -53,31 +83,124 @@ typedef struct {
   LV2_URID atom_URID;
 } harmonizer_URIs;
 
+static const char *onset_methods[NUM_ONSET_METHODS] = {
+  "default", "energy", "hfc", "complex", "phase", "specdiff", "kl", "mkl",
+  "specflux", "tdhfc"
+};
+static const char *pitch_methods[NUM_PITCH_METHODS] = {
+  "default", "schmitt", "fcomb", "mcomb", "yin", "yinfft", "yinfast", "yindec",
+  "goertzel"
+};
+
+/* latency tiers, from the shortest latency to the most accurate pitch; the
+ * default one is the setting the plugin always used before */
+typedef struct {
+  uint_t bufsize;     /* onset window */
+  uint_t hopsize;
+  uint_t pitch_size;  /* pitch window */
+  uint_t median;      /* hops in the note median */
+} harmonizer_tier;
+
+static const harmonizer_tier tiers[NUM_LATENCY_TIERS] = {
+  {  256,  64, 1024, 3 },   /* ultra low */
+  {  512, 128, 1024, 4 },   /* low */
+  {  512, 256, 2048, 6 },   /* normal */
+  { 1024, 512, 4096, 6 }    /* high accuracy */
+};
+#define DEFAULT_LATENCY_TIER 2
+
+/* the detectors and buffers of one latency tier; each detector takes its
+ * memory from an arena of its own, so that the worker can free it alone,
+ * and the rest of the tier, this struct included, from the tier arena */
+typedef struct {
+  const harmonizer_tier *tier;
+  aubio_arena_t *arena;
+  aubio_onset_t *onsets[NUM_ONSET_METHODS];
+  aubio_arena_t *onset_arenas[NUM_ONSET_METHODS];
+  aubio_pitch_t *pitches[NUM_PITCH_METHODS];
+  aubio_arena_t *pitch_arenas[NUM_PITCH_METHODS];
+  /* one sliding buffer for both detectors, with the onset (bufsize) and
+   * pitch (pitch_size) spectra computed at most once per hop */
+  aubio_frontend_t *frontend;
+  /* every onset detection function of the onset spectrum, in one pass */
+  aubio_specdesc_t *all_descriptors;
+  /* median of the last pitches, updated as each hop comes in */
+  aubio_median_t *notes;
+  fvec_t *ab_in;
+  fvec_t *ab_out;
+  fvec_t *onset;
+  fvec_t *descriptor_values;
+  /* frames from an onset to its MIDI events */
+  uint_t latency;
+} harmonizer_analysis;
+
+/* detectors and whole tiers are built and freed off the audio thread by
+ * the worker */
 typedef enum {
-	HARMONIZER_ONSET_METHOD   = 0,
-	HARMONIZER_ONSET_THRESHOLD   = 1,
-  HARMONIZER_SILENCE_THRESHOLD = 2,
-	HARMONIZER_PITCH_METHOD   = 3,
-  HARMONIZER_PITCH_THRESHOLD = 4,
-  HARMONIZER_INPUT  = 5,
-  HARMONIZER_MIDI_OUT = 6
-} PortIndex;
-
-char *onset_methods[NUM_ONSET_METHODS];
-char *pitch_methods[NUM_PITCH_METHODS];
+  HARMONIZER_WORK_NEW_ONSET,
+  HARMONIZER_WORK_NEW_PITCH,
+  HARMONIZER_WORK_NEW_TIER,
+  HARMONIZER_WORK_DEL_ONSET,
+  HARMONIZER_WORK_DEL_PITCH,
+  HARMONIZER_WORK_DEL_TIER
+} harmonizer_work_type;
+
+typedef struct {
+  harmonizer_work_type type;
+  int tier;
+  int onset_method;
+  int pitch_method;
+  void *object;
+  aubio_arena_t *arena;
+} harmonizer_work;
 
 typedef struct {
   LV2_Atom_Event event;
   uint8_t msg[3];
 } MIDI_note_event;
 
+/* what the hop analysis plays: one note at a time, up to the polyphony
+ * port at once, or the drum trigger note */
+typedef enum {
+  HARMONIZER_MODE_NOTE,
+  HARMONIZER_MODE_CHORD,
+  HARMONIZER_MODE_TRIGGER
+} harmonizer_mode;
 
+/* one MIDI note of the polyphonic mode; a note is turned on once it has
+ * been found in enough hops in a row, and off once it has been missing from
+ * as many */
 typedef struct {
-  aubio_onset_t *onsets[NUM_ONSET_METHODS];
-  aubio_pitch_t *pitches[NUM_PITCH_METHODS];
+  bool sounding;
+  uint_t present;   /* hops in a row the note was found in, while off */
+  uint_t absent;    /* hops in a row it was missing from, while on */
+  uint64_t since;   /* stream frame of the first of these hops */
+  smpl_t level;     /* level of the hop it was first found in */
+} chord_note;
+
+/* a MIDI message waiting for the block its stream frame falls in */
+typedef struct {
+  uint64_t time;
+  uint8_t msg[3];
+} pending_event;
+
+
+typedef struct {
+  harmonizer_analysis *analyses[NUM_LATENCY_TIERS];
+  int tier_cur;
+  int onset_cur;
+  int pitch_cur;
+  bool tier_pending;
+  bool onset_pending;
+  bool pitch_pending;
+  /* builds the worker could not complete, not asked for again */
+  bool tier_failed[NUM_LATENCY_TIERS];
+  bool onset_failed[NUM_LATENCY_TIERS][NUM_ONSET_METHODS];
+  bool pitch_failed[NUM_LATENCY_TIERS][NUM_PITCH_METHODS];
   LV2_Log_Log* log;
   LV2_Log_Logger logger;
   LV2_URID_Map* map;
+  LV2_Worker_Schedule* schedule;
   harmonizer_URIs uris;
   LV2_Atom_Forge forge;
   LV2_Atom_Forge_Frame frame;
@@ -87,21 +210,38 @@ typedef struct {
   const float* pitch_method;
   const float* pitch_threshold;
   const float* input;
+  const float* descriptors;
+  float* descriptor_out[NUM_DESCRIPTORS];
+  const float* latency_tier;
+  float* latency_out;
+  const float* min_note;
+  const float* max_note;
+  const float* trigger;
+  const float* trigger_note;
+  const float* polyphony;
   LV2_Atom_Sequence* midi_out;
   RingBuffer* ringbuf;
-  smpl_t bufsize;
-  smpl_t hopsize;
-  uint_t median;
   uint_t overruns;
   uint_t isready;
   smpl_t curnote;
   smpl_t curlevel;
-  fvec_t *ab_out;
-  fvec_t *ab_in;
-  fvec_t *note_buffer;
-  fvec_t *note_buffer2;
-  fvec_t *onset;
+  /* stream frame of the ring buffer read position */
+  uint64_t read_pos;
+  /* stream frame of the last onset */
+  uint64_t onset_time;
+  pending_event pending[MAX_PENDING_EVENTS];
+  uint_t n_pending;
   smpl_t samplerate;
+  /* drum trigger, fed straight from the input port instead of hop by hop */
+  aubio_trigger_t *drum;
+  fvec_t *drum_onset;
+  /* note the drum trigger last turned on, -1 once turned off */
+  int drum_note;
+  harmonizer_mode mode;
+  /* polyphonic mode */
+  chord_note chord[NUM_MIDI_NOTES];
+  uint_t n_sounding;
+  fvec_t *chord_pitches;
 } Harmonizer;
 
 const char *err_buf;
@@ -137,24 +277,57 @@ forge_midimessage (Harmonizer* self,
   lv2_atom_forge_pad (&self->forge, sizeof (LV2_Atom) + size);
 }
 
-void note_append(fvec_t *note_buffer, smpl_t curnote) {
-  uint_t i = 0;
-  for (i = 0; i < note_buffer->length - 1; i++) {
-    note_buffer->data[i] = note_buffer->data[i + 1];
+/* queue a MIDI message for stream frame time, keeping the queue sorted;
+ * when it is full, a note off takes the place of the last note on queued,
+ * as losing it would leave a note hanging */
+static void
+queue_event(Harmonizer *harm, uint64_t time, const uint8_t *msg) {
+  uint_t i = harm->n_pending;
+  if (i == MAX_PENDING_EVENTS) {
+    if ((msg[0] & 0xf0) == 0x80) {
+      while (i > 0 && (harm->pending[i - 1].msg[0] & 0xf0) != 0x90) i--;
+    } else {
+      i = 0;
+    }
+    lv2_log_trace(&harm->logger, "dropped MIDI event, queue full\n");
+    if (i == 0) return;
+    memmove(harm->pending + i - 1, harm->pending + i,
+     (harm->n_pending - i) * sizeof(pending_event));
+    i = --harm->n_pending;
+  }
+  for (; i > 0 && harm->pending[i - 1].time > time; i--) {
+    harm->pending[i] = harm->pending[i - 1];
   }
-  note_buffer->data[note_buffer->length - 1] = curnote;
-  return;
+  harm->pending[i].time = time;
+  memcpy(harm->pending[i].msg, msg, 3);
+  harm->n_pending++;
 }
 
-smpl_t get_note (fvec_t * note_buffer, fvec_t * note_buffer2) {
-  uint_t i;
-  for (i = 0; i < note_buffer->length; i++) {
-    note_buffer2->data[i] = note_buffer->data[i];
+/* write the queued messages due before stream frame end, in the block
+ * starting at block_start; late ones go at its first frame */
+static void
+flush_events(Harmonizer *harm, uint64_t block_start, uint64_t end) {
+  uint_t i = 0;
+  for (; i < harm->n_pending && harm->pending[i].time < end; i++) {
+    uint64_t time = harm->pending[i].time;
+    forge_midimessage(harm,
+     time > block_start ? (uint32_t)(time - block_start) : 0,
+     harm->pending[i].msg, 3);
   }
-  return fvec_median (note_buffer2);
+  harm->n_pending -= i;
+  memmove(harm->pending, harm->pending + i,
+   harm->n_pending * sizeof(pending_event));
+}
+
+/* bring the queued messages due after stream frame time forward to it,
+ * which keeps them in order */
+static void
+retime_events(Harmonizer *harm, uint64_t time) {
+  for (uint_t i = 0; i < harm->n_pending; i++)
+    harm->pending[i].time = std::min(harm->pending[i].time, time);
 }
 
-void send_noteon(smpl_t note, smpl_t level, void *usr) {
+void send_noteon(smpl_t note, smpl_t level, uint64_t time, void *usr) {
   Harmonizer *harm = (Harmonizer *)usr;
   if (note > 0) {
     smpl_t midi_note = floor(0.5 + aubio_freqtomidi(note));
@@ -162,32 +335,185 @@ void send_noteon(smpl_t note, smpl_t level, void *usr) {
     event[0] = 0x90;
     event[1] = (uint8_t)midi_note;
     event[2] = (uint8_t)level;
-    forge_midimessage(harm, 0, event, 3);
+    queue_event(harm, time, event);
   }
 }
 
-void send_noteoff(smpl_t note, smpl_t level, void *usr) {
+void send_noteoff(smpl_t note, smpl_t level, uint64_t time, void *usr) {
   Harmonizer *harm = (Harmonizer *)usr;
   smpl_t midi_note = floor(0.5 + aubio_freqtomidi(note));
   uint8_t event[3];
   event[0] = 0x80;
   event[1] = (uint8_t)midi_note;
   event[2] = (uint8_t)level;
-  forge_midimessage(harm, 0, event, 3);
+  queue_event(harm, time, event);
 }
 
+static uint_t
+arena_size(const harmonizer_tier *tier) {
+  return ARENA_SIZE_FACTOR * tier->pitch_size * sizeof(smpl_t);
+}
+
+static aubio_onset_t *
+new_onset_detector(Harmonizer *harm, const harmonizer_tier *tier,
+    int method, aubio_arena_t **arena) {
+  aubio_onset_t *onset = NULL;
+  *arena = new_aubio_arena(arena_size(tier), 1);
+  if (!*arena) return NULL;
+  aubio_arena_enter(*arena);
+  onset = new_aubio_onset_frontend(onset_methods[method], tier->bufsize,
+   tier->hopsize, harm->samplerate);
+  aubio_arena_leave(*arena);
+  if (!onset) {
+    del_aubio_arena(*arena);
+    *arena = NULL;
+  }
+  return onset;
+}
+
+static void
+del_onset_detector(aubio_onset_t *onset, aubio_arena_t *arena) {
+  if (!arena) return;
+  aubio_arena_enter(arena);
+  if (onset) del_aubio_onset(onset);
+  aubio_arena_leave(arena);
+  del_aubio_arena(arena);
+}
+
+static aubio_pitch_t *
+new_pitch_detector(Harmonizer *harm, const harmonizer_tier *tier,
+    int method, aubio_arena_t **arena) {
+  aubio_pitch_t *pitch = NULL;
+  *arena = new_aubio_arena(arena_size(tier), 1);
+  if (!*arena) return NULL;
+  aubio_arena_enter(*arena);
+  /* the tier front-end holds its window and spectrum */
+  pitch = new_aubio_pitch_frontend(pitch_methods[method], tier->pitch_size,
+   tier->hopsize, harm->samplerate);
+  aubio_arena_leave(*arena);
+  if (!pitch) {
+    del_aubio_arena(*arena);
+    *arena = NULL;
+  }
+  return pitch;
+}
+
+static void
+del_pitch_detector(aubio_pitch_t *pitch, aubio_arena_t *arena) {
+  if (!arena) return;
+  aubio_arena_enter(arena);
+  if (pitch) del_aubio_pitch(pitch);
+  aubio_arena_leave(arena);
+  del_aubio_arena(arena);
+}
+
+static void del_analysis(harmonizer_analysis *an);
+
+/* build the buffers of a tier with the given detectors, or with all of
+ * them for a method of -1; NULL if any of them could not be built */
+static harmonizer_analysis *
+new_analysis(Harmonizer *harm, int tier, int onset_method, int pitch_method)
+{
+  const harmonizer_tier *t = &tiers[tier];
+  aubio_arena_t *arena = new_aubio_arena(arena_size(t), 1);
+  if (!arena) return NULL;
+  harmonizer_analysis *an =
+   (harmonizer_analysis*)aubio_arena_alloc(arena, sizeof(harmonizer_analysis));
+  if (!an) {
+    del_aubio_arena(arena);
+    return NULL;
+  }
+  an->tier = t;
+  an->arena = arena;
+  /* the buffers run() goes through every hop, next to each other */
+  aubio_arena_enter(arena);
+  an->frontend = new_aubio_frontend(t->pitch_size, t->hopsize);
+  bool failed = !an->frontend
+   || aubio_frontend_add_spectrum(an->frontend, t->bufsize) != 0
+   || aubio_frontend_add_spectrum(an->frontend, t->pitch_size) != 0;
+  an->all_descriptors = new_aubio_specdesc("all", t->bufsize);
+  an->notes = new_aubio_median(t->median);
+  an->ab_in = new_fvec(t->hopsize);
+  an->ab_out = new_fvec(1);
+  an->onset = new_fvec(1);
+  an->descriptor_values = new_fvec(aubio_specdesc_n_onsets);
+  aubio_arena_leave(arena);
+  failed = failed || !an->all_descriptors || !an->notes || !an->ab_in
+   || !an->ab_out || !an->onset || !an->descriptor_values;
+  for (int i = 0; i < NUM_ONSET_METHODS && !failed; i++) {
+    if (onset_method < 0 || i == onset_method) {
+      an->onsets[i] = new_onset_detector(harm, t, i, &an->onset_arenas[i]);
+      failed = !an->onsets[i];
+    }
+  }
+  for (int i = 0; i < NUM_PITCH_METHODS && !failed; i++) {
+    if (pitch_method < 0 || i == pitch_method) {
+      an->pitches[i] = new_pitch_detector(harm, t, i, &an->pitch_arenas[i]);
+      failed = !an->pitches[i];
+    }
+  }
+  if (failed) {
+    del_analysis(an);
+    return NULL;
+  }
+  /* an onset is known for sure once the peak picker has seen it, its delay
+   * after the onset, and its note once the median has been filled: stamp
+   * both events that long after the onset, so that the time between notes
+   * is kept whatever the host block size */
+  an->latency = aubio_onset_get_delay(an->onsets[onset_method < 0 ? 0
+     : onset_method]) + t->median * t->hopsize;
+  return an;
+}
+
+static void
+del_analysis(harmonizer_analysis *an)
+{
+  if (!an) return;
+  aubio_arena_t *arena = an->arena;
+  for (int i = 0; i < NUM_ONSET_METHODS; i++) {
+    if (an->onset_arenas[i])
+      del_onset_detector(an->onsets[i], an->onset_arenas[i]);
+  }
+  for (int i = 0; i < NUM_PITCH_METHODS; i++) {
+    if (an->pitch_arenas[i])
+      del_pitch_detector(an->pitches[i], an->pitch_arenas[i]);
+  }
+  /* only what the buffers hold outside of the arena is freed here, the
+   * arena goes with all the rest, an included; a tier that failed to build
+   * may miss some of them */
+  aubio_arena_enter(arena);
+  if (an->frontend) del_aubio_frontend(an->frontend);
+  if (an->all_descriptors) del_aubio_specdesc(an->all_descriptors);
+  if (an->notes) del_aubio_median(an->notes);
+  if (an->ab_in) del_fvec(an->ab_in);
+  if (an->ab_out) del_fvec(an->ab_out);
+  if (an->onset) del_fvec(an->onset);
+  if (an->descriptor_values) del_fvec(an->descriptor_values);
+  aubio_arena_leave(arena);
+  del_aubio_arena(arena);
+}
+
+static int
+clamp_method(float value, int num_methods) {
+  int method = (int)value;
+  return std::min(std::max(method, 0), num_methods - 1);
+}
+
+static void cleanup(LV2_Handle instance);
+
 static LV2_Handle
 instantiate(const LV2_Descriptor*     descriptor,
     double                    rate,
     const char*               bundle_path,
     const LV2_Feature* const* features) {
-  Harmonizer* harm = (Harmonizer*)malloc(sizeof(Harmonizer));
-  harm->ringbuf = new RingBuffer(RB_SIZE * sizeof(smpl_t));
+  Harmonizer* harm = (Harmonizer*)calloc(1, sizeof(Harmonizer));
   for (int i = 0; features[i]; ++i) {
     if (!strcmp (features[i]->URI, LV2_URID__map)) {
       harm->map = (LV2_URID_Map*)features[i]->data;
     } else if (!strcmp (features[i]->URI, LV2_LOG__log)) {
       harm->log = (LV2_Log_Log*)features[i]->data;
+    } else if (!strcmp (features[i]->URI, LV2_WORKER__schedule)) {
+      harm->schedule = (LV2_Worker_Schedule*)features[i]->data;
     }
   }
   lv2_log_logger_init(&harm->logger, harm->map, harm->log);
@@ -197,40 +523,43 @@ instantiate(const LV2_Descriptor*     descriptor,
     free (harm);
     return NULL;
   }
+  /* pick the vector kernels for this CPU, once per process */
+  aubio_simd_init(NULL);
+  harm->ringbuf = new RingBuffer(RB_SIZE);
   lv2_atom_forge_init (&harm->forge, harm->map);
   map_mem_uris (harm->map, &harm->uris);
   harm->samplerate = (float)rate;
-  harm->bufsize = 512;
-  harm->hopsize = 256;
-  harm->median = 6;
-  harm->onset = new_fvec(1);
-  harm->ab_in = new_fvec(harm->hopsize);
-  harm->ab_out = new_fvec(1);
-  harm->note_buffer = new_fvec(harm->median);
-  harm->note_buffer2 = new_fvec(harm->median);
-  onset_methods[0] = (char*)"default";
-  onset_methods[1] = (char*)"energy";
-  onset_methods[2] = (char*)"hfc";
-  onset_methods[3] = (char*)"complex";
-  onset_methods[4] = (char*)"phase";
-  onset_methods[5] = (char*)"specdiff";
-  onset_methods[6] = (char*)"kl";
-  onset_methods[7] = (char*)"mkl";
-  onset_methods[8] = (char*)"specflux";
-  pitch_methods[0] = (char*)"default";
-  pitch_methods[1] = (char*)"schmitt";
-  pitch_methods[2] = (char*)"fcomb";
-  pitch_methods[3] = (char*)"mcomb";
-  pitch_methods[4] = (char*)"yin";
-  pitch_methods[5] = (char*)"yinfft";
-  for (int i = 0; i < NUM_ONSET_METHODS; i++) {
-    harm->onsets[i] = new_aubio_onset(onset_methods[i], harm->bufsize,
-     harm->hopsize, harm->samplerate);
+  /* the same durations at higher rates */
+  uint_t scale = std::max(1, (int)floor(rate / 44100. + 0.5));
+  harm->drum = new_aubio_trigger(scale * TRIGGER_WIN_SIZE,
+   scale * TRIGGER_BLOCK_SIZE, (uint_t)rate);
+  harm->drum_onset = new_fvec(1);
+  harm->drum_note = -1;
+  harm->chord_pitches = new_fvec(MAX_POLYPHONY);
+  /* with a worker, only the selected tier and detectors are built, on
+   * demand and off the audio thread; without one, build every tier with
+   * all its detectors now so that switching in run() never allocates */
+  bool failed = false;
+  if (harm->schedule) {
+    harm->analyses[DEFAULT_LATENCY_TIER] = new_analysis(harm,
+     DEFAULT_LATENCY_TIER, 0, 0);
+    failed = !harm->analyses[DEFAULT_LATENCY_TIER];
+  } else {
+    for (int i = 0; i < NUM_LATENCY_TIERS; i++) {
+      harm->analyses[i] = new_analysis(harm, i, -1, -1);
+      failed = failed || !harm->analyses[i];
+    }
   }
-  for (int i = 0; i < NUM_PITCH_METHODS; i++) {
-    harm->pitches[i] = new_aubio_pitch(pitch_methods[i], 4*harm->bufsize,
-     harm->hopsize, harm->samplerate);
+  /* run() relies on the tiers it may switch to */
+  if (failed) {
+    lv2_log_error(&harm->logger,
+     "harmonizer.lv2 error: could not build the analysis\n");
+    cleanup((LV2_Handle)harm);
+    return NULL;
   }
+  harm->tier_cur = DEFAULT_LATENCY_TIER;
+  harm->onset_cur = 0;
+  harm->pitch_cur = 0;
   return (LV2_Handle)harm;
 }
 
@@ -262,6 +591,40 @@ connect_port(LV2_Handle instance,
   case HARMONIZER_MIDI_OUT:
     harm->midi_out = (LV2_Atom_Sequence *)data;
     break;
+  case HARMONIZER_DESCRIPTORS:
+    harm->descriptors = (float *)data;
+    break;
+  case HARMONIZER_ENERGY_OUT:
+  case HARMONIZER_HFC_OUT:
+  case HARMONIZER_COMPLEX_OUT:
+  case HARMONIZER_PHASE_OUT:
+  case HARMONIZER_SPECDIFF_OUT:
+  case HARMONIZER_KL_OUT:
+  case HARMONIZER_MKL_OUT:
+  case HARMONIZER_SPECFLUX_OUT:
+    harm->descriptor_out[port - HARMONIZER_ENERGY_OUT] = (float *)data;
+    break;
+  case HARMONIZER_LATENCY_TIER:
+    harm->latency_tier = (float *)data;
+    break;
+  case HARMONIZER_LATENCY:
+    harm->latency_out = (float *)data;
+    break;
+  case HARMONIZER_MIN_NOTE:
+    harm->min_note = (float *)data;
+    break;
+  case HARMONIZER_MAX_NOTE:
+    harm->max_note = (float *)data;
+    break;
+  case HARMONIZER_TRIGGER:
+    harm->trigger = (float *)data;
+    break;
+  case HARMONIZER_TRIGGER_NOTE:
+    harm->trigger_note = (float *)data;
+    break;
+  case HARMONIZER_POLYPHONY:
+    harm->polyphony = (float *)data;
+    break;
   }
 }
 
@@ -275,6 +638,369 @@ deactivate(LV2_Handle instance)
 {
 }
 
+static bool
+schedule_work(Harmonizer *harm, harmonizer_work_type type, int tier,
+    int onset_method, int pitch_method, void *object, aubio_arena_t *arena)
+{
+  harmonizer_work work;
+  work.type = type;
+  work.tier = tier;
+  work.onset_method = onset_method;
+  work.pitch_method = pitch_method;
+  work.object = object;
+  work.arena = arena;
+  return harm->schedule->schedule_work(harm->schedule->handle, sizeof(work),
+   &work) == LV2_WORKER_SUCCESS;
+}
+
+static int
+first_onset(const harmonizer_analysis *an) {
+  int i = 0;
+  while (i < NUM_ONSET_METHODS - 1 && !an->onsets[i]) i++;
+  return i;
+}
+
+static int
+first_pitch(const harmonizer_analysis *an) {
+  int i = 0;
+  while (i < NUM_PITCH_METHODS - 1 && !an->pitches[i]) i++;
+  return i;
+}
+
+/* follow the tier and method ports: switch to the requested tier or
+ * detector once it exists, otherwise ask the worker for it and keep running
+ * the current one */
+static void
+select_detectors(Harmonizer *harm, uint64_t block_start)
+{
+  int tier = clamp_method(*harm->latency_tier, NUM_LATENCY_TIERS);
+  int onset_method = clamp_method(*harm->onset_method, NUM_ONSET_METHODS);
+  int pitch_method = clamp_method(*harm->pitch_method, NUM_PITCH_METHODS);
+  if (harm->analyses[tier]) {
+    if (tier != harm->tier_cur) {
+      harmonizer_analysis *an = harm->analyses[tier];
+      harm->tier_cur = tier;
+      /* the tier may have been built for methods since left */
+      if (!an->onsets[harm->onset_cur]) harm->onset_cur = first_onset(an);
+      if (!an->pitches[harm->pitch_cur]) harm->pitch_cur = first_pitch(an);
+      /* hops of the previous tier do not count towards the next note */
+      harm->isready = 0;
+      for (int note = 0; note < NUM_MIDI_NOTES; note++) {
+        harm->chord[note].present = 0;
+        harm->chord[note].absent = 0;
+      }
+      /* what it queued is stamped with its own latency: a shorter one would
+       * put the next events ahead of them, a note off before the note on it
+       * ends, so play them now */
+      retime_events(harm, block_start);
+    }
+  } else if (harm->schedule && !harm->tier_pending
+      && !harm->tier_failed[tier]) {
+    harm->tier_pending = schedule_work(harm, HARMONIZER_WORK_NEW_TIER, tier,
+     onset_method, pitch_method, NULL, NULL);
+  }
+  /* the pending tier is built with the requested methods, keep the current
+   * one as it is until it arrives */
+  harmonizer_analysis *an = harm->analyses[harm->tier_cur];
+  if (tier == harm->tier_cur) {
+    if (an->onsets[onset_method]) {
+      harm->onset_cur = onset_method;
+    } else if (harm->schedule && !harm->onset_pending
+        && !harm->onset_failed[tier][onset_method]) {
+      harm->onset_pending = schedule_work(harm, HARMONIZER_WORK_NEW_ONSET,
+       harm->tier_cur, onset_method, 0, NULL, NULL);
+    }
+    if (an->pitches[pitch_method]) {
+      harm->pitch_cur = pitch_method;
+    } else if (harm->schedule && !harm->pitch_pending
+        && !harm->pitch_failed[tier][pitch_method]) {
+      harm->pitch_pending = schedule_work(harm, HARMONIZER_WORK_NEW_PITCH,
+       harm->tier_cur, 0, pitch_method, NULL, NULL);
+    }
+  }
+  if (!harm->schedule) return;
+  /* hand what is no longer in use back to the worker, also while a tier
+   * is being built */
+  for (int i = 0; i < NUM_LATENCY_TIERS; i++) {
+    if (harm->analyses[i] && i != harm->tier_cur
+        && schedule_work(harm, HARMONIZER_WORK_DEL_TIER, i, 0, 0,
+         harm->analyses[i], NULL)) {
+      harm->analyses[i] = NULL;
+    }
+  }
+  for (int i = 0; i < NUM_ONSET_METHODS; i++) {
+    if (an->onsets[i] && i != harm->onset_cur
+        && schedule_work(harm, HARMONIZER_WORK_DEL_ONSET, harm->tier_cur,
+         i, 0, an->onsets[i], an->onset_arenas[i])) {
+      an->onsets[i] = NULL;
+      an->onset_arenas[i] = NULL;
+    }
+  }
+  for (int i = 0; i < NUM_PITCH_METHODS; i++) {
+    if (an->pitches[i] && i != harm->pitch_cur
+        && schedule_work(harm, HARMONIZER_WORK_DEL_PITCH, harm->tier_cur,
+         0, i, an->pitches[i], an->pitch_arenas[i])) {
+      an->pitches[i] = NULL;
+      an->pitch_arenas[i] = NULL;
+    }
+  }
+}
+
+/* follow the note range ports: 0 and 127 leave that end of the range open,
+ * the others are widened by half a semitone for notes slightly out of tune */
+static void
+set_pitch_range(Harmonizer *harm, aubio_pitch_t *pitch)
+{
+  float low = std::min(std::max(*harm->min_note, 0.f), 127.f);
+  float high = std::min(std::max(*harm->max_note, low), 127.f);
+  aubio_pitch_set_range(pitch, low > 0.f ? aubio_miditofreq(low - 0.5f) : 0.,
+   high < 127.f ? aubio_miditofreq(high + 0.5f) : 0.);
+}
+
+/* stream frame of the onset found in the hop the front-end was just fed.
+ * The detector reports it a fixed delay late, but how late its function
+ * peaks after the attack depends on the method: the attack is looked for
+ * in the front-end instead, as the latest block ATTACK_RISE_DB louder than
+ * the ATTACK_QUIET_MS before it; shorter dips, at the zero crossings of a
+ * low note, do not count. Without such a rise, over a legato change, the
+ * detector's estimate is kept. */
+static uint64_t
+onset_time(const Harmonizer *harm, const harmonizer_analysis *an,
+    aubio_onset_t *onset, smpl_t isonset, uint_t hop_length)
+{
+  uint64_t end = harm->read_pos + hop_length;
+  uint64_t time = harm->read_pos
+   + (uint64_t)floorf(0.5f + isonset * hop_length);
+  time -= std::min<uint64_t>(time, aubio_onset_get_delay(onset));
+  fvec_t frame;
+  if (aubio_frontend_get_frame(an->frontend, an->tier->pitch_size, &frame))
+    return time;
+  uint_t block = std::min<uint_t>(std::max<uint_t>(hop_length / 4,
+   ATTACK_MIN_BLOCK), ATTACK_MAX_BLOCK);
+  uint_t n_blocks = std::min<uint_t>(frame.length / block, ATTACK_MAX_BLOCKS);
+  uint_t n_quiet = (uint_t)ceilf(ATTACK_QUIET_MS * harm->samplerate / 1000.f
+   / block);
+  const smpl_t *x = frame.data + frame.length - n_blocks * block;
+  smpl_t level[ATTACK_MAX_BLOCKS];
+  for (uint_t b = 0; b < n_blocks; b++) {
+    level[b] = 0.;
+    for (uint_t i = 0; i < block; i++)
+      level[b] += x[b * block + i] * x[b * block + i];
+  }
+  /* events are stamped a latency after the onset, and must fall after the
+   * hop that queues them */
+  uint64_t first = end + 1 - std::min<uint64_t>(end + 1, an->latency);
+  const smpl_t rise = powf(10.f, ATTACK_RISE_DB / 10.f);
+  smpl_t loudest = 0.;
+  for (uint_t b = n_blocks; b-- > n_quiet;) {
+    uint64_t attack = end - (uint64_t)(n_blocks - b) * block;
+    if (attack < first) break;
+    uint_t quiet = 0;
+    while (quiet < n_quiet && level[b - 1 - quiet] * rise < loudest) quiet++;
+    if (quiet == n_quiet) return attack + block / 2;
+    loudest = std::max(loudest, level[b]);
+  }
+  return time;
+}
+
+/* run the onset and pitch detectors on the hop the front-end was just fed,
+ * and queue the note they find */
+static void
+track_note(Harmonizer *harm, harmonizer_analysis *an, aubio_onset_t *onset,
+    aubio_pitch_t *pitch, uint_t hop_length, smpl_t db_spl, bool silent)
+{
+  const harmonizer_tier *tier = an->tier;
+  aubio_onset_set_silence(onset, (float)*harm->silence_threshold);
+  aubio_onset_set_threshold(onset, (float)*harm->onset_threshold);
+  aubio_onset_do_frontend(onset, an->frontend, an->onset);
+  aubio_pitch_set_tolerance(pitch, (float)*harm->pitch_threshold);
+  aubio_pitch_set_silence(pitch, (float)*harm->silence_threshold);
+  set_pitch_range(harm, pitch);
+  aubio_pitch_do_frontend(pitch, an->frontend, an->ab_out);
+  smpl_t new_pitch = fvec_get_sample(an->ab_out, 0);
+  aubio_median_push(an->notes, new_pitch);
+  harm->curlevel = silent ? 1.0 : db_spl;
+  smpl_t isonset = fvec_get_sample(an->onset, 0);
+  if (isonset) {
+    harm->onset_time = onset_time(harm, an, onset, isonset, hop_length);
+    if (harm->curlevel == 1.0) {
+      harm->isready = 0;
+      send_noteoff(harm->curnote, 0, harm->onset_time + an->latency, harm);
+    } else {
+      harm->isready = 1;
+    }
+  } else {
+    if (harm->isready > 0)
+      harm->isready++;
+    if (harm->isready == tier->median) {
+      uint64_t time = harm->onset_time + an->latency;
+      send_noteoff(harm->curnote, 0, time, harm);
+      harm->curnote = aubio_median_get(an->notes);
+      if (harm->curnote > 0) {
+        send_noteon(harm->curnote, 127+(int)floorf(harm->curlevel), time,
+         harm);
+      }
+    }
+  }
+}
+
+static void
+send_chord_event(Harmonizer *harm, uint8_t status, int note, int velocity,
+    uint64_t time) {
+  uint8_t event[3];
+  event[0] = status;
+  event[1] = (uint8_t)note;
+  /* a note on of velocity 0 would be a note off */
+  event[2] = (uint8_t)std::min(std::max(velocity, status == 0x90 ? 1 : 0), 127);
+  queue_event(harm, time, event);
+}
+
+/* polyphonic counterpart of track_note: each note found in the hop is
+ * followed on its own, and the notes still sounding at an onset are struck
+ * again; the pitch detector looks for no more notes than the polyphony, so
+ * that a hop costs that many single pitch detections at most */
+static void
+track_chord(Harmonizer *harm, harmonizer_analysis *an, aubio_onset_t *onset,
+    aubio_pitch_t *pitch, uint_t hop_length, smpl_t db_spl, bool silent)
+{
+  const uint_t confirm = (an->tier->median + 1) / 2;
+  uint_t polyphony = clamp_method(*harm->polyphony, MAX_POLYPHONY + 1);
+  bool found[NUM_MIDI_NOTES] = { false };
+  fvec_t pitches;
+  aubio_onset_set_silence(onset, (float)*harm->silence_threshold);
+  aubio_onset_set_threshold(onset, (float)*harm->onset_threshold);
+  aubio_onset_do_frontend(onset, an->frontend, an->onset);
+  aubio_pitch_set_tolerance(pitch, (float)*harm->pitch_threshold);
+  aubio_pitch_set_silence(pitch, (float)*harm->silence_threshold);
+  set_pitch_range(harm, pitch);
+  pitches.data = harm->chord_pitches->data;
+  pitches.length = std::max<uint_t>(polyphony, 1);
+  uint_t n = aubio_pitch_do_multi_frontend(pitch, an->frontend, &pitches);
+  for (uint_t i = 0; i < n; i++) {
+    int note = (int)floorf(0.5f + aubio_freqtomidi(pitches.data[i]));
+    if (note > 0 && note < NUM_MIDI_NOTES) found[note] = true;
+  }
+  smpl_t isonset = silent ? 0. : fvec_get_sample(an->onset, 0);
+  if (isonset) {
+    harm->onset_time = onset_time(harm, an, onset, isonset, hop_length);
+  }
+  for (int note = 0; note < NUM_MIDI_NOTES; note++) {
+    chord_note *c = &harm->chord[note];
+    if (found[note]) {
+      c->absent = 0;
+      if (c->sounding) {
+        /* unless it only started after the onset */
+        if (isonset && harm->onset_time > c->since) {
+          uint64_t time = harm->onset_time + an->latency;
+          send_chord_event(harm, 0x80, note, 0, time);
+          send_chord_event(harm, 0x90, note, 127 + (int)floorf(db_spl), time);
+        }
+        continue;
+      }
+      if (c->present++ == 0) {
+        c->since = harm->read_pos;
+        c->level = db_spl;
+      }
+      if (c->present >= confirm && harm->n_sounding < polyphony) {
+        send_chord_event(harm, 0x90, note, 127 + (int)floorf(c->level),
+         c->since + an->latency);
+        c->sounding = true;
+        c->present = 0;
+        harm->n_sounding++;
+      }
+    } else {
+      c->present = 0;
+      if (!c->sounding) continue;
+      if (c->absent++ == 0) c->since = harm->read_pos;
+      if (c->absent >= confirm) {
+        send_chord_event(harm, 0x80, note, 0, c->since + an->latency);
+        c->sounding = false;
+        c->absent = 0;
+        harm->n_sounding--;
+      }
+    }
+  }
+}
+
+/* the drum trigger plays one note, cut by the next hit; the velocity comes
+ * from the level of the hit as the other notes do */
+static void
+send_drum_note(Harmonizer *harm, uint64_t time) {
+  uint8_t event[3];
+  int level = 127 + (int)floorf(aubio_trigger_get_level(harm->drum));
+  if (harm->drum_note >= 0) {
+    event[0] = 0x80;
+    event[1] = (uint8_t)harm->drum_note;
+    event[2] = 0;
+    queue_event(harm, time, event);
+  }
+  harm->drum_note = clamp_method(*harm->trigger_note, 128);
+  event[0] = 0x90;
+  event[1] = (uint8_t)harm->drum_note;
+  event[2] = (uint8_t)std::min(std::max(level, 1), 127);
+  queue_event(harm, time, event);
+}
+
+/* run the drum trigger on the whole block, a trigger block at a time so
+ * that no two onsets are found in one call */
+static void
+run_drum_trigger(Harmonizer *harm, const float *input, uint32_t n_samples,
+    uint64_t block_start) {
+  uint_t step = aubio_trigger_get_delay(harm->drum);
+  aubio_trigger_set_threshold(harm->drum, (float)*harm->onset_threshold);
+  aubio_trigger_set_silence(harm->drum, (float)*harm->silence_threshold);
+  for (uint32_t i = 0; i < n_samples; i += step) {
+    fvec_t chunk;
+    chunk.data = (smpl_t *)input + i;
+    chunk.length = std::min<uint32_t>(step, n_samples - i);
+    aubio_trigger_do(harm->drum, &chunk, harm->drum_onset);
+    smpl_t onset = fvec_get_sample(harm->drum_onset, 0);
+    if (onset > 0) {
+      /* found at the end of its trigger block, as late as the trigger
+       * reports it, so no latency is added */
+      send_drum_note(harm, block_start + i + (uint64_t)onset - 1);
+    }
+  }
+}
+
+static harmonizer_mode
+requested_mode(const Harmonizer *harm) {
+  if (harm->drum && *harm->trigger > 0.f) return HARMONIZER_MODE_TRIGGER;
+  if (*harm->polyphony >= 2.f) return HARMONIZER_MODE_CHORD;
+  return HARMONIZER_MODE_NOTE;
+}
+
+/* end the notes the previous mode left behind; the hop analysis may have
+ * queued its last ones up to its latency ahead */
+static void
+switch_mode(Harmonizer *harm, const harmonizer_analysis *an,
+    uint64_t block_start, harmonizer_mode mode) {
+  switch (harm->mode) {
+  case HARMONIZER_MODE_NOTE:
+    if (harm->curnote > 0)
+      send_noteoff(harm->curnote, 0, block_start + an->latency, harm);
+    harm->curnote = 0;
+    break;
+  case HARMONIZER_MODE_CHORD:
+    for (int note = 0; note < NUM_MIDI_NOTES; note++) {
+      if (harm->chord[note].sounding)
+        send_chord_event(harm, 0x80, note, 0, block_start + an->latency);
+    }
+    memset(harm->chord, 0, sizeof(harm->chord));
+    harm->n_sounding = 0;
+    break;
+  case HARMONIZER_MODE_TRIGGER:
+    if (harm->drum_note >= 0) {
+      uint8_t event[3] = { 0x80, (uint8_t)harm->drum_note, 0 };
+      queue_event(harm, block_start, event);
+      harm->drum_note = -1;
+    }
+    break;
+  }
+  harm->isready = 0;
+  harm->mode = mode;
+}
+
   static void
 run(LV2_Handle instance, uint32_t n_samples)
 {
@@ -283,76 +1009,190 @@ run(LV2_Handle instance, uint32_t n_samples)
   lv2_atom_forge_set_buffer(&harm->forge, (uint8_t*)harm->midi_out, capacity);
   lv2_atom_forge_sequence_head(&harm->forge, &harm->frame, 0);
   const float *input  = harm->input;
-  float new_pitch;
-  for (uint i = 0; i < n_samples; i++) {
-    if (harm->ringbuf->Write((unsigned char*)&input[i], sizeof(smpl_t))
-        < (int)sizeof(smpl_t)) {
-      harm->overruns++;
-      lv2_log_trace(&harm->logger, "overrun on ringbuf: %d\n", harm->overruns);
-    }
+  /* stream frame of input[0] */
+  const uint64_t block_start = harm->read_pos + harm->ringbuf->GetReadAvail();
+  select_detectors(harm, block_start);
+  harmonizer_analysis *an = harm->analyses[harm->tier_cur];
+  const harmonizer_tier *tier = an->tier;
+  aubio_onset_t *onset = an->onsets[harm->onset_cur];
+  aubio_pitch_t *pitch = an->pitches[harm->pitch_cur];
+  harmonizer_mode mode = requested_mode(harm);
+  if (mode != harm->mode)
+    switch_mode(harm, an, block_start, mode);
+  if (harm->mode == HARMONIZER_MODE_TRIGGER)
+    run_drum_trigger(harm, input, n_samples, block_start);
+  int written = harm->ringbuf->Write(input, n_samples);
+  if (written < (int)n_samples) {
+    harm->overruns += n_samples - written;
+    lv2_log_trace(&harm->logger, "overrun on ringbuf: %d\n", harm->overruns);
   }
-  while (harm->ringbuf->GetReadAvail() >= sizeof(smpl_t) * harm->hopsize) {
-    harm->ringbuf->Read((unsigned char*)harm->ab_in->data, sizeof(smpl_t)
-     * harm->hopsize);
-    aubio_onset_set_silence(harm->onsets[(int)*harm->onset_method],
-     (float)*harm->silence_threshold);
-    aubio_onset_set_threshold(harm->onsets[(int)*harm->onset_method],
-     (float)*harm->onset_threshold);
-    aubio_onset_do(harm->onsets[(int)*harm->onset_method],
-     harm->ab_in, harm->onset);
-    aubio_pitch_set_tolerance(harm->pitches[(int)*harm->pitch_method],
-     (float)*harm->pitch_threshold);
-    aubio_pitch_set_silence(harm->pitches[(int)*harm->pitch_method],
-     (float)*harm->silence_threshold);
-    aubio_pitch_do(harm->pitches[(int)*harm->pitch_method],
-     harm->ab_in, harm->ab_out);
-    new_pitch = fvec_get_sample(harm->ab_out, 0);
-    note_append(harm->note_buffer, new_pitch);
-    harm->curlevel = aubio_level_detection(harm->ab_in,
-     *harm->silence_threshold);
-    if (fvec_get_sample(harm->onset, 0)) {
-      if (harm->curlevel == 1.0) {
-        harm->isready = 0;
-        send_noteoff(harm->curnote, 0, harm);
+  while (harm->ringbuf->GetReadAvail() >= (int)tier->hopsize) {
+    /* analyse the hop in place when it does not wrap, otherwise copy it out */
+    fvec_t hop;
+    fvec_t *ab_in = &hop;
+    hop.length = tier->hopsize;
+    hop.data = (smpl_t *)harm->ringbuf->Peek(hop.length);
+    if (!hop.data) {
+      harm->ringbuf->Read(an->ab_in->data, hop.length);
+      ab_in = an->ab_in;
+    }
+    aubio_frontend_do(an->frontend, ab_in);
+    /* computed once for the hop, the detectors skip their spectra when it
+     * is below the silence threshold */
+    smpl_t db_spl = aubio_frontend_get_db_spl(an->frontend);
+    bool silent = db_spl < *harm->silence_threshold;
+    if (*harm->descriptors > 0.f) {
+      if (silent) {
+        aubio_specdesc_reset(an->all_descriptors);
+        fvec_zeros(an->descriptor_values);
       } else {
-        harm->isready = 1;
-      }
-    } else {
-      if (harm->isready > 0)
-        harm->isready++;
-      if (harm->isready == harm->median) {
-        send_noteoff(harm->curnote, 0, harm);
-        harm->curnote = get_note(harm->note_buffer, harm->note_buffer2);
-        if (harm->curnote > 0) {
-          send_noteon(harm->curnote, 127+(int)floorf(harm->curlevel), harm);
-        }
+        aubio_specdesc_do(an->all_descriptors,
+         aubio_frontend_get_spectrum(an->frontend, tier->bufsize, 1),
+         an->descriptor_values);
       }
     }
+    /* the drum trigger has already gone through these samples */
+    if (harm->mode == HARMONIZER_MODE_NOTE)
+      track_note(harm, an, onset, pitch, hop.length, db_spl, silent);
+    else if (harm->mode == HARMONIZER_MODE_CHORD)
+      track_chord(harm, an, onset, pitch, hop.length, db_spl, silent);
+    if (ab_in == &hop)
+      harm->ringbuf->Advance(hop.length);
+    harm->read_pos += hop.length;
+    /* what the hop queues is due after it, so the queue can be emptied up
+     * to here without breaking the order of the sequence */
+    flush_events(harm, block_start,
+     std::min<uint64_t>(harm->read_pos, block_start + n_samples));
+  }
+  flush_events(harm, block_start, block_start + n_samples);
+  /* report the last hop of the block */
+  for (int i = 0; i < NUM_DESCRIPTORS; i++) {
+    *harm->descriptor_out[i] = fvec_get_sample(an->descriptor_values, i);
   }
+  *harm->latency_out = harm->mode == HARMONIZER_MODE_TRIGGER
+   ? (float)aubio_trigger_get_delay(harm->drum) : (float)an->latency;
 }
 
 static void
 cleanup(LV2_Handle instance)
 {
   Harmonizer *harm = (Harmonizer*)instance;
-  for (uint i = 0; i < NUM_ONSET_METHODS; i++) {
-    del_aubio_onset(harm->onsets[i]);
+  for (uint i = 0; i < NUM_LATENCY_TIERS; i++) {
+    if (harm->analyses[i]) del_analysis(harm->analyses[i]);
   }
-  for (uint i = 0; i < NUM_PITCH_METHODS; i++) {
-    del_aubio_pitch(harm->pitches[i]);
-  }
-	del_fvec(harm->onset);
-	del_fvec(harm->ab_in);
-	del_fvec(harm->ab_out);
-	del_fvec(harm->note_buffer);
-	del_fvec(harm->note_buffer2);
+  if (harm->drum) del_aubio_trigger(harm->drum);
+  if (harm->drum_onset) del_fvec(harm->drum_onset);
+  if (harm->chord_pitches) del_fvec(harm->chord_pitches);
 	delete(harm->ringbuf);
 	free(harm);
 }
 
+/* runs in the worker thread: build or free a detector or a tier */
+static LV2_Worker_Status
+work(LV2_Handle                  instance,
+     LV2_Worker_Respond_Function respond,
+     LV2_Worker_Respond_Handle   handle,
+     uint32_t                    size,
+     const void*                 data)
+{
+  Harmonizer *harm = (Harmonizer*)instance;
+  /* hosts do not promise any alignment for worker messages */
+  harmonizer_work msg;
+  memcpy(&msg, data, sizeof(msg));
+  switch (msg.type) {
+  case HARMONIZER_WORK_NEW_ONSET:
+    msg.object = new_onset_detector(harm, &tiers[msg.tier], msg.onset_method,
+     &msg.arena);
+    return respond(handle, sizeof(msg), &msg);
+  case HARMONIZER_WORK_NEW_PITCH:
+    msg.object = new_pitch_detector(harm, &tiers[msg.tier], msg.pitch_method,
+     &msg.arena);
+    return respond(handle, sizeof(msg), &msg);
+  case HARMONIZER_WORK_NEW_TIER:
+    msg.object = new_analysis(harm, msg.tier, msg.onset_method,
+     msg.pitch_method);
+    return respond(handle, sizeof(msg), &msg);
+  case HARMONIZER_WORK_DEL_ONSET:
+    del_onset_detector((aubio_onset_t*)msg.object, msg.arena);
+    break;
+  case HARMONIZER_WORK_DEL_PITCH:
+    del_pitch_detector((aubio_pitch_t*)msg.object, msg.arena);
+    break;
+  case HARMONIZER_WORK_DEL_TIER:
+    del_analysis((harmonizer_analysis*)msg.object);
+    break;
+  }
+  return LV2_WORKER_SUCCESS;
+}
+
+/* runs in the audio thread: hand a freshly built detector or tier to run(),
+ * or back to the worker if the tier it was built for has been dropped; a
+ * build that failed is remembered so that select_detectors() keeps running
+ * the current detectors instead of asking for it again */
+static LV2_Worker_Status
+work_response(LV2_Handle  instance,
+              uint32_t    size,
+              const void* data)
+{
+  Harmonizer *harm = (Harmonizer*)instance;
+  harmonizer_work msg;
+  memcpy(&msg, data, sizeof(msg));
+  harmonizer_analysis *an = harm->analyses[msg.tier];
+  switch (msg.type) {
+  case HARMONIZER_WORK_NEW_ONSET:
+    harm->onset_pending = false;
+    if (!msg.object) {
+      harm->onset_failed[msg.tier][msg.onset_method] = true;
+      lv2_log_trace(&harm->logger, "could not build onset method %d\n",
+       msg.onset_method);
+    } else if (an && !an->onsets[msg.onset_method]) {
+      an->onsets[msg.onset_method] = (aubio_onset_t*)msg.object;
+      an->onset_arenas[msg.onset_method] = msg.arena;
+    } else {
+      schedule_work(harm, HARMONIZER_WORK_DEL_ONSET, msg.tier,
+       msg.onset_method, 0, msg.object, msg.arena);
+    }
+    break;
+  case HARMONIZER_WORK_NEW_PITCH:
+    harm->pitch_pending = false;
+    if (!msg.object) {
+      harm->pitch_failed[msg.tier][msg.pitch_method] = true;
+      lv2_log_trace(&harm->logger, "could not build pitch method %d\n",
+       msg.pitch_method);
+    } else if (an && !an->pitches[msg.pitch_method]) {
+      an->pitches[msg.pitch_method] = (aubio_pitch_t*)msg.object;
+      an->pitch_arenas[msg.pitch_method] = msg.arena;
+    } else {
+      schedule_work(harm, HARMONIZER_WORK_DEL_PITCH, msg.tier, 0,
+       msg.pitch_method, msg.object, msg.arena);
+    }
+    break;
+  case HARMONIZER_WORK_NEW_TIER:
+    harm->tier_pending = false;
+    if (!msg.object) {
+      harm->tier_failed[msg.tier] = true;
+      lv2_log_trace(&harm->logger, "could not build latency tier %d\n",
+       msg.tier);
+    } else if (!an) {
+      harm->analyses[msg.tier] = (harmonizer_analysis*)msg.object;
+    } else {
+      schedule_work(harm, HARMONIZER_WORK_DEL_TIER, msg.tier, 0, 0,
+       msg.object, NULL);
+    }
+    break;
+  default:
+    break;
+  }
+  return LV2_WORKER_SUCCESS;
+}
+
 static const void*
 extension_data(const char* uri)
 {
+  static const LV2_Worker_Interface worker = { work, work_response, NULL };
+  if (!strcmp(uri, LV2_WORKER__interface)) {
+    return &worker;
+  }
 	return NULL;
 }
 
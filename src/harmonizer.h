@@ -0,0 +1,56 @@
+/*
+  Copyright 2017 Daniel Sheeler <dsheeler@pobox.com>
+
+  Permission to use, copy, modify, and/or distribute this software for any
+  purpose with or without fee is hereby granted, provided that the above
+  copyright notice and this permission notice appear in all copies.
+
+  THIS SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+
+#ifndef HARMONIZER_H
+#define HARMONIZER_H
+
+/* plugin URI and port layout, shared by the plugin and the offline bench;
+ * must match lv2ttl/harmonizer.ttl.in */
+
+#define HARMONIZER_URI "http://dsheeler.org/plugins/harmonizer"
+#define NUM_ONSET_METHODS 10
+#define NUM_PITCH_METHODS 9
+#define NUM_DESCRIPTORS 8
+#define NUM_LATENCY_TIERS 4
+
+typedef enum {
+  HARMONIZER_ONSET_METHOD      = 0,
+  HARMONIZER_ONSET_THRESHOLD   = 1,
+  HARMONIZER_SILENCE_THRESHOLD = 2,
+  HARMONIZER_PITCH_METHOD      = 3,
+  HARMONIZER_PITCH_THRESHOLD   = 4,
+  HARMONIZER_INPUT             = 5,
+  HARMONIZER_MIDI_OUT          = 6,
+  HARMONIZER_DESCRIPTORS       = 7,
+  /* one output per onset method, in the order of onset_method 1..8 */
+  HARMONIZER_ENERGY_OUT        = 8,
+  HARMONIZER_HFC_OUT           = 9,
+  HARMONIZER_COMPLEX_OUT       = 10,
+  HARMONIZER_PHASE_OUT         = 11,
+  HARMONIZER_SPECDIFF_OUT      = 12,
+  HARMONIZER_KL_OUT            = 13,
+  HARMONIZER_MKL_OUT           = 14,
+  HARMONIZER_SPECFLUX_OUT      = 15,
+  HARMONIZER_LATENCY_TIER      = 16,
+  HARMONIZER_LATENCY           = 17,
+  HARMONIZER_MIN_NOTE          = 18,
+  HARMONIZER_MAX_NOTE          = 19,
+  HARMONIZER_TRIGGER           = 20,
+  HARMONIZER_TRIGGER_NOTE      = 21,
+  HARMONIZER_POLYPHONY         = 22
+} PortIndex;
+
+#endif /* HARMONIZER_H */